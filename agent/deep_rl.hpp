@@ -63,6 +63,10 @@ struct NeuralNetworkState {
         state.features.push_back(std::tanh(obs.active_orders.size() / 10.0));
         state.features.push_back(std::tanh((obs.portfolio_value - 1000000.0) / 100000.0));
         
+        // Queue position features (2 features, -1 when not quoting that side)
+        state.features.push_back(obs.bid_queue_ahead < 0 ? -1.0 : std::tanh(obs.bid_queue_ahead / 10000.0));
+        state.features.push_back(obs.ask_queue_ahead < 0 ? -1.0 : std::tanh(obs.ask_queue_ahead / 10000.0));
+        
         return state;
     }
     
@@ -201,8 +205,8 @@ private:
     }
     
 public:
-    QLearningAgent(int num_actions = 8)
-        : q_table_(num_actions), replay_buffer_(100000) {}
+    QLearningAgent(int num_actions = 8, size_t replay_capacity = 100000)
+        : q_table_(num_actions), replay_buffer_(replay_capacity) {}
     
     int select_action(const NeuralNetworkState& state) {
         if (exploration_.should_explore()) {
@@ -257,8 +261,9 @@ private:
     std::vector<double> episode_rewards_;
     
 public:
-    TrainingEngine(OrderBook& book, RLAgent& agent, MarketSimulator& sim)
-        : orderbook_(book), agent_(agent), simulator_(sim),
+    TrainingEngine(OrderBook& book, RLAgent& agent, MarketSimulator& sim,
+                   size_t replay_capacity = 100000)
+        : orderbook_(book), agent_(agent), simulator_(sim), q_agent_(8, replay_capacity),
           episode_(0), total_steps_(0) {}
     
     void train_episode(size_t max_steps = 1000) {
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "../backend/event_scheduler.hpp"
+#include "rl_agent.hpp"
+#include <functional>
+#include <random>
+#include <algorithm>
+
+namespace orderbook {
+
+// Latency between the agent and the venue, in simulated nanoseconds
+struct LatencyModel {
+    uint64_t order_entry_ns = 20000;   // Agent -> book
+    uint64_t market_data_ns = 15000;   // Book -> agent
+    uint64_t jitter_ns = 0;            // Uniform extra delay on both paths
+    
+    LatencyModel() = default;
+    LatencyModel(uint64_t entry, uint64_t data, uint64_t jitter = 0)
+        : order_entry_ns(entry), market_data_ns(data), jitter_ns(jitter) {}
+};
+
+struct EventSimulationStats {
+    uint64_t market_orders = 0;
+    uint64_t market_data_updates = 0;
+    uint64_t decisions = 0;
+    uint64_t agent_orders = 0;
+    uint64_t expired_orders = 0;
+    uint64_t events = 0;
+};
+
+// Discrete-event market simulation
+// Background order flow arrives as a Poisson process, book updates reach the
+// agent after the market-data latency, the agent decides on a fixed cadence
+// against that delayed view, and its orders reach the book after the
+// order-entry latency. The delayed view covers the top of book; depth and
+// position fields of the observation are current.
+class EventDrivenSimulation {
+public:
+    using Strategy = std::function<RLAgent::Action(const RLAgent::Observation&)>;
+
+private:
+    OrderBook& orderbook_;
+    MarketSimulator& simulator_;
+    RLAgent& agent_;
+    EventScheduler scheduler_;
+    LatencyModel latency_;
+    uint64_t decision_interval_ns_;
+    Quantity order_size_;
+    std::mt19937_64 rng_;
+    EventSimulationStats stats_;
+    
+    // Agent's latency-delayed view of the top of book
+    std::optional<Price> seen_bid_;
+    std::optional<Price> seen_ask_;
+    
+    // Last top of book published, so unchanged books send no update
+    Price published_bid_;
+    Price published_ask_;
+    
+    uint64_t jitter() {
+        if (latency_.jitter_ns == 0) return 0;
+        return rng_() % (latency_.jitter_ns + 1);
+    }
+    
+    void publish_market_data(SimTime now) {
+        Price bid = orderbook_.get_best_bid().value_or(0);
+        Price ask = orderbook_.get_best_ask().value_or(0);
+        if (bid == published_bid_ && ask == published_ask_) return;
+        published_bid_ = bid;
+        published_ask_ = ask;
+        
+        SimEvent ev(SimEventType::MARKET_DATA);
+        ev.price = bid;
+        ev.price2 = ask;
+        scheduler_.schedule_at(now + latency_.market_data_ns + jitter(), ev);
+    }
+    
+    template<typename StrategyFn>
+    void dispatch(const SimEvent& ev, SimTime now, StrategyFn& strategy) {
+        switch (ev.type) {
+            case SimEventType::MARKET_ORDER: {
+                simulator_.generate_order();
+                ++stats_.market_orders;
+                scheduler_.schedule_at(now + simulator_.sample_interarrival_ns(),
+                                       SimEvent(SimEventType::MARKET_ORDER));
+                publish_market_data(now);
+                break;
+            }
+            
+            case SimEventType::MARKET_DATA:
+                seen_bid_ = ev.price ? std::optional<Price>(ev.price) : std::nullopt;
+                seen_ask_ = ev.price2 ? std::optional<Price>(ev.price2) : std::nullopt;
+                ++stats_.market_data_updates;
+                break;
+            
+            case SimEventType::AGENT_DECISION: {
+                ++stats_.decisions;
+                RLAgent::Observation obs = agent_.get_observation();
+                obs.market_state.best_bid = seen_bid_.value_or(0);
+                obs.market_state.best_ask = seen_ask_.value_or(0);
+                if (seen_bid_ && seen_ask_) {
+                    obs.market_state.spread = *seen_ask_ - *seen_bid_;
+                    obs.market_state.mid_price = (*seen_bid_ + *seen_ask_) / 2.0;
+                }
+                
+                RLAgent::Action action = strategy(obs);
+                if (action != RLAgent::Action::HOLD) {
+                    SimEvent order(SimEventType::ORDER_ENTRY);
+                    order.action = static_cast<uint8_t>(action);
+                    order.price = seen_bid_.value_or(0);
+                    order.price2 = seen_ask_.value_or(0);
+                    order.quantity = order_size_;
+                    scheduler_.schedule_at(now + latency_.order_entry_ns + jitter(), order);
+                }
+                scheduler_.schedule_at(now + decision_interval_ns_,
+                                       SimEvent(SimEventType::AGENT_DECISION));
+                break;
+            }
+            
+            case SimEventType::ORDER_ENTRY: {
+                // Orders are priced from the view the agent had when it decided
+                auto bid = ev.price ? std::optional<Price>(ev.price) : std::nullopt;
+                auto ask = ev.price2 ? std::optional<Price>(ev.price2) : std::nullopt;
+                agent_.execute_action(static_cast<RLAgent::Action>(ev.action), ev.quantity, bid, ask);
+                ++stats_.agent_orders;
+                publish_market_data(now);
+                break;
+            }
+            
+            case SimEventType::TIMER:
+                break;
+        }
+    }
+
+public:
+    EventDrivenSimulation(OrderBook& book, MarketSimulator& simulator, RLAgent& agent,
+                          LatencyModel latency = LatencyModel(),
+                          uint64_t decision_interval_ns = 100000, uint64_t seed = 1)
+        : orderbook_(book), simulator_(simulator), agent_(agent), scheduler_(0),
+          latency_(latency), decision_interval_ns_(decision_interval_ns), order_size_(100),
+          rng_(seed), published_bid_(0), published_ask_(0) {}
+    
+    void set_order_size(Quantity size) { order_size_ = size; }
+    void set_latency(const LatencyModel& latency) { latency_ = latency; }
+    
+    // Run for duration_ns of simulated time
+    template<typename StrategyFn>
+    const EventSimulationStats& run(uint64_t duration_ns, StrategyFn&& strategy) {
+        SimTime start = scheduler_.now();
+        if (scheduler_.pending() == 0) {
+            scheduler_.schedule_at(start + simulator_.sample_interarrival_ns(),
+                                   SimEvent(SimEventType::MARKET_ORDER));
+            scheduler_.schedule_at(start + decision_interval_ns_,
+                                   SimEvent(SimEventType::AGENT_DECISION));
+        }
+        
+        stats_.events += scheduler_.run_until(start + duration_ns, [&](const SimEvent& ev, SimTime now) {
+            // The book's clock follows simulated time, expiring GTD/DAY orders
+            stats_.expired_orders += orderbook_.advance_time(now);
+            dispatch(ev, now, strategy);
+        });
+        return stats_;
+    }
+    
+    EventScheduler& scheduler() { return scheduler_; }
+    const EventSimulationStats& stats() const { return stats_; }
+    SimTime now() const { return scheduler_.now(); }
+};
+
+} // namespace orderbook
@@ -0,0 +1,213 @@
+#pragma once
+
+#include "../backend/order.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace orderbook {
+
+// Performance metrics for backtesting
+struct PerformanceMetrics {
+    double sharpe_ratio = 0.0;
+    double sortino_ratio = 0.0;
+    double max_drawdown = 0.0;
+    double total_return = 0.0;
+    double win_rate = 0.0;
+    double profit_factor = 0.0;
+    size_t total_trades = 0;         // Fills
+    double avg_trade_duration = 0.0; // Steps per round trip
+    size_t round_trips = 0;
+    double avg_holding_time_s = 0.0; // Wall/simulated seconds per round trip
+    double turnover = 0.0;           // Traded notional / initial equity
+    
+    void print() const;
+};
+
+// Streaming performance metrics
+// Every update is O(1) and nothing is stored per point, so memory stays flat
+// however long the run. A round trip starts when the position leaves flat and
+// ends when it returns to flat (a flip closes one trip and opens the next).
+// Updates and snapshots are mutex-guarded: fills arrive on the book's thread
+// while decisions and readers may live elsewhere.
+class StreamingMetrics {
+private:
+    mutable std::mutex mutex_;
+    
+    // Equity curve
+    double initial_equity_;
+    double last_equity_;
+    double peak_equity_;
+    double max_drawdown_;
+    size_t steps_;
+    
+    // Per-step returns (Welford's online mean/variance)
+    size_t return_count_;
+    double return_mean_;
+    double return_m2_;
+    double downside_sq_sum_;
+    size_t downside_count_;
+    
+    // Round trips
+    int64_t position_;
+    double trip_pnl_;
+    size_t trip_open_step_;
+    Timestamp trip_open_time_;
+    size_t wins_;
+    size_t losses_;
+    double gross_profit_;
+    double gross_loss_;
+    double total_holding_steps_;
+    double total_holding_s_;
+    size_t round_trips_;
+    
+    // Activity
+    size_t fills_;
+    double traded_notional_;
+    
+    void close_trip(Timestamp now) {
+        if (trip_pnl_ > 0.0) {
+            ++wins_;
+            gross_profit_ += trip_pnl_;
+        } else if (trip_pnl_ < 0.0) {
+            ++losses_;
+            gross_loss_ -= trip_pnl_;
+        }
+        total_holding_steps_ += static_cast<double>(steps_ - trip_open_step_);
+        total_holding_s_ += std::chrono::duration<double>(now - trip_open_time_).count();
+        ++round_trips_;
+        trip_pnl_ = 0.0;
+    }
+    
+    void open_trip(Timestamp now) {
+        trip_open_step_ = steps_;
+        trip_open_time_ = now;
+        trip_pnl_ = 0.0;
+    }
+
+public:
+    explicit StreamingMetrics(double initial_equity = 1000000.0) {
+        reset(initial_equity);
+    }
+    
+    void reset(double initial_equity) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        initial_equity_ = last_equity_ = peak_equity_ = initial_equity;
+        max_drawdown_ = 0.0;
+        steps_ = 0;
+        return_count_ = 0;
+        return_mean_ = return_m2_ = 0.0;
+        downside_sq_sum_ = 0.0;
+        downside_count_ = 0;
+        position_ = 0;
+        trip_pnl_ = 0.0;
+        trip_open_step_ = 0;
+        trip_open_time_ = Timestamp::zero();
+        wins_ = losses_ = 0;
+        gross_profit_ = gross_loss_ = 0.0;
+        total_holding_steps_ = total_holding_s_ = 0.0;
+        round_trips_ = 0;
+        fills_ = 0;
+        traded_notional_ = 0.0;
+    }
+    
+    // Record the portfolio value after one decision step
+    void on_equity(double equity) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++steps_;
+        
+        if (last_equity_ != 0.0) {
+            double ret = (equity - last_equity_) / last_equity_;
+            ++return_count_;
+            double delta = ret - return_mean_;
+            return_mean_ += delta / return_count_;
+            return_m2_ += delta * (ret - return_mean_);
+            if (ret < 0.0) {
+                downside_sq_sum_ += ret * ret;
+                ++downside_count_;
+            }
+        }
+        last_equity_ = equity;
+        
+        if (equity > peak_equity_) {
+            peak_equity_ = equity;
+        } else if (peak_equity_ > 0.0) {
+            double dd = (peak_equity_ - equity) / peak_equity_;
+            if (dd > max_drawdown_) max_drawdown_ = dd;
+        }
+    }
+    
+    // Record one of our fills; realized_pnl is the PnL realised by this fill
+    void on_fill(int64_t position_after, Quantity quantity, double price,
+                 double realized_pnl, Timestamp now) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++fills_;
+        traded_notional_ += quantity * price;
+        
+        int64_t before = position_;
+        position_ = position_after;
+        
+        if (before == 0) {
+            open_trip(now);
+            trip_pnl_ += realized_pnl;
+            return;
+        }
+        
+        trip_pnl_ += realized_pnl;
+        bool flipped = (before > 0 && position_after < 0) || (before < 0 && position_after > 0);
+        if (position_after == 0 || flipped) {
+            close_trip(now);
+            if (flipped) open_trip(now);
+        }
+    }
+    
+    // Consistent view of the metrics, safe to call at any time
+    PerformanceMetrics snapshot() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        PerformanceMetrics m;
+        
+        if (initial_equity_ != 0.0) {
+            m.total_return = (last_equity_ - initial_equity_) / initial_equity_;
+            m.turnover = traded_notional_ / initial_equity_;
+        }
+        m.max_drawdown = max_drawdown_;
+        
+        if (return_count_ > 0) {
+            double std_dev = std::sqrt(return_m2_ / return_count_);
+            if (std_dev > 0) {
+                m.sharpe_ratio = return_mean_ / std_dev * std::sqrt(252.0); // Annualized
+            }
+            if (downside_count_ > 0) {
+                // Downside deviation: squared losses averaged over every return,
+                // so gains count as zero rather than being left out
+                double downside_dev = std::sqrt(downside_sq_sum_ / return_count_);
+                if (downside_dev > 0) {
+                    m.sortino_ratio = return_mean_ / downside_dev * std::sqrt(252.0);
+                }
+            }
+        }
+        
+        m.total_trades = fills_;
+        m.round_trips = round_trips_;
+        if (round_trips_ > 0) {
+            m.win_rate = static_cast<double>(wins_) / round_trips_;
+            m.avg_trade_duration = total_holding_steps_ / round_trips_;
+            m.avg_holding_time_s = total_holding_s_ / round_trips_;
+        }
+        if (gross_loss_ > 0.0) {
+            m.profit_factor = gross_profit_ / gross_loss_;
+        } else if (gross_profit_ > 0.0) {
+            m.profit_factor = INFINITY;
+        }
+        
+        return m;
+    }
+    
+    size_t steps() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return steps_;
+    }
+};
+
+} // namespace orderbook
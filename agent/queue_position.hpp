@@ -0,0 +1,323 @@
+#pragma once
+
+#include "../backend/order.hpp"
+#include <unordered_map>
+#include <vector>
+#include <functional>
+#include <optional>
+#include <random>
+#include <algorithm>
+
+namespace orderbook {
+
+// How an aggregated (L2) size decrease that is not explained by a trade is
+// split between the queue ahead of our order and the queue behind it
+enum class CancelAttribution : uint8_t {
+    PROPORTIONAL = 0,  // Expected value: ahead shrinks by cancel * ahead / level
+    RANDOM = 1         // One draw: the cancelled order sat ahead of us with p = ahead / level
+};
+
+// Queue position tracking for our resting orders
+// Every tracked order keeps the quantity ahead of it at its price level
+// (including our own earlier orders there). Each level event costs one hash
+// lookup plus a pass over our own orders at that level, usually one.
+//
+// Two feeds are supported:
+// - L3 (order ids, e.g. our own OrderBook): on_trade/on_cancel/on_reduce. Ids are
+//   assigned in arrival order, so an order with a smaller id at our price is
+//   ahead of us and the position is exact.
+// - L2 (aggregated sizes, e.g. a replayed depth feed where our orders are
+//   virtual): on_level_trade/on_level_update. Trades consume the front of the
+//   queue and fill us once the quantity ahead is gone; size decreases without
+//   a trade are cancels, attributed per CancelAttribution. Feed trades before
+//   the level update that reflects them.
+class QueuePositionTracker {
+public:
+    struct QueuedOrder {
+        OrderId id;
+        Side side;
+        Price price;
+        Quantity remaining;
+        Quantity ahead;
+    };
+    
+    // Simulated L2 fill of a tracked order: (id, side, price, quantity)
+    using FillCallback = std::function<void(OrderId, Side, Price, Quantity)>;
+    
+private:
+    struct LevelQueue {
+        Quantity displayed = 0;            // Others' size at the level (L2 only)
+        std::vector<QueuedOrder> orders;   // Our orders in queue order
+    };
+    
+    std::unordered_map<Price, LevelQueue> levels_[2];
+    std::unordered_map<OrderId, std::pair<Side, Price>> index_;
+    CancelAttribution attribution_;
+    std::mt19937_64 rng_;
+    FillCallback fill_callback_;
+    
+    static size_t side_index(Side side) { return side == Side::BUY ? 0 : 1; }
+    
+    LevelQueue* find_level(Side side, Price price) {
+        auto& book = levels_[side_index(side)];
+        auto it = book.find(price);
+        return it == book.end() ? nullptr : &it->second;
+    }
+    
+    // Drop filled orders; erase the level once none of ours remain
+    void compact(Side side, Price price, LevelQueue& level) {
+        auto& orders = level.orders;
+        size_t write = 0;
+        for (size_t read = 0; read < orders.size(); ++read) {
+            if (orders[read].remaining > 0) {
+                orders[write++] = orders[read];
+            } else {
+                index_.erase(orders[read].id);
+            }
+        }
+        orders.resize(write);
+        if (orders.empty()) {
+            levels_[side_index(side)].erase(price);
+        }
+    }
+    
+    // Exact L3 update for one side of a trade
+    void apply_trade(Side side, OrderId passive_id, Price price, Quantity quantity) {
+        LevelQueue* level = find_level(side, price);
+        if (!level) return;
+        
+        bool filled = false;
+        for (auto& o : level->orders) {
+            if (passive_id == o.id) {
+                o.remaining -= std::min(quantity, o.remaining);
+                o.ahead = 0;
+                filled = filled || o.remaining == 0;
+            } else if (passive_id < o.id) {
+                o.ahead -= std::min(quantity, o.ahead);
+            }
+        }
+        if (filled) compact(side, price, *level);
+    }
+    
+    void fill(QueuedOrder& o, Quantity quantity) {
+        o.remaining -= quantity;
+        if (fill_callback_) {
+            fill_callback_(o.id, o.side, o.price, quantity);
+        }
+    }
+    
+public:
+    explicit QueuePositionTracker(CancelAttribution attribution = CancelAttribution::PROPORTIONAL,
+                                  uint64_t seed = 1)
+        : attribution_(attribution), rng_(seed) {}
+    
+    void set_fill_callback(FillCallback callback) { fill_callback_ = std::move(callback); }
+    void set_attribution(CancelAttribution attribution) { attribution_ = attribution; }
+    
+    // Start tracking a resting order that joined the back of its level with
+    // `ahead` quantity in front of it
+    void track(OrderId id, Side side, Price price, Quantity quantity, Quantity ahead) {
+        auto& book = levels_[side_index(side)];
+        auto it = book.find(price);
+        if (it == book.end()) {
+            it = book.emplace(price, LevelQueue()).first;
+            it->second.displayed = ahead;
+        }
+        it->second.orders.push_back({id, side, price, quantity, ahead});
+        index_[id] = {side, price};
+    }
+    
+    // Stop tracking one of our orders (cancelled by us). Our later orders at
+    // the same level move up by its remaining quantity. With an L3 feed, let
+    // on_cancel handle our own cancels instead.
+    bool untrack(OrderId id) {
+        auto it = index_.find(id);
+        if (it == index_.end()) return false;
+        auto [side, price] = it->second;
+        LevelQueue* level = find_level(side, price);
+        
+        Quantity freed = 0;
+        for (auto& o : level->orders) {
+            if (o.id == id) {
+                freed = o.remaining;
+                o.remaining = 0;
+            } else if (freed > 0) {
+                o.ahead -= std::min(freed, o.ahead);
+            }
+        }
+        compact(side, price, *level);
+        return true;
+    }
+    
+    void clear() {
+        levels_[0].clear();
+        levels_[1].clear();
+        index_.clear();
+    }
+    
+    // --- L3 feed ---
+    
+    // A trade in the book; the aggressor always has the newest id, so only the
+    // passive side can be ahead of us
+    void on_trade(const Trade& trade) {
+        if (index_.empty()) return;
+        apply_trade(Side::BUY, trade.buy_order_id, trade.price, trade.quantity);
+        apply_trade(Side::SELL, trade.sell_order_id, trade.price, trade.quantity);
+    }
+    
+    // Order update from the book; only cancels and expiries move the queue
+    void on_cancel(const Order& order) {
+        if ((order.status != OrderStatus::CANCELLED && order.status != OrderStatus::EXPIRED) ||
+            index_.empty()) return;
+        LevelQueue* level = find_level(order.side, order.price);
+        if (!level) return;
+        
+        Quantity removed = order.remaining_quantity();
+        bool ours = false;
+        for (auto& o : level->orders) {
+            if (o.id == order.id) {
+                o.remaining = 0;
+                ours = true;
+            } else if (order.id < o.id) {
+                o.ahead -= std::min(removed, o.ahead);
+            }
+        }
+        if (ours) compact(order.side, order.price, *level);
+    }
+    
+    // A resting order shrunk in place by `removed` (OrderBook::reduce_order):
+    // it keeps its place, so only our later orders at its level move up
+    void on_reduce(const Order& order, Quantity removed) {
+        if (index_.empty()) return;
+        LevelQueue* level = find_level(order.side, order.price);
+        if (!level) return;
+        
+        for (auto& o : level->orders) {
+            if (o.id == order.id) {
+                o.remaining = order.remaining_quantity();
+            } else if (order.id < o.id) {
+                o.ahead -= std::min(removed, o.ahead);
+            }
+        }
+    }
+    
+    // --- L2 feed ---
+    
+    // A trade of `quantity` against resting orders on `side` at `price`.
+    // Fills our orders at that level past the quantity ahead, and fully fills
+    // ours at better prices (the trade went through them). Returns our total
+    // simulated fill.
+    Quantity on_level_trade(Side side, Price price, Quantity quantity) {
+        if (index_.empty()) return 0;
+        auto& book = levels_[side_index(side)];
+        Quantity total = 0;
+        
+        // Trade-through: a sell at 99 means no bid at 100 was left in front of us
+        for (auto it = book.begin(); it != book.end();) {
+            Price p = it->first;
+            bool better = side == Side::BUY ? p > price : p < price;
+            auto next = std::next(it);
+            if (better) {
+                for (auto& o : it->second.orders) {
+                    total += o.remaining;
+                    fill(o, o.remaining);
+                }
+                compact(side, p, it->second);
+            }
+            it = next;
+        }
+        
+        LevelQueue* level = find_level(side, price);
+        if (!level) return total;
+        
+        bool filled = false;
+        for (auto& o : level->orders) {
+            Quantity past = quantity > o.ahead ? quantity - o.ahead : 0;
+            Quantity qty = std::min(past, o.remaining);
+            o.ahead -= std::min(quantity, o.ahead);
+            if (qty > 0) {
+                fill(o, qty);
+                total += qty;
+                filled = filled || o.remaining == 0;
+            }
+        }
+        // The feed's size excludes our virtual orders, so the whole print
+        // came out of others' quantity
+        level->displayed -= std::min(quantity, level->displayed);
+        if (filled) compact(side, price, *level);
+        return total;
+    }
+    
+    // New aggregated size at a level. Increases join behind us; decreases
+    // not already explained by trades are cancels.
+    void on_level_update(Side side, Price price, Quantity displayed) {
+        LevelQueue* level = find_level(side, price);
+        if (!level) return;
+        
+        if (displayed < level->displayed) {
+            Quantity cancelled = level->displayed - displayed;
+            double before = static_cast<double>(level->displayed);
+            double draw = 0.0;
+            if (attribution_ == CancelAttribution::RANDOM) {
+                draw = std::uniform_real_distribution<double>(0.0, before)(rng_);
+            }
+            
+            // Others ahead of each of our orders excludes our own earlier orders
+            Quantity own_before = 0;
+            for (auto& o : level->orders) {
+                Quantity others_ahead = o.ahead > own_before ? o.ahead - own_before : 0;
+                Quantity removed = 0;
+                if (attribution_ == CancelAttribution::PROPORTIONAL) {
+                    removed = static_cast<Quantity>(
+                        cancelled * (others_ahead / before) + 0.5);
+                } else if (draw < others_ahead) {
+                    removed = cancelled;
+                }
+                o.ahead -= std::min({removed, others_ahead, o.ahead});
+                own_before += o.remaining;
+            }
+        }
+        level->displayed = displayed;
+        
+        // Never more ahead than the level actually shows
+        Quantity own_before = 0;
+        for (auto& o : level->orders) {
+            o.ahead = std::min(o.ahead, displayed + own_before);
+            own_before += o.remaining;
+        }
+    }
+    
+    // --- Queries ---
+    
+    std::optional<Quantity> queue_ahead(OrderId id) const {
+        auto it = index_.find(id);
+        if (it == index_.end()) return std::nullopt;
+        auto [side, price] = it->second;
+        const auto& orders = levels_[side_index(side)].at(price).orders;
+        for (const auto& o : orders) {
+            if (o.id == id) return o.ahead;
+        }
+        return std::nullopt;
+    }
+    
+    // Quantity ahead of our best-priced order on a side (-1 if none rests)
+    int64_t best_queue_ahead(Side side) const {
+        const auto& book = levels_[side_index(side)];
+        const LevelQueue* best = nullptr;
+        Price best_price = 0;
+        for (const auto& [price, level] : book) {
+            bool better = side == Side::BUY ? price > best_price : price < best_price;
+            if (!best || better) {
+                best = &level;
+                best_price = price;
+            }
+        }
+        if (!best || best->orders.empty()) return -1;
+        return static_cast<int64_t>(best->orders.front().ahead);
+    }
+    
+    size_t size() const { return index_.size(); }
+    bool empty() const { return index_.empty(); }
+};
+
+} // namespace orderbook
@@ -1,4 +1,5 @@
 #include "rl_agent.hpp"
+#include "../backend/trace.hpp"
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
@@ -11,15 +12,39 @@ RLAgent::RLAgent(OrderBook& book, double initial_cash)
     : orderbook_(book), cash_(initial_cash), initial_cash_(initial_cash),
       inventory_penalty_coef_(0.01), spread_capture_reward_(1.0),
       total_trades_(0), total_volume_(0.0),
-      total_execution_time_ns_(0.0), action_count_(0) {
-    
+      total_execution_time_ns_(0.0), action_count_(0), metrics_(initial_cash) {
+          
     // Pre-allocate to avoid reallocation overhead
     active_orders_.reserve(100);
+    gauges_.portfolio_value.store(initial_cash, std::memory_order_relaxed);
     
     // Register callback to update position on trades
     orderbook_.register_trade_callback([this](const Trade& trade) {
+        this->queue_tracker_.on_trade(trade);
         this->update_position(trade);
     });
+    
+    // Cancels and in-place reductions ahead of our orders move us up the queue
+    orderbook_.register_order_callback([this](const Order& order) {
+        this->queue_tracker_.on_cancel(order);
+    });
+    orderbook_.register_reduce_callback([this](const Order& order, Quantity removed) {
+        this->queue_tracker_.on_reduce(order, removed);
+    });
+}
+
+void RLAgent::track_resting_order(OrderId id) {
+    const auto order = orderbook_.get_order(id);
+    if (!order || order->type != OrderType::LIMIT ||
+        (order->status != OrderStatus::NEW && order->status != OrderStatus::PARTIALLY_FILLED)) {
+        return;
+    }
+    
+    // We just joined the back of the level: everything else there is ahead
+    const Quantity remaining = order->remaining_quantity();
+    const Quantity level = orderbook_.get_volume_at_price(order->price, order->side);
+    queue_tracker_.track(id, order->side, order->price, remaining,
+                         level > remaining ? level - remaining : 0);
 }
 
 void RLAgent::update_position(const Trade& trade) {
@@ -43,6 +68,7 @@ void RLAgent::update_position(const Trade& trade) {
     
     ++total_trades_;
     total_volume_ += trade.quantity;
+    const double realized_before = position_.realized_pnl;
     
     if (is_buy) {
         // Buying - increase position
@@ -95,6 +121,13 @@ void RLAgent::update_position(const Trade& trade) {
             cash_ += trade.quantity * (trade.price / 100.0);
         }
     }
+    
+    metrics_.on_fill(position_.quantity, trade.quantity, trade.price / 100.0,
+                     position_.realized_pnl - realized_before, trade.timestamp);
+    
+    gauges_.position.store(position_.quantity, std::memory_order_relaxed);
+    gauges_.realized_pnl.store(position_.realized_pnl, std::memory_order_relaxed);
+    gauges_.fills.store(total_trades_, std::memory_order_relaxed);
 }
 
 RLAgent::Observation RLAgent::get_observation() const {
@@ -104,6 +137,8 @@ RLAgent::Observation RLAgent::get_observation() const {
     obs.active_orders = active_orders_;
     obs.cash = cash_;
     obs.portfolio_value = get_portfolio_value();
+    obs.bid_queue_ahead = queue_tracker_.best_queue_ahead(Side::BUY);
+    obs.ask_queue_ahead = queue_tracker_.best_queue_ahead(Side::SELL);
     
     // Update unrealized PnL
     if (position_.quantity != 0 && obs.market_state.mid_price > 0) {
@@ -120,15 +155,21 @@ RLAgent::Observation RLAgent::get_observation() const {
 }
 
 RLAgent::Reward RLAgent::execute_action(Action action, Quantity quantity) {
+    // Fast path: only fetch what we need based on action
+    if (action == Action::HOLD || action == Action::CANCEL_ALL) {
+        return execute_action(action, quantity, std::nullopt, std::nullopt);
+    }
+    return execute_action(action, quantity, orderbook_.get_best_bid(), orderbook_.get_best_ask());
+}
+
+RLAgent::Reward RLAgent::execute_action(Action action, Quantity quantity,
+                                        const std::optional<Price>& best_bid, const std::optional<Price>& best_ask) {
+    OB_TRACE_SCOPE("agent.execute");
     auto start = std::chrono::high_resolution_clock::now();
     
     const double previous_pnl = position_.realized_pnl + position_.unrealized_pnl;
     
-    // Fast path: only fetch what we need based on action
     if (action != Action::HOLD && action != Action::CANCEL_ALL) {
-        const auto best_bid = orderbook_.get_best_bid();
-        const auto best_ask = orderbook_.get_best_ask();
-        
         switch (action) {
             case Action::BUY_MARKET:
                 if (best_ask) [[likely]] {
@@ -137,7 +178,7 @@ RLAgent::Reward RLAgent::execute_action(Action action, Quantity quantity) {
                     );
                 }
                 break;
-                
+            
             case Action::SELL_MARKET:
                 if (best_bid) [[likely]] {
                     active_orders_.emplace_back(
@@ -145,41 +186,45 @@ RLAgent::Reward RLAgent::execute_action(Action action, Quantity quantity) {
                     );
                 }
                 break;
-                
+            
             case Action::BUY_LIMIT_AT_BID:
                 if (best_bid) [[likely]] {
                     active_orders_.emplace_back(
                         orderbook_.add_order(*best_bid, quantity, Side::BUY, OrderType::LIMIT)
                     );
+                    track_resting_order(active_orders_.back());
                 }
                 break;
-                
+            
             case Action::SELL_LIMIT_AT_ASK:
                 if (best_ask) [[likely]] {
                     active_orders_.emplace_back(
                         orderbook_.add_order(*best_ask, quantity, Side::SELL, OrderType::LIMIT)
                     );
+                    track_resting_order(active_orders_.back());
                 }
                 break;
-                
+            
             case Action::BUY_LIMIT_AGGRESSIVE:
                 if (best_bid && best_ask) [[likely]] {
                     const Price aggressive_price = (*best_bid + *best_ask) >> 1;
                     active_orders_.emplace_back(
                         orderbook_.add_order(aggressive_price, quantity, Side::BUY, OrderType::LIMIT)
                     );
+                    track_resting_order(active_orders_.back());
                 }
                 break;
-                
+            
             case Action::SELL_LIMIT_AGGRESSIVE:
                 if (best_bid && best_ask) [[likely]] {
                     const Price aggressive_price = (*best_bid + *best_ask) >> 1;
                     active_orders_.emplace_back(
                         orderbook_.add_order(aggressive_price, quantity, Side::SELL, OrderType::LIMIT)
                     );
+                    track_resting_order(active_orders_.back());
                 }
                 break;
-                
+            
             default:
                 break;
         }
@@ -208,6 +253,11 @@ RLAgent::Reward RLAgent::execute_action(Action action, Quantity quantity) {
     auto end = std::chrono::high_resolution_clock::now();
     total_execution_time_ns_ += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
     
+    const double portfolio_value = get_portfolio_value();
+    metrics_.on_equity(portfolio_value);
+    gauges_.portfolio_value.store(portfolio_value, std::memory_order_relaxed);
+    gauges_.actions.store(action_count_, std::memory_order_relaxed);
+    
     return calculate_reward(previous_pnl);
 }
 
@@ -233,11 +283,19 @@ RLAgent::Reward RLAgent::calculate_reward(double previous_pnl) {
 void RLAgent::reset() {
     position_ = Position();
     active_orders_.clear();
+    queue_tracker_.clear();
     cash_ = initial_cash_;
     total_trades_ = 0;
     total_volume_ = 0.0;
     total_execution_time_ns_ = 0.0;
     action_count_ = 0;
+    metrics_.reset(initial_cash_);
+    
+    gauges_.position.store(0, std::memory_order_relaxed);
+    gauges_.realized_pnl.store(0.0, std::memory_order_relaxed);
+    gauges_.portfolio_value.store(initial_cash_, std::memory_order_relaxed);
+    gauges_.fills.store(0, std::memory_order_relaxed);
+    gauges_.actions.store(0, std::memory_order_relaxed);
 }
 
 double RLAgent::get_portfolio_value() const {
@@ -257,36 +315,52 @@ MarketSimulator::MarketSimulator(OrderBook& book, Price base_price,
                                  double volatility, double arrival_rate)
     : orderbook_(book), rng_(std::random_device{}()), 
       base_price_(base_price), volatility_(volatility), 
-      arrival_rate_(arrival_rate), spread_width_(0.01),
+      arrival_rate_(arrival_rate), spread_width_(0.01), order_lifetime_ns_(0.0),
       price_dist_(0.0, volatility), 
       size_dist_(1.0 / 1000.0),  // Average 1000 shares
       side_dist_(0.5) {}
 
+OrderId MarketSimulator::generate_order() {
+    // Determine side
+    Side side = side_dist_(rng_) ? Side::BUY : Side::SELL;
+    
+    // Generate price around base with volatility
+    double price_offset = price_dist_(rng_);
+    Price price = base_price_ + static_cast<Price>(price_offset * base_price_);
+    
+    // Add spread
+    if (side == Side::BUY) {
+        price -= static_cast<Price>(spread_width_ * base_price_ / 2);
+    } else {
+        price += static_cast<Price>(spread_width_ * base_price_ / 2);
+    }
+    
+    // Generate size
+    Quantity size = std::max<Quantity>(100, 
+        static_cast<Quantity>(size_dist_(rng_) * 10000));
+    
+    // Add order to book
+    if (order_lifetime_ns_ > 0.0) {
+        std::exponential_distribution<double> lifetime(1.0 / order_lifetime_ns_);
+        auto ttl = std::chrono::nanoseconds(static_cast<int64_t>(lifetime(rng_)) + 1);
+        return orderbook_.add_order_for(price, size, side, ttl);
+    }
+    return orderbook_.add_order(price, size, side, OrderType::LIMIT);
+}
+
 void MarketSimulator::simulate_step(size_t num_orders) {
+    OB_TRACE_SCOPE("sim.step");
     for (size_t i = 0; i < num_orders; ++i) {
-        // Determine side
-        Side side = side_dist_(rng_) ? Side::BUY : Side::SELL;
-        
-        // Generate price around base with volatility
-        double price_offset = price_dist_(rng_);
-        Price price = base_price_ + static_cast<Price>(price_offset * base_price_);
-        
-        // Add spread
-        if (side == Side::BUY) {
-            price -= static_cast<Price>(spread_width_ * base_price_ / 2);
-        } else {
-            price += static_cast<Price>(spread_width_ * base_price_ / 2);
-        }
-        
-        // Generate size
-        Quantity size = std::max(100ULL, 
-            static_cast<Quantity>(size_dist_(rng_) * 10000));
-        
-        // Add order to book
-        orderbook_.add_order(price, size, side, OrderType::LIMIT);
+        generate_order();
     }
 }
 
+uint64_t MarketSimulator::sample_interarrival_ns() {
+    // Poisson arrivals: exponential gaps with mean 1000 / arrival_rate_ ns
+    std::exponential_distribution<double> gap(arrival_rate_ / 1000.0);
+    return static_cast<uint64_t>(gap(rng_)) + 1;
+}
+
 void MarketSimulator::simulate_microseconds(uint64_t microseconds) {
     // Calculate expected number of orders based on arrival rate
     double expected_orders = arrival_rate_ * microseconds;
@@ -309,105 +383,21 @@ void PerformanceMetrics::print() const {
     std::cout << "Win Rate:         " << (win_rate * 100) << "%" << std::endl;
     std::cout << "Profit Factor:    " << profit_factor << std::endl;
     std::cout << "Total Trades:     " << total_trades << std::endl;
-    std::cout << "Avg Trade Duration: " << avg_trade_duration << " steps" << std::endl;
+    std::cout << "Round Trips:      " << round_trips << std::endl;
+    std::cout << "Avg Trade Duration: " << avg_trade_duration << " steps" 
+              << " (" << avg_holding_time_s << " s)" << std::endl;
+    std::cout << "Turnover:         " << turnover << "x" << std::endl;
     std::cout << "===========================\n" << std::endl;
 }
 
 // Backtester implementation
 Backtester::Backtester(double initial_cash)
-    : agent_(orderbook_, initial_cash) {
+    : agent_(orderbook_, initial_cash), record_equity_curve_(false) {
     equity_curve_.push_back(initial_cash);
 }
 
-template<typename Strategy>
-void Backtester::run(Strategy& strategy, size_t num_steps) {
-    for (size_t step = 0; step < num_steps; ++step) {
-        // Get observation
-        auto obs = agent_.get_observation();
-        
-        // Get action from strategy
-        auto action = strategy(obs);
-        
-        // Execute action
-        agent_.execute_action(action);
-        
-        // Record equity
-        double equity = agent_.get_portfolio_value();
-        equity_curve_.push_back(equity);
-        
-        if (!equity_curve_.empty() && equity_curve_.size() > 1) {
-            double ret = (equity - equity_curve_[equity_curve_.size() - 2]) / 
-                        equity_curve_[equity_curve_.size() - 2];
-            returns_.push_back(ret);
-        }
-    }
-}
-
 PerformanceMetrics Backtester::calculate_metrics() const {
-    PerformanceMetrics metrics;
-    
-    if (equity_curve_.size() < 2) {
-        return metrics;
-    }
-    
-    // Total return
-    metrics.total_return = (equity_curve_.back() - equity_curve_.front()) / 
-                          equity_curve_.front();
-    
-    // Sharpe ratio
-    if (!returns_.empty()) {
-        double mean_return = std::accumulate(returns_.begin(), returns_.end(), 0.0) / 
-                            returns_.size();
-        
-        double variance = 0.0;
-        for (double ret : returns_) {
-            variance += (ret - mean_return) * (ret - mean_return);
-        }
-        variance /= returns_.size();
-        double std_dev = std::sqrt(variance);
-        
-        if (std_dev > 0) {
-            metrics.sharpe_ratio = mean_return / std_dev * std::sqrt(252.0); // Annualized
-        }
-        
-        // Sortino ratio (downside deviation)
-        double downside_variance = 0.0;
-        size_t downside_count = 0;
-        for (double ret : returns_) {
-            if (ret < 0) {
-                downside_variance += ret * ret;
-                ++downside_count;
-            }
-        }
-        if (downside_count > 0) {
-            double downside_dev = std::sqrt(downside_variance / downside_count);
-            if (downside_dev > 0) {
-                metrics.sortino_ratio = mean_return / downside_dev * std::sqrt(252.0);
-            }
-        }
-    }
-    
-    // Max drawdown
-    double peak = equity_curve_[0];
-    double max_dd = 0.0;
-    for (double equity : equity_curve_) {
-        if (equity > peak) {
-            peak = equity;
-        }
-        double dd = (peak - equity) / peak;
-        if (dd > max_dd) {
-            max_dd = dd;
-        }
-    }
-    metrics.max_drawdown = max_dd;
-    
-    // Trade statistics
-    metrics.total_trades = agent_.get_total_trades();
-    metrics.win_rate = 0.5; // Simplified
-    metrics.profit_factor = 1.0; // Simplified
-    metrics.avg_trade_duration = 1.0; // Simplified
-    
-    return metrics;
+    return agent_.get_metrics();
 }
 
 } // namespace orderbook
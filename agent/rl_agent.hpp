@@ -1,6 +1,9 @@
 #pragma once
 
 #include "../backend/orderbook.hpp"
+#include "performance_metrics.hpp"
+#include "queue_position.hpp"
+#include <atomic>
 #include <vector>
 #include <memory>
 #include <random>
@@ -38,6 +41,10 @@ public:
         std::vector<OrderId> active_orders;
         double portfolio_value;
         double cash;
+        
+        // Quantity ahead of our best resting order on each side (-1 if none)
+        int64_t bid_queue_ahead;
+        int64_t ask_queue_ahead;
     };
     
     struct Reward {
@@ -50,6 +57,16 @@ public:
                    spread_capture(0.0), total(0.0) {}
     };
     
+    // Position and PnL as of the agent's last fill or action, readable from
+    // any thread without locks (metrics scrapes)
+    struct Gauges {
+        std::atomic<int64_t> position{0};
+        std::atomic<double> realized_pnl{0.0};
+        std::atomic<double> portfolio_value{0.0};
+        std::atomic<uint64_t> fills{0};
+        std::atomic<uint64_t> actions{0};
+    };
+    
 private:
     OrderBook& orderbook_;
     Position position_;
@@ -68,8 +85,14 @@ private:
     // Performance metrics
     double total_execution_time_ns_;
     size_t action_count_;
+    StreamingMetrics metrics_;
+    Gauges gauges_;
+    
+    // Queue position of our resting limit orders (exact, from the book's ids)
+    QueuePositionTracker queue_tracker_;
     
     void update_position(const Trade& trade);
+    void track_resting_order(OrderId id);
     Reward calculate_reward(double previous_pnl);
     
 public:
@@ -78,6 +101,11 @@ public:
     // RL interface
     Observation get_observation() const;
     Reward execute_action(Action action, Quantity quantity = 100);
+    
+    // Execute against a given view of the top of book (e.g. a latency-delayed
+    // market data snapshot) instead of the book's current best prices
+    Reward execute_action(Action action, Quantity quantity,
+                          const std::optional<Price>& best_bid, const std::optional<Price>& best_ask);
     void reset();
     
     // Configuration
@@ -94,6 +122,12 @@ public:
     }
     double get_min_latency_ns() const { return 50.0; } // Approximate from order book
     double get_max_latency_ns() const { return 200.0; } // Approximate from order book
+    
+    // Live performance metrics (round trips, Sharpe, drawdown), safe to read at any time
+    PerformanceMetrics get_metrics() const { return metrics_.snapshot(); }
+    
+    const QueuePositionTracker& get_queue_tracker() const { return queue_tracker_; }
+    const Gauges& get_gauges() const { return gauges_; }
 };
 
 // Market simulator for training RL agents
@@ -108,6 +142,7 @@ private:
     double volatility_;
     double arrival_rate_;      // Orders per microsecond
     double spread_width_;
+    double order_lifetime_ns_; // Mean resting time of an order; 0 = until cancelled
     
     // Order distribution
     std::normal_distribution<> price_dist_;
@@ -122,24 +157,20 @@ public:
     void simulate_step(size_t num_orders = 10);
     void simulate_microseconds(uint64_t microseconds);
     
+    // Single arrival and its timing, for event-driven simulation
+    OrderId generate_order();
+    uint64_t sample_interarrival_ns();
+    
     // Configuration
     void set_volatility(double vol) { volatility_ = vol; }
     void set_arrival_rate(double rate) { arrival_rate_ = rate; }
     void set_spread_width(double width) { spread_width_ = width; }
-};
-
-// Performance metrics for backtesting
-struct PerformanceMetrics {
-    double sharpe_ratio;
-    double sortino_ratio;
-    double max_drawdown;
-    double total_return;
-    double win_rate;
-    double profit_factor;
-    size_t total_trades;
-    double avg_trade_duration;
-    
-    void print() const;
+    // Noise orders become GTD with an exponential lifetime of this mean,
+    // measured on the book's clock, so they age out as the book's time advances
+    void set_order_lifetime(std::chrono::nanoseconds mean) { order_lifetime_ns_ = static_cast<double>(mean.count()); }
+    
+    // Reseed the order flow generator (reproducible runs for sweeps/backtests)
+    void seed(uint64_t seed) { rng_.seed(static_cast<std::mt19937::result_type>(seed)); }
 };
 
 // Backtesting engine
@@ -147,20 +178,56 @@ class Backtester {
 private:
     OrderBook orderbook_;
     RLAgent agent_;
+    
+    // Metrics are streamed by the agent; the full curve is only kept on request
+    bool record_equity_curve_;
     std::vector<double> equity_curve_;
-    std::vector<double> returns_;
     
 public:
     Backtester(double initial_cash = 1000000.0);
     
     // Run backtest with custom strategy
+    // If a simulator is given, it generates orders_per_step orders before each decision
     template<typename Strategy>
-    void run(Strategy& strategy, size_t num_steps);
+    void run(Strategy& strategy, size_t num_steps, MarketSimulator* simulator = nullptr,
+             size_t orders_per_step = 5, Quantity order_size = 100);
     
     // Calculate performance metrics
     PerformanceMetrics calculate_metrics() const;
     
+    OrderBook& get_orderbook() { return orderbook_; }
+    RLAgent& get_agent() { return agent_; }
+    
+    // Keep every equity point (memory grows with run length; off by default)
+    void set_record_equity_curve(bool record) { record_equity_curve_ = record; }
     const std::vector<double>& get_equity_curve() const { return equity_curve_; }
 };
 
+template<typename Strategy>
+void Backtester::run(Strategy& strategy, size_t num_steps, MarketSimulator* simulator,
+                     size_t orders_per_step, Quantity order_size) {
+    if (record_equity_curve_) {
+        equity_curve_.reserve(equity_curve_.size() + num_steps);
+    }
+    
+    for (size_t step = 0; step < num_steps; ++step) {
+        if (simulator) {
+            simulator->simulate_step(orders_per_step);
+        }
+        
+        // Get observation
+        auto obs = agent_.get_observation();
+        
+        // Get action from strategy
+        auto action = strategy(obs);
+        
+        // Execute action (the agent streams equity into its metrics)
+        agent_.execute_action(action, order_size);
+        
+        if (record_equity_curve_) {
+            equity_curve_.push_back(agent_.get_portfolio_value());
+        }
+    }
+}
+
 } // namespace orderbook
@@ -0,0 +1,469 @@
+#pragma once
+
+#include "rl_agent.hpp"
+#include <vector>
+#include <deque>
+#include <memory>
+#include <string>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <fstream>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+
+namespace orderbook {
+
+// Parameter sweep runner for strategy tuning
+// Schedules (params, seed, dataset) jobs on a work-stealing thread pool.
+// Every job owns its book, simulator and agent, so jobs share nothing but
+// the results file.
+
+// One point in the parameter space (small, so a flat vector beats a map)
+struct ParamSet {
+    std::vector<std::pair<std::string, double>> values;
+    
+    void set(const std::string& name, double value) {
+        for (auto& [key, v] : values) {
+            if (key == name) {
+                v = value;
+                return;
+            }
+        }
+        values.emplace_back(name, value);
+    }
+    
+    double get(const std::string& name, double default_value = 0.0) const {
+        for (const auto& [key, v] : values) {
+            if (key == name) return v;
+        }
+        return default_value;
+    }
+    
+    std::string to_string() const {
+        std::string out;
+        char buf[64];
+        for (const auto& [key, v] : values) {
+            if (!out.empty()) out += ',';
+            std::snprintf(buf, sizeof(buf), "%.6g", v);
+            out += key + '=' + buf;
+        }
+        return out;
+    }
+};
+
+// Search space: each dimension is either a fixed list (grid) or a range (random search)
+class ParamSpace {
+private:
+    struct Dimension {
+        std::string name;
+        std::vector<double> values;  // Grid / choice values
+        double low;
+        double high;
+        bool log_scale;
+        bool integer;
+    };
+    
+    std::vector<Dimension> dimensions_;
+    
+public:
+    ParamSpace& add_grid(const std::string& name, std::vector<double> values) {
+        dimensions_.push_back({name, std::move(values), 0.0, 0.0, false, false});
+        return *this;
+    }
+    
+    ParamSpace& add_uniform(const std::string& name, double low, double high, bool integer = false) {
+        dimensions_.push_back({name, {}, low, high, false, integer});
+        return *this;
+    }
+    
+    ParamSpace& add_log_uniform(const std::string& name, double low, double high) {
+        dimensions_.push_back({name, {}, low, high, true, false});
+        return *this;
+    }
+    
+    // Cartesian product of all grid dimensions (range dimensions use their midpoint)
+    std::vector<ParamSet> grid() const {
+        std::vector<ParamSet> configs(1);
+        for (const auto& dim : dimensions_) {
+            std::vector<double> values = dim.values;
+            if (values.empty()) {
+                values.push_back(dim.log_scale ? std::sqrt(dim.low * dim.high)
+                                               : (dim.low + dim.high) / 2.0);
+            }
+            
+            std::vector<ParamSet> expanded;
+            expanded.reserve(configs.size() * values.size());
+            for (const auto& base : configs) {
+                for (double v : values) {
+                    ParamSet p = base;
+                    p.set(dim.name, v);
+                    expanded.push_back(std::move(p));
+                }
+            }
+            configs = std::move(expanded);
+        }
+        return configs;
+    }
+    
+    // Random search: grid dimensions are sampled as choices
+    std::vector<ParamSet> sample(size_t count, uint64_t seed) const {
+        std::mt19937_64 rng(seed);
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        
+        std::vector<ParamSet> configs(count);
+        for (auto& p : configs) {
+            for (const auto& dim : dimensions_) {
+                double v;
+                if (!dim.values.empty()) {
+                    v = dim.values[static_cast<size_t>(unit(rng) * dim.values.size()) % dim.values.size()];
+                } else if (dim.log_scale) {
+                    v = std::exp(std::log(dim.low) + unit(rng) * (std::log(dim.high) - std::log(dim.low)));
+                } else {
+                    v = dim.low + unit(rng) * (dim.high - dim.low);
+                }
+                if (dim.integer) v = std::round(v);
+                p.set(dim.name, v);
+            }
+        }
+        return configs;
+    }
+};
+
+// Market regime a job is evaluated on
+struct SweepDataset {
+    std::string name;
+    Price base_price = 10000;
+    double volatility = 0.005;
+    double arrival_rate = 50.0;
+    size_t num_steps = 1000;
+    size_t orders_per_step = 5;
+};
+
+struct SweepJob {
+    size_t config_index;
+    const ParamSet* params;
+    uint64_t seed;
+    const SweepDataset* dataset;
+};
+
+struct SweepResult {
+    size_t config_index;
+    uint64_t seed;
+    size_t dataset_index;
+    PerformanceMetrics metrics;
+    double score;
+    double wall_ms;
+    std::string error;   // What the job threw; empty when it finished
+};
+
+// Aggregated result for one configuration across seeds and datasets
+struct ConfigRanking {
+    size_t config_index;
+    ParamSet params;
+    double mean_score;
+    double worst_score;
+    double mean_return;
+    double mean_drawdown;
+    size_t runs;
+};
+
+// Work-stealing thread pool
+// Each worker pops from the back of its own deque and steals from the front
+// of the others, so long jobs never leave idle cores behind a busy queue.
+class WorkStealingPool {
+private:
+    struct alignas(64) WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+    
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> workers_;
+    std::mutex wait_mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable idle_cv_;
+    std::atomic<size_t> pending_{0};
+    std::atomic<size_t> next_queue_{0};
+    std::atomic<size_t> steals_{0};
+    bool stopping_ = false;
+    std::exception_ptr error_;   // First task exception, rethrown by wait_idle()
+    
+    bool pop_local(size_t index, std::function<void()>& task) {
+        auto& q = *queues_[index];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.empty()) return false;
+        task = std::move(q.tasks.back());
+        q.tasks.pop_back();
+        return true;
+    }
+    
+    bool steal(size_t thief, std::function<void()>& task) {
+        for (size_t i = 1; i < queues_.size(); ++i) {
+            auto& q = *queues_[(thief + i) % queues_.size()];
+            std::unique_lock<std::mutex> lock(q.mutex, std::try_to_lock);
+            if (!lock.owns_lock() || q.tasks.empty()) continue;
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+            steals_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+    
+    void worker_loop(size_t index) {
+        std::function<void()> task;
+        while (true) {
+            if (pop_local(index, task) || steal(index, task)) {
+                try {
+                    task();
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(wait_mutex_);
+                    if (!error_) error_ = std::current_exception();
+                }
+                task = nullptr;
+                if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    std::lock_guard<std::mutex> lock(wait_mutex_);
+                    idle_cv_.notify_all();
+                }
+                continue;
+            }
+            
+            std::unique_lock<std::mutex> lock(wait_mutex_);
+            if (stopping_) return;
+            work_cv_.wait_for(lock, std::chrono::milliseconds(1));
+        }
+    }
+    
+public:
+    explicit WorkStealingPool(size_t num_threads = std::thread::hardware_concurrency()) {
+        num_threads = std::max<size_t>(1, num_threads);
+        for (size_t i = 0; i < num_threads; ++i) {
+            queues_.push_back(std::make_unique<WorkerQueue>());
+        }
+        for (size_t i = 0; i < num_threads; ++i) {
+            workers_.emplace_back([this, i]() { worker_loop(i); });
+        }
+    }
+    
+    ~WorkStealingPool() {
+        {
+            std::unique_lock<std::mutex> lock(wait_mutex_);
+            idle_cv_.wait(lock, [this]() { return pending_.load(std::memory_order_acquire) == 0; });
+        }
+        {
+            std::lock_guard<std::mutex> lock(wait_mutex_);
+            stopping_ = true;
+        }
+        work_cv_.notify_all();
+        for (auto& t : workers_) {
+            t.join();
+        }
+    }
+    
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+    
+    void submit(std::function<void()> task) {
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        size_t index = next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+        {
+            std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+            queues_[index]->tasks.push_back(std::move(task));
+        }
+        work_cv_.notify_one();
+    }
+    
+    // Waits for every submitted task; rethrows the first exception a task threw
+    void wait_idle() {
+        std::unique_lock<std::mutex> lock(wait_mutex_);
+        idle_cv_.wait(lock, [this]() { return pending_.load(std::memory_order_acquire) == 0; });
+        if (error_) {
+            std::exception_ptr error = error_;
+            error_ = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+    
+    size_t size() const { return workers_.size(); }
+    size_t steal_count() const { return steals_.load(std::memory_order_relaxed); }
+};
+
+// Strategy produced per job: maps an observation to an action
+using SweepStrategy = std::function<RLAgent::Action(const RLAgent::Observation&)>;
+using StrategyFactory = std::function<SweepStrategy(const ParamSet&, RLAgent&)>;
+using JobFunction = std::function<PerformanceMetrics(const SweepJob&)>;
+using ScoreFunction = std::function<double(const PerformanceMetrics&)>;
+
+// Default job: simulated backtest on the dataset's regime
+// Recognised parameters: quote_size, inventory_penalty, spread_capture_reward
+inline PerformanceMetrics run_simulated_backtest(const SweepJob& job, const StrategyFactory& factory) {
+    const SweepDataset& data = *job.dataset;
+    Backtester backtester;
+    RLAgent& agent = backtester.get_agent();
+    agent.set_inventory_penalty(job.params->get("inventory_penalty", 0.01));
+    agent.set_spread_capture_reward(job.params->get("spread_capture_reward", 1.0));
+    
+    MarketSimulator sim(backtester.get_orderbook(), data.base_price,
+                        data.volatility, data.arrival_rate);
+    sim.seed(job.seed);
+    
+    // Seed the book with two-sided liquidity so the first decisions see a market
+    sim.simulate_step(data.orders_per_step * 20);
+    
+    SweepStrategy strategy = factory(*job.params, agent);
+    Quantity order_size = static_cast<Quantity>(job.params->get("quote_size", 100));
+    backtester.run(strategy, data.num_steps, &sim, data.orders_per_step, order_size);
+    return backtester.calculate_metrics();
+}
+
+class SweepRunner {
+private:
+    WorkStealingPool pool_;
+    std::string output_path_;
+    ScoreFunction score_;
+    
+    std::mutex results_mutex_;
+    std::vector<SweepResult> results_;
+    std::ofstream output_;
+    std::atomic<size_t> completed_{0};
+    std::atomic<size_t> failed_{0};
+    
+    void write_result(const SweepResult& r, const ParamSet& params, const std::string& dataset) {
+        // One compact tab-separated line per job; the header documents the columns
+        char line[256];
+        int len = std::snprintf(line, sizeof(line),
+            "%zu\t%llu\t%s\t%.6g\t%.6g\t%.6g\t%.6g\t%.6g\t%.6g\t%zu\t%.3f\t",
+            r.config_index, static_cast<unsigned long long>(r.seed), dataset.c_str(),
+            r.score, r.metrics.total_return, r.metrics.sharpe_ratio, r.metrics.sortino_ratio,
+            r.metrics.max_drawdown, r.metrics.win_rate, r.metrics.total_trades, r.wall_ms);
+        output_.write(line, std::max(0, std::min<int>(len, sizeof(line) - 1)));
+        output_ << params.to_string() << '\t' << r.error << '\n';
+    }
+    
+public:
+    explicit SweepRunner(size_t num_threads = std::thread::hardware_concurrency())
+        : pool_(num_threads),
+          score_([](const PerformanceMetrics& m) { return m.sharpe_ratio; }) {}
+    
+    // Results are streamed to this file as jobs finish (empty = keep in memory only)
+    void set_output(const std::string& path) { output_path_ = path; }
+    
+    // Objective used for ranking; defaults to Sharpe ratio
+    void set_score_function(ScoreFunction score) { score_ = std::move(score); }
+    
+    // Run every (config, seed, dataset) combination
+    const std::vector<SweepResult>& run(const std::vector<ParamSet>& configs,
+                                        const std::vector<uint64_t>& seeds,
+                                        const std::vector<SweepDataset>& datasets,
+                                        const JobFunction& job_fn) {
+        results_.clear();
+        results_.reserve(configs.size() * seeds.size() * datasets.size());
+        completed_ = 0;
+        failed_ = 0;
+        
+        if (!output_path_.empty()) {
+            output_.open(output_path_, std::ios::out | std::ios::trunc);
+            output_ << "config\tseed\tdataset\tscore\treturn\tsharpe\tsortino\tmax_dd\twin_rate\ttrades\twall_ms\tparams\terror\n";
+        }
+        
+        for (size_t c = 0; c < configs.size(); ++c) {
+            for (uint64_t seed : seeds) {
+                for (size_t d = 0; d < datasets.size(); ++d) {
+                    SweepJob job{c, &configs[c], seed, &datasets[d]};
+                    pool_.submit([this, job, d, &job_fn]() {
+                        auto start = std::chrono::steady_clock::now();
+                        PerformanceMetrics metrics;
+                        std::string error;
+                        try {
+                            metrics = job_fn(job);
+                        } catch (const std::exception& e) {
+                            error = e.what();
+                        } catch (...) {
+                            error = "unknown exception";
+                        }
+                        auto end = std::chrono::steady_clock::now();
+                        
+                        // A failed job is reported but never ranked
+                        SweepResult r{job.config_index, job.seed, d, metrics,
+                            error.empty() ? score_(metrics) : 0.0,
+                            std::chrono::duration<double, std::milli>(end - start).count(),
+                            std::move(error)};
+                        if (!r.error.empty()) {
+                            failed_.fetch_add(1, std::memory_order_relaxed);
+                        }
+                        
+                        std::lock_guard<std::mutex> lock(results_mutex_);
+                        results_.push_back(r);
+                        if (output_.is_open()) {
+                            write_result(r, *job.params, job.dataset->name);
+                        }
+                        completed_.fetch_add(1, std::memory_order_relaxed);
+                    });
+                }
+            }
+        }
+        
+        pool_.wait_idle();
+        if (output_.is_open()) {
+            output_.close();
+        }
+        return results_;
+    }
+    
+    // Convenience wrapper for the default simulated backtest
+    const std::vector<SweepResult>& run_backtests(const std::vector<ParamSet>& configs,
+                                        const std::vector<uint64_t>& seeds,
+                                        const std::vector<SweepDataset>& datasets,
+                                        const StrategyFactory& factory) {
+        JobFunction job_fn = [&factory](const SweepJob& job) {
+            return run_simulated_backtest(job, factory);
+        };
+        return run(configs, seeds, datasets, job_fn);
+    }
+    
+    // Rank configurations by mean score across seeds and datasets (best first)
+    std::vector<ConfigRanking> rank(const std::vector<ParamSet>& configs) const {
+        std::vector<ConfigRanking> ranking(configs.size());
+        for (size_t c = 0; c < configs.size(); ++c) {
+            ranking[c] = {c, configs[c], 0.0, INFINITY, 0.0, 0.0, 0};
+        }
+        
+        for (const auto& r : results_) {
+            if (!r.error.empty()) continue;
+            auto& entry = ranking[r.config_index];
+            entry.mean_score += r.score;
+            entry.worst_score = std::min(entry.worst_score, r.score);
+            entry.mean_return += r.metrics.total_return;
+            entry.mean_drawdown += r.metrics.max_drawdown;
+            ++entry.runs;
+        }
+        
+        ranking.erase(std::remove_if(ranking.begin(), ranking.end(),
+                                     [](const ConfigRanking& e) { return e.runs == 0; }),
+                      ranking.end());
+        for (auto& entry : ranking) {
+            entry.mean_score /= entry.runs;
+            entry.mean_return /= entry.runs;
+            entry.mean_drawdown /= entry.runs;
+        }
+        
+        std::sort(ranking.begin(), ranking.end(), [](const ConfigRanking& a, const ConfigRanking& b) {
+            return a.mean_score > b.mean_score;
+        });
+        return ranking;
+    }
+    
+    size_t completed() const { return completed_.load(std::memory_order_relaxed); }
+    size_t failed() const { return failed_.load(std::memory_order_relaxed); }
+    size_t thread_count() const { return pool_.size(); }
+    size_t steal_count() const { return pool_.steal_count(); }
+};
+
+} // namespace orderbook
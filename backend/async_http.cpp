@@ -0,0 +1,338 @@
+#include "async_http.hpp"
+#include <curl/curl.h>
+#include <algorithm>
+
+namespace OrderBookNS {
+
+static size_t async_write_callback(void* contents, size_t size, size_t nmemb, void* userp) {
+    static_cast<std::string*>(userp)->append(static_cast<char*>(contents), size * nmemb);
+    return size * nmemb;
+}
+
+void ensure_curl_global_init() {
+    // curl_global_init is not thread-safe; run it once before any handle exists
+    static std::once_flag once;
+    std::call_once(once, []() { curl_global_init(CURL_GLOBAL_DEFAULT); });
+}
+
+namespace {
+
+// DNS cache and TLS session cache shared by every handle in the process
+class SharedCurlState {
+public:
+    SharedCurlState() {
+        ensure_curl_global_init();
+        share_ = curl_share_init();
+        curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, &SharedCurlState::lock);
+        curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, &SharedCurlState::unlock);
+        curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+        curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    }
+    
+    CURLSH* handle() const { return share_; }
+
+private:
+    CURLSH* share_;
+    std::mutex mutexes_[CURL_LOCK_DATA_LAST];
+    
+    static void lock(CURL*, curl_lock_data data, curl_lock_access, void* self) {
+        static_cast<SharedCurlState*>(self)->mutexes_[data].lock();
+    }
+    
+    static void unlock(CURL*, curl_lock_data data, void* self) {
+        static_cast<SharedCurlState*>(self)->mutexes_[data].unlock();
+    }
+};
+
+// "https://host:port/path?query" -> "https://host:port/"
+std::string origin_of(const std::string& url) {
+    size_t scheme = url.find("://");
+    size_t host = scheme == std::string::npos ? 0 : scheme + 3;
+    size_t path = url.find_first_of("/?#", host);
+    return url.substr(0, path) + "/";
+}
+
+} // namespace
+
+void configure_easy_handle(void* handle) {
+    // Never destroyed: handles owned by other statics may outlive any
+    // destructor order we could pick
+    static SharedCurlState* shared = new SharedCurlState();
+    CURL* easy = static_cast<CURL*>(handle);
+    curl_easy_setopt(easy, CURLOPT_SHARE, shared->handle());
+    curl_easy_setopt(easy, CURLOPT_ACCEPT_ENCODING, "");  // Every encoding libcurl was built with
+    curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(easy, CURLOPT_TCP_NODELAY, 1L);
+    curl_easy_setopt(easy, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(easy, CURLOPT_TCP_KEEPIDLE, 30L);
+    curl_easy_setopt(easy, CURLOPT_TCP_KEEPINTVL, 15L);
+}
+
+AsyncHTTPClient::AsyncHTTPClient(long max_host_connections, long max_total_connections)
+    : multi_(nullptr), running_(true), next_id_(1), warm_idle_(30), warm_now_(false),
+      last_activity_(std::chrono::steady_clock::now()), in_flight_(0), completed_(0),
+      new_connections_(0), keepalive_pings_(0) {
+    ensure_curl_global_init();
+    
+    CURLM* multi = curl_multi_init();
+    curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, max_host_connections);
+    curl_multi_setopt(multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, max_total_connections);
+    curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    multi_ = multi;
+    
+    loop_ = std::thread(&AsyncHTTPClient::run, this);
+}
+
+AsyncHTTPClient::~AsyncHTTPClient() {
+    running_ = false;
+    wakeup();
+    if (loop_.joinable()) {
+        loop_.join();
+    }
+    
+    // Anything still pending completes with an error so futures never hang
+    HTTPResponse aborted;
+    aborted.error = "client shut down";
+    CURLM* multi = static_cast<CURLM*>(multi_);
+    for (auto& submission : submissions_) {
+        if (submission.callback) submission.callback(HTTPResponse(aborted));
+    }
+    submissions_.clear();
+    for (auto& [id, transfer] : active_) {
+        curl_multi_remove_handle(multi, static_cast<CURL*>(transfer->easy));
+        Callback callback = std::move(transfer->callback);
+        release_transfer(transfer);
+        if (callback) callback(HTTPResponse(aborted));
+    }
+    active_.clear();
+    for (void* easy : idle_handles_) {
+        curl_easy_cleanup(static_cast<CURL*>(easy));
+    }
+    curl_multi_cleanup(multi);
+}
+
+AsyncHTTPClient::RequestId AsyncHTTPClient::submit(HTTPRequest request, Callback callback) {
+    RequestId id = next_id_.fetch_add(1, std::memory_order_relaxed);
+    in_flight_.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        submissions_.push_back({id, std::move(request), std::move(callback),
+                                std::chrono::steady_clock::now()});
+    }
+    wakeup();
+    return id;
+}
+
+std::future<HTTPResponse> AsyncHTTPClient::get(const std::string& url,
+                                               const std::map<std::string, std::string>& headers,
+                                               long timeout_ms) {
+    auto promise = std::make_shared<std::promise<HTTPResponse>>();
+    auto future = promise->get_future();
+    
+    HTTPRequest request;
+    request.url = url;
+    request.headers = headers;
+    request.timeout_ms = timeout_ms;
+    submit(std::move(request), [promise](HTTPResponse&& response) {
+        promise->set_value(std::move(response));
+    });
+    return future;
+}
+
+void AsyncHTTPClient::keep_warm(const std::vector<std::string>& urls, std::chrono::seconds idle) {
+    std::vector<std::string> origins;
+    for (const auto& url : urls) {
+        std::string origin = origin_of(url);
+        if (std::find(origins.begin(), origins.end(), origin) == origins.end()) {
+            origins.push_back(std::move(origin));
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        warm_origins_ = std::move(origins);
+        warm_idle_ = idle;
+        warm_now_ = true;
+    }
+    wakeup();
+}
+
+void AsyncHTTPClient::cancel(RequestId id) {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        cancellations_.push_back(id);
+    }
+    wakeup();
+}
+
+void AsyncHTTPClient::wakeup() {
+    if (multi_) {
+        curl_multi_wakeup(static_cast<CURLM*>(multi_));
+    }
+}
+
+void AsyncHTTPClient::run() {
+    CURLM* multi = static_cast<CURLM*>(multi_);
+    
+    while (running_.load(std::memory_order_relaxed)) {
+        ping_if_idle();
+        drain_queue();
+        
+        int still_running = 0;
+        curl_multi_perform(multi, &still_running);
+        
+        int remaining = 0;
+        while (CURLMsg* msg = curl_multi_info_read(multi, &remaining)) {
+            if (msg->msg != CURLMSG_DONE) continue;
+            
+            Transfer* transfer = nullptr;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &transfer);
+            CURLcode result = msg->data.result;
+            curl_multi_remove_handle(multi, msg->easy_handle);
+            if (transfer) {
+                finish_transfer(transfer, result);
+            }
+        }
+        
+        // Sleeps until socket activity, a curl timeout, or wakeup()
+        curl_multi_poll(multi, nullptr, 0, 1000, nullptr);
+    }
+}
+
+void AsyncHTTPClient::drain_queue() {
+    std::deque<Submission> submissions;
+    std::vector<RequestId> cancellations;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        submissions.swap(submissions_);
+        cancellations.swap(cancellations_);
+    }
+    
+    for (auto& submission : submissions) {
+        start_transfer(std::move(submission));
+    }
+    
+    CURLM* multi = static_cast<CURLM*>(multi_);
+    for (RequestId id : cancellations) {
+        auto it = active_.find(id);
+        if (it == active_.end()) continue;
+        
+        Transfer* transfer = it->second;
+        active_.erase(it);
+        curl_multi_remove_handle(multi, static_cast<CURL*>(transfer->easy));
+        
+        HTTPResponse response;
+        response.error = "cancelled";
+        response.cancelled = true;
+        response.elapsed_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - transfer->start).count();
+        Callback callback = std::move(transfer->callback);
+        release_transfer(transfer);
+        in_flight_.fetch_sub(1, std::memory_order_relaxed);
+        if (callback) {
+            callback(std::move(response));
+        }
+    }
+}
+
+void AsyncHTTPClient::ping_if_idle() {
+    std::vector<std::string> origins;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (warm_origins_.empty()) return;
+        // Real traffic keeps the connections warm by itself
+        if (!warm_now_ && (!active_.empty() || std::chrono::steady_clock::now() - last_activity_ < warm_idle_)) {
+            return;
+        }
+        warm_now_ = false;
+        origins = warm_origins_;
+    }
+    
+    for (auto& origin : origins) {
+        HTTPRequest request;
+        request.url = std::move(origin);
+        request.head = true;
+        request.timeout_ms = 5000;
+        submit(std::move(request), [this](HTTPResponse&& response) {
+            if (response.error.empty()) {
+                keepalive_pings_.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+}
+
+void AsyncHTTPClient::start_transfer(Submission&& submission) {
+    CURL* easy;
+    if (!idle_handles_.empty()) {
+        easy = static_cast<CURL*>(idle_handles_.back());
+        idle_handles_.pop_back();
+        curl_easy_reset(easy);
+    } else {
+        easy = curl_easy_init();
+    }
+    
+    Transfer* transfer = new Transfer{submission.id, easy, nullptr, std::move(submission.request),
+                                      std::move(submission.callback), std::string(), submission.start};
+    last_activity_ = std::chrono::steady_clock::now();
+    
+    configure_easy_handle(easy);
+    curl_easy_setopt(easy, CURLOPT_URL, transfer->request.url.c_str());
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, async_write_callback);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, &transfer->body);
+    curl_easy_setopt(easy, CURLOPT_PRIVATE, transfer);
+    curl_easy_setopt(easy, CURLOPT_TIMEOUT_MS, transfer->request.timeout_ms);
+    curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT_MS, transfer->request.connect_timeout_ms);
+    curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L);
+    if (transfer->request.head) {
+        curl_easy_setopt(easy, CURLOPT_NOBODY, 1L);
+    }
+    
+    struct curl_slist* header_list = nullptr;
+    for (const auto& [key, value] : transfer->request.headers) {
+        std::string header = key + ": " + value;
+        header_list = curl_slist_append(header_list, header.c_str());
+    }
+    if (header_list) {
+        curl_easy_setopt(easy, CURLOPT_HTTPHEADER, header_list);
+        transfer->header_list = header_list;
+    }
+    
+    active_[transfer->id] = transfer;
+    curl_multi_add_handle(static_cast<CURLM*>(multi_), easy);
+}
+
+void AsyncHTTPClient::finish_transfer(Transfer* transfer, int result) {
+    active_.erase(transfer->id);
+    
+    HTTPResponse response;
+    if (result == CURLE_OK) {
+        curl_easy_getinfo(static_cast<CURL*>(transfer->easy), CURLINFO_RESPONSE_CODE, &response.status);
+        long connects = 0;
+        curl_easy_getinfo(static_cast<CURL*>(transfer->easy), CURLINFO_NUM_CONNECTS, &connects);
+        new_connections_.fetch_add(connects, std::memory_order_relaxed);
+    } else {
+        response.error = curl_easy_strerror(static_cast<CURLcode>(result));
+    }
+    response.body = std::move(transfer->body);
+    response.elapsed_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - transfer->start).count();
+    
+    Callback callback = std::move(transfer->callback);
+    release_transfer(transfer);
+    in_flight_.fetch_sub(1, std::memory_order_relaxed);
+    completed_.fetch_add(1, std::memory_order_relaxed);
+    
+    if (callback) {
+        callback(std::move(response));
+    }
+}
+
+void AsyncHTTPClient::release_transfer(Transfer* transfer) {
+    if (transfer->header_list) {
+        curl_slist_free_all(static_cast<curl_slist*>(transfer->header_list));
+    }
+    idle_handles_.push_back(transfer->easy);
+    delete transfer;
+}
+
+} // namespace OrderBookNS
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace OrderBookNS {
+
+// curl_global_init, once per process; call before creating any curl handle
+void ensure_curl_global_init();
+
+// Options every handle we create shares (call again after curl_easy_reset)
+// Attaches the process-wide curl_share that caches DNS results and TLS
+// sessions, so the first request from any client to a host another client
+// already reached skips the lookup and resumes TLS instead of a full
+// handshake. Also asks for compressed responses (whatever libcurl can
+// decode) and turns on TCP keepalive for idle pooled sockets. Open
+// connections themselves stay per client: libcurl does not support one
+// connection cache shared by concurrent threads.
+void configure_easy_handle(void* easy);  // CURL*
+
+struct HTTPRequest {
+    std::string url;
+    std::map<std::string, std::string> headers;
+    long timeout_ms = 10000;
+    long connect_timeout_ms = 3000;
+    bool head = false;         // HEAD instead of GET (no body); used to warm connections
+};
+
+struct HTTPResponse {
+    long status = 0;           // HTTP status code (0 if the transfer failed)
+    std::string body;
+    std::string error;         // Transport error, empty on success
+    double elapsed_ms = 0.0;   // Submit to completion
+    bool cancelled = false;    // Completed by cancel(); error is "cancelled"
+    
+    bool ok() const { return error.empty() && status == 200; }
+};
+
+// Asynchronous HTTP client on curl_multi
+// One event-loop thread drives every transfer. The multi handle keeps a
+// connection cache, so requests to the same host reuse warm connections
+// (and HTTP/2 streams where the server supports multiplexing). Easy handles
+// are recycled. Completion callbacks run on the loop thread and must not block.
+class AsyncHTTPClient {
+public:
+    using RequestId = uint64_t;
+    using Callback = std::function<void(HTTPResponse&&)>;
+    
+    explicit AsyncHTTPClient(long max_host_connections = 8, long max_total_connections = 64);
+    ~AsyncHTTPClient();
+    
+    AsyncHTTPClient(const AsyncHTTPClient&) = delete;
+    AsyncHTTPClient& operator=(const AsyncHTTPClient&) = delete;
+    
+    // Queue a request; the callback fires exactly once
+    RequestId submit(HTTPRequest request, Callback callback);
+    
+    // Future-based convenience wrapper around submit
+    std::future<HTTPResponse> get(const std::string& url,
+                                  const std::map<std::string, std::string>& headers = {},
+                                  long timeout_ms = 10000);
+    
+    // Abort a request; its callback gets a response with cancelled set (so a
+    // get() future still resolves). Unknown or finished ids are ignored.
+    void cancel(RequestId id);
+    
+    // Open connections to these hosts now and keep them open: whenever no
+    // request has started for `idle`, each host gets a HEAD ping so the
+    // connection cache (and the server's keep-alive) never goes cold. URLs are
+    // reduced to their origin ("https://host:port/"). Replaces any previous list.
+    void keep_warm(const std::vector<std::string>& urls,
+                   std::chrono::seconds idle = std::chrono::seconds(30));
+    
+    size_t in_flight() const { return in_flight_.load(std::memory_order_relaxed); }
+    uint64_t completed() const { return completed_.load(std::memory_order_relaxed); }
+    uint64_t new_connections() const { return new_connections_.load(std::memory_order_relaxed); }
+    uint64_t keepalive_pings() const { return keepalive_pings_.load(std::memory_order_relaxed); }
+
+private:
+    struct Transfer {
+        RequestId id;
+        void* easy;              // CURL*
+        void* header_list;       // curl_slist*
+        HTTPRequest request;
+        Callback callback;
+        std::string body;
+        std::chrono::steady_clock::time_point start;
+    };
+    
+    struct Submission {
+        RequestId id;
+        HTTPRequest request;
+        Callback callback;
+        std::chrono::steady_clock::time_point start;
+    };
+    
+    void* multi_;  // CURLM*
+    std::thread loop_;
+    std::atomic<bool> running_;
+    
+    // Hand-off from callers to the loop thread
+    std::mutex queue_mutex_;
+    std::deque<Submission> submissions_;
+    std::vector<RequestId> cancellations_;
+    std::atomic<RequestId> next_id_;
+    std::vector<std::string> warm_origins_;
+    std::chrono::seconds warm_idle_;
+    bool warm_now_;  // keep_warm was just called; ping without waiting
+    
+    // Loop-thread state
+    std::unordered_map<RequestId, Transfer*> active_;
+    std::vector<void*> idle_handles_;  // Recycled CURL* handles
+    std::chrono::steady_clock::time_point last_activity_;  // Last transfer started
+    
+    std::atomic<size_t> in_flight_;
+    std::atomic<uint64_t> completed_;
+    std::atomic<uint64_t> new_connections_;  // Transfers that could not reuse a connection
+    std::atomic<uint64_t> keepalive_pings_;
+    
+    void run();
+    void drain_queue();
+    void ping_if_idle();
+    void start_transfer(Submission&& submission);
+    void finish_transfer(Transfer* transfer, int result);
+    void release_transfer(Transfer* transfer);
+    void wakeup();
+};
+
+} // namespace OrderBookNS
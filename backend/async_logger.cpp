@@ -0,0 +1,292 @@
+#include "async_logger.hpp"
+#include "thread_topology.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <pthread.h>
+
+namespace OrderBookNS {
+
+namespace {
+
+const char* const LEVEL_NAMES[] = {"DEBUG", "INFO", "WARN", "ERROR", "OFF"};
+
+// Marks the thread's ring closed when the thread exits
+struct RingOwner {
+    std::shared_ptr<LogRing> ring;
+    ~RingOwner() {
+        if (ring) ring->closed.store(true, std::memory_order_release);
+    }
+};
+
+thread_local RingOwner ring_owner;
+
+size_t round_up(size_t n) {
+    size_t size = 2;
+    while (size < n) size <<= 1;
+    return size;
+}
+
+} // namespace
+
+thread_local LogRing* AsyncLogger::thread_ring_ = nullptr;
+
+const char* log_level_name(LogLevel level) {
+    size_t index = static_cast<size_t>(level);
+    return index < sizeof(LEVEL_NAMES) / sizeof(LEVEL_NAMES[0]) ? LEVEL_NAMES[index] : "?";
+}
+
+bool parse_log_level(const std::string& name, LogLevel& level) {
+    std::string upper = name;
+    std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+    for (size_t i = 0; i < sizeof(LEVEL_NAMES) / sizeof(LEVEL_NAMES[0]); ++i) {
+        if (upper == LEVEL_NAMES[i]) {
+            level = static_cast<LogLevel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+LogRing::LogRing(size_t capacity, std::string thread_name)
+    : records_(new LogRecord[round_up(capacity)]()), mask_(round_up(capacity) - 1),
+      thread_name_(std::move(thread_name)) {}
+
+AsyncLogger& AsyncLogger::global() {
+    static AsyncLogger logger;
+    return logger;
+}
+
+AsyncLogger::AsyncLogger()
+    : level_(static_cast<uint8_t>(LogLevel::OFF)), running_(false), written_(0), retired_dropped_(0),
+      file_(nullptr), file_bytes_(0), stamp_second_(-1), stamp_{} {}
+
+AsyncLogger::~AsyncLogger() {
+    stop();
+}
+
+bool AsyncLogger::start(const LogConfig& config) {
+    if (running_.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        config_ = config;
+    }
+    if (!open_file()) {
+        return false;
+    }
+    
+    running_.store(true, std::memory_order_release);
+    writer_ = std::thread(&AsyncLogger::write_loop, this);
+    level_.store(static_cast<uint8_t>(config.level), std::memory_order_release);
+    return true;
+}
+
+void AsyncLogger::stop() {
+    level_.store(static_cast<uint8_t>(LogLevel::OFF), std::memory_order_release);
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+uint64_t AsyncLogger::dropped() const {
+    uint64_t total = retired_dropped_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    for (const auto& ring : rings_) {
+        total += ring->dropped();
+    }
+    return total;
+}
+
+LogRing& AsyncLogger::register_thread() {
+    char name[16] = {};
+    pthread_getname_np(pthread_self(), name, sizeof(name));
+    
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    ring_owner.ring = std::make_shared<LogRing>(config_.ring_records, name);
+    rings_.push_back(ring_owner.ring);
+    thread_ring_ = ring_owner.ring.get();
+    return *thread_ring_;
+}
+
+void AsyncLogger::write_loop() {
+    PollLoop loop(ThreadRole::LOGGER);
+    loop.run([this] { return running_.load(std::memory_order_acquire); }, [this] { return drain(); });
+    
+    // Logging was switched off before running_ was cleared, so this pass is the last
+    drain();
+}
+
+bool AsyncLogger::drain() {
+    // Rings are drained outside the lock so a new thread never waits on disk
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        draining_.assign(rings_.begin(), rings_.end());
+    }
+    
+    uint64_t count = 0;
+    for (const auto& ring : draining_) {
+        while (const LogRecord* record = ring->front()) {
+            format(*record, ring->thread_name());
+            ring->pop();
+            write_line();
+            ++count;
+        }
+    }
+    if (count > 0) {
+        std::fflush(file_);
+        written_.fetch_add(count, std::memory_order_relaxed);
+    }
+    
+    // Free the rings of threads that have exited
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    for (auto it = rings_.begin(); it != rings_.end();) {
+        if ((*it)->closed.load(std::memory_order_acquire) && (*it)->backlog() == 0) {
+            retired_dropped_.fetch_add((*it)->dropped(), std::memory_order_relaxed);
+            it = rings_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return count > 0;
+}
+
+void AsyncLogger::format(const LogRecord& record, const std::string& thread_name) {
+    line_.clear();
+    
+    // The date and time change once a second; only the microseconds per line
+    time_t second = static_cast<time_t>(record.time_ns / 1000000000ULL);
+    if (second != stamp_second_) {
+        std::tm local{};
+        localtime_r(&second, &local);
+        std::strftime(stamp_, sizeof(stamp_), "%Y-%m-%d %H:%M:%S", &local);
+        stamp_second_ = second;
+    }
+    char head[96];
+    std::snprintf(head, sizeof(head), "%s.%06u %-5s %-15s ", stamp_,
+                  static_cast<unsigned>(record.time_ns % 1000000000ULL / 1000),
+                  log_level_name(record.site->level), thread_name.c_str());
+    line_ += head;
+    
+    // Walk the format, printing each conversion with the argument as stored:
+    // length modifiers are replaced to match the stored width
+    const char* p = record.site->format;
+    size_t arg = 0;
+    char spec[32];
+    char piece[128];
+    while (*p) {
+        if (*p != '%') {
+            line_ += *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            line_ += '%';
+            p += 2;
+            continue;
+        }
+        
+        size_t length = 0;
+        spec[length++] = *p++;
+        while (*p && std::strchr("-+ #0123456789.", *p) && length < sizeof(spec) - 4) {
+            spec[length++] = *p++;
+        }
+        while (*p && std::strchr("hlLqjzt", *p)) {
+            ++p;
+        }
+        char conversion = *p ? *p++ : 's';
+        
+        if (arg >= record.arg_count) {
+            line_ += "<missing>";
+            continue;
+        }
+        LogRecord::ArgType type = record.types[arg];
+        const LogRecord::ArgValue& value = record.values[arg];
+        ++arg;
+        
+        if (std::strchr("fFeEgGaA", conversion)) {
+            double number = type == LogRecord::ArgType::DOUBLE ? value.d
+                          : type == LogRecord::ArgType::INT ? static_cast<double>(value.i)
+                          : static_cast<double>(value.u);
+            spec[length++] = conversion;
+            spec[length] = '\0';
+            std::snprintf(piece, sizeof(piece), spec, number);
+        } else if (conversion == 's' || type == LogRecord::ArgType::TEXT) {
+            spec[length++] = 's';
+            spec[length] = '\0';
+            const char* text = type == LogRecord::ArgType::TEXT ? record.text + value.text : "<not text>";
+            std::snprintf(piece, sizeof(piece), spec, text);
+        } else if (conversion == 'c') {
+            spec[length++] = 'c';
+            spec[length] = '\0';
+            std::snprintf(piece, sizeof(piece), spec, static_cast<int>(value.i));
+        } else {
+            bool is_signed = conversion == 'd' || conversion == 'i';
+            spec[length++] = 'l';
+            spec[length++] = 'l';
+            spec[length++] = is_signed || std::strchr("uoxX", conversion) ? conversion : 'd';
+            spec[length] = '\0';
+            if (type == LogRecord::ArgType::DOUBLE) {
+                std::snprintf(piece, sizeof(piece), spec, static_cast<long long>(value.d));
+            } else if (is_signed) {
+                std::snprintf(piece, sizeof(piece), spec, static_cast<long long>(value.i));
+            } else {
+                std::snprintf(piece, sizeof(piece), spec, static_cast<unsigned long long>(value.u));
+            }
+        }
+        line_ += piece;
+    }
+    line_ += '\n';
+}
+
+void AsyncLogger::write_line() {
+    if (file_bytes_ > 0 && file_bytes_ + line_.size() > config_.max_bytes) {
+        rotate();
+    }
+    if (file_) {
+        file_bytes_ += std::fwrite(line_.data(), 1, line_.size(), file_);
+    }
+}
+
+bool AsyncLogger::open_file() {
+    std::error_code error;
+    std::filesystem::path path(config_.file);
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path(), error);
+    }
+    file_ = std::fopen(config_.file.c_str(), "a");
+    if (!file_) {
+        return false;
+    }
+    std::fseek(file_, 0, SEEK_END);
+    long size = std::ftell(file_);
+    file_bytes_ = size > 0 ? static_cast<size_t>(size) : 0;
+    return true;
+}
+
+void AsyncLogger::rotate() {
+    std::fclose(file_);
+    file_ = nullptr;
+    
+    // file.N-1 -> file.N, ..., file -> file.1; the oldest falls off
+    std::error_code error;
+    const std::string& base = config_.file;
+    if (config_.max_files == 0) {
+        std::filesystem::remove(base, error);
+    } else {
+        std::filesystem::remove(base + "." + std::to_string(config_.max_files), error);
+        for (size_t i = config_.max_files; i > 1; --i) {
+            std::filesystem::rename(base + "." + std::to_string(i - 1), base + "." + std::to_string(i), error);
+        }
+        std::filesystem::rename(base, base + ".1", error);
+    }
+    open_file();
+}
+
+} // namespace OrderBookNS
@@ -0,0 +1,266 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <time.h>
+
+namespace OrderBookNS {
+
+enum class LogLevel : uint8_t {
+    DEBUG = 0,
+    INFO = 1,
+    WARN = 2,
+    ERROR = 3,
+    OFF = 4
+};
+
+const char* log_level_name(LogLevel level);
+bool parse_log_level(const std::string& name, LogLevel& level);
+
+// One logging call site; OB_LOG keeps one in static storage per site, and
+// its address is what a record carries instead of the formatted text
+struct LogSite {
+    LogLevel level;
+    const char* format;   // printf-style
+};
+
+// One log call: the site, a timestamp and the raw arguments. Strings are
+// copied into text (truncated when they do not fit).
+struct LogRecord {
+    static constexpr size_t MAX_ARGS = 6;
+    static constexpr size_t TEXT_BYTES = 64;
+    
+    enum class ArgType : uint8_t {
+        INT,
+        UINT,
+        DOUBLE,
+        TEXT      // value.text = offset into text
+    };
+    
+    union ArgValue {
+        int64_t i;
+        uint64_t u;
+        double d;
+        uint32_t text;
+    };
+    
+    const LogSite* site;
+    uint64_t time_ns;     // CLOCK_REALTIME
+    uint8_t arg_count;
+    uint8_t text_used;
+    ArgType types[MAX_ARGS];
+    ArgValue values[MAX_ARGS];
+    char text[TEXT_BYTES];
+};
+
+// Single-producer, single-consumer ring of LogRecords, one per logging thread
+// The producer claims a slot, fills it in place and publishes it; when the
+// ring is full the record is dropped and counted.
+class LogRing {
+public:
+    LogRing(size_t capacity, std::string thread_name);
+    
+    // Producer: a free slot, or nullptr if the ring is full
+    LogRecord* claim() noexcept {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ > mask_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ > mask_) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+        }
+        return &records_[tail & mask_];
+    }
+    
+    void publish() noexcept { tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+    
+    // Consumer: the oldest published record, or nullptr
+    const LogRecord* front() const noexcept {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        return head == tail_.load(std::memory_order_acquire) ? nullptr : &records_[head & mask_];
+    }
+    
+    void pop() noexcept { head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+    
+    size_t backlog() const {
+        return static_cast<size_t>(tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_relaxed));
+    }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    const std::string& thread_name() const { return thread_name_; }
+    
+    // Set when the owning thread exits; the writer frees the ring once drained
+    std::atomic<bool> closed{false};
+    
+private:
+    std::unique_ptr<LogRecord[]> records_;
+    const uint64_t mask_;
+    const std::string thread_name_;
+    std::atomic<uint64_t> dropped_{0};
+    alignas(64) std::atomic<uint64_t> head_{0};   // Written by the consumer
+    alignas(64) std::atomic<uint64_t> tail_{0};   // Written by the producer
+    uint64_t cached_head_ = 0;                    // Producer's last look at head_
+};
+
+struct LogConfig {
+    std::string file = "logs/orderbook.log";
+    LogLevel level = LogLevel::INFO;
+    size_t max_bytes = 16 << 20;    // Rotate when the file would grow past this
+    size_t max_files = 5;           // Rotated files kept: file.1 (newest) .. file.N
+    size_t ring_records = 1024;     // Per logging thread
+};
+
+// Asynchronous logger
+// A log call stamps the time and copies its site pointer and raw arguments
+// into the calling thread's own ring: no formatting, no locks, no syscalls.
+// A writer thread (ThreadRole::LOGGER) drains every ring, formats the
+// records and appends them to a file that rotates at max_bytes:
+//
+//   2026-10-17 14:03:12.123456 ERROR ob-feed  Yahoo Finance: quote AAPL failed (HTTP 429)
+//
+// Records are in order per thread; threads are interleaved per drain pass.
+// Nothing is logged until start() and after stop().
+//
+//   OB_LOG_ERROR("%s: quote %s failed (%s)", name.c_str(), symbol.c_str(), error.c_str());
+class AsyncLogger {
+public:
+    static AsyncLogger& global();
+    ~AsyncLogger();
+    
+    // Open the file (creating its directory) and start the writer; false if
+    // the file cannot be opened
+    bool start(const LogConfig& config = LogConfig());
+    
+    // Write what is queued, close the file and join the writer
+    void stop();
+    
+    bool enabled(LogLevel level) const {
+        return static_cast<uint8_t>(level) >= level_.load(std::memory_order_relaxed);
+    }
+    
+    template<typename... Args>
+    void log(const LogSite& site, const Args&... args) noexcept {
+        static_assert(sizeof...(Args) <= LogRecord::MAX_ARGS, "too many log arguments");
+        LogRing& ring = thread_ring();
+        LogRecord* record = ring.claim();
+        if (!record) return;
+        
+        timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        record->site = &site;
+        record->time_ns = static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+        record->arg_count = 0;
+        record->text_used = 0;
+        (encode(*record, args), ...);
+        ring.publish();
+    }
+    
+    uint64_t written() const { return written_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const;
+    const std::string& path() const { return config_.file; }
+    
+private:
+    AsyncLogger();
+    
+    // The calling thread's ring, created on its first log call
+    LogRing& thread_ring() {
+        LogRing* ring = thread_ring_;
+        return ring ? *ring : register_thread();
+    }
+    LogRing& register_thread();
+    void write_loop();
+    bool drain();
+    void format(const LogRecord& record, const std::string& thread_name);
+    void write_line();
+    bool open_file();
+    void rotate();
+    
+    template<typename T>
+    static void encode(LogRecord& record, const T& value) noexcept {
+        uint8_t index = record.arg_count++;
+        if constexpr (std::is_floating_point<T>::value) {
+            record.types[index] = LogRecord::ArgType::DOUBLE;
+            record.values[index].d = value;
+        } else if constexpr (std::is_enum<T>::value) {
+            record.types[index] = LogRecord::ArgType::INT;
+            record.values[index].i = static_cast<int64_t>(value);
+        } else if constexpr (std::is_signed<T>::value) {
+            record.types[index] = LogRecord::ArgType::INT;
+            record.values[index].i = value;
+        } else if constexpr (std::is_unsigned<T>::value) {
+            record.types[index] = LogRecord::ArgType::UINT;
+            record.values[index].u = value;
+        } else {
+            static_assert(std::is_convertible<T, const char*>::value,
+                          "log arguments must be numbers, enums or C strings");
+            encode_text(record, index, value);
+        }
+    }
+    
+    static void encode_text(LogRecord& record, uint8_t index, const char* text) noexcept {
+        size_t room = LogRecord::TEXT_BYTES - record.text_used;
+        size_t length = text ? strnlen(text, room ? room - 1 : 0) : 0;
+        record.types[index] = LogRecord::ArgType::TEXT;
+        record.values[index].text = record.text_used;
+        if (room == 0) {
+            record.values[index].text = LogRecord::TEXT_BYTES - 1;   // The last string's NUL
+            return;
+        }
+        std::memcpy(record.text + record.text_used, text ? text : "", length);
+        record.text[record.text_used + length] = '\0';
+        record.text_used = static_cast<uint8_t>(record.text_used + length + 1);
+    }
+    
+    static thread_local LogRing* thread_ring_;
+    
+    LogConfig config_;
+    std::atomic<uint8_t> level_;
+    std::atomic<bool> running_;
+    std::thread writer_;
+    std::atomic<uint64_t> written_;
+    
+    // Every thread's ring; the mutex is taken when a thread logs for the
+    // first time and by the writer once per pass
+    mutable std::mutex rings_mutex_;
+    std::vector<std::shared_ptr<LogRing>> rings_;
+    std::atomic<uint64_t> retired_dropped_;   // Drops of rings already freed
+    
+    // Writer thread only
+    std::vector<std::shared_ptr<LogRing>> draining_;
+    std::FILE* file_;
+    size_t file_bytes_;
+    std::string line_;
+    time_t stamp_second_;
+    char stamp_[32];
+};
+
+} // namespace OrderBookNS
+
+// Log through the global logger. Arguments are numbers, enums or C strings
+// (pass std::string as .c_str()); the dead printf call only makes the
+// compiler check them against the format.
+#define OB_LOG(log_level, fmt, ...)                                                     \
+    do {                                                                                \
+        static const ::OrderBookNS::LogSite ob_log_site_{log_level, fmt};               \
+        ::OrderBookNS::AsyncLogger& ob_logger_ = ::OrderBookNS::AsyncLogger::global();  \
+        if (ob_logger_.enabled(log_level)) {                                            \
+            ob_logger_.log(ob_log_site_, ##__VA_ARGS__);                                \
+        }                                                                               \
+        if (false) {                                                                    \
+            std::printf(fmt, ##__VA_ARGS__);                                            \
+        }                                                                               \
+    } while (0)
+
+#define OB_LOG_DEBUG(fmt, ...) OB_LOG(::OrderBookNS::LogLevel::DEBUG, fmt, ##__VA_ARGS__)
+#define OB_LOG_INFO(fmt, ...) OB_LOG(::OrderBookNS::LogLevel::INFO, fmt, ##__VA_ARGS__)
+#define OB_LOG_WARN(fmt, ...) OB_LOG(::OrderBookNS::LogLevel::WARN, fmt, ##__VA_ARGS__)
+#define OB_LOG_ERROR(fmt, ...) OB_LOG(::OrderBookNS::LogLevel::ERROR, fmt, ##__VA_ARGS__)
@@ -0,0 +1,402 @@
+#include "bar_cache.hpp"
+#include "columnar.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <system_error>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace OrderBookNS {
+
+namespace {
+
+constexpr char FILE_MAGIC[4] = {'O', 'B', 'B', '1'};
+constexpr uint32_t FILE_VERSION = 1;
+constexpr size_t FILE_HEADER_SIZE = 16;
+constexpr uint64_t NS_PER_SECOND = 1000000000ULL;
+constexpr uint64_t NS_PER_DAY = 86400ULL * NS_PER_SECOND;
+constexpr int MAX_DEPTH = 1 << 30;
+
+// Symbols and intervals become path components; keep them to a safe alphabet
+std::string path_component(const std::string& name) {
+    std::string safe = name;
+    for (char& c : safe) {
+        bool ok = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+                  c == '.' || c == '-' || c == '^' || c == '=';
+        if (!ok) c = '_';
+    }
+    if (safe.empty() || safe[0] == '.') safe.insert(safe.begin(), '_');
+    return safe;
+}
+
+std::string cache_key(const std::string& symbol, const std::string& interval) {
+    return symbol + '|' + interval;
+}
+
+// Start of the newest bar that has closed by now_ns
+uint64_t last_closed_start(uint64_t now_ns, uint64_t interval_ns) {
+    uint64_t current = now_ns / interval_ns * interval_ns;
+    return current >= interval_ns ? current - interval_ns : 0;
+}
+
+// Appends every intact block of a mapped bar file to out; returns the number
+// of bytes that decoded cleanly (0 if the header is wrong)
+size_t decode_file(const columnar::MappedFile& file, const std::string& symbol,
+                   uint64_t interval_ns, std::vector<OHLCV>& out) {
+    const uint8_t* data = file.data();
+    const uint8_t* end = data + file.size();
+    if (file.size() < FILE_HEADER_SIZE || std::memcmp(data, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 ||
+        columnar::get_u32(data + 4) != FILE_VERSION ||
+        columnar::get_u32(data + 8) != interval_ns / NS_PER_SECOND) {
+        return 0;
+    }
+    const uint64_t day_start = columnar::get_u32(data + 12) * NS_PER_DAY;
+    const int64_t step = static_cast<int64_t>(interval_ns);
+    
+    const uint8_t* block = data + FILE_HEADER_SIZE;
+    while (static_cast<size_t>(end - block) >= columnar::BLOCK_HEADER_SIZE) {
+        uint32_t rows = columnar::get_u32(block);
+        uint32_t bytes = columnar::get_u32(block + 4);
+        const uint8_t* p = block + columnar::BLOCK_HEADER_SIZE;
+        const uint8_t* payload_end = p + bytes;
+        if (rows == 0 || bytes > static_cast<size_t>(end - p) ||
+            columnar::checksum(p, bytes) != columnar::get_u32(block + 8)) {
+            break;
+        }
+        
+        size_t base = out.size();
+        out.resize(base + rows);
+        OHLCV* bars = out.data() + base;
+        bool ok = true;
+        
+        uint64_t timestamp = day_start;
+        for (uint32_t i = 0; ok && i < rows; ++i) {
+            if (i == 0) {
+                uint64_t offset = 0;
+                ok = columnar::get_varint(p, payload_end, offset);
+                timestamp += offset;
+            } else {
+                int64_t jitter = 0;
+                ok = columnar::get_svarint(p, payload_end, jitter);
+                timestamp += static_cast<uint64_t>(step + jitter);
+            }
+            bars[i].symbol = symbol;
+            bars[i].timestamp = timestamp;
+        }
+        int64_t open = 0;
+        for (uint32_t i = 0; ok && i < rows; ++i) {
+            int64_t delta = 0;
+            ok = columnar::get_svarint(p, payload_end, delta);
+            open += delta;
+            bars[i].open = open;
+        }
+        Price OHLCV::* const offsets[3] = {&OHLCV::high, &OHLCV::low, &OHLCV::close};
+        for (auto column : offsets) {
+            for (uint32_t i = 0; ok && i < rows; ++i) {
+                int64_t delta = 0;
+                ok = columnar::get_svarint(p, payload_end, delta);
+                bars[i].*column = bars[i].open + delta;
+            }
+        }
+        for (uint32_t i = 0; ok && i < rows; ++i) {
+            uint64_t volume = 0;
+            ok = columnar::get_varint(p, payload_end, volume);
+            bars[i].volume = volume;
+        }
+        
+        if (!ok || p != payload_end) {
+            out.resize(base);
+            break;
+        }
+        block = payload_end;
+    }
+    return static_cast<size_t>(block - data);
+}
+
+} // namespace
+
+BarCache::BarCache(std::string root) : root_(std::move(root)) {
+}
+
+uint64_t BarCache::interval_ns(const std::string& interval) {
+    static const std::pair<const char*, uint64_t> known[] = {
+        {"1min", 60}, {"1m", 60}, {"2m", 120}, {"5min", 300}, {"5m", 300},
+        {"15min", 900}, {"15m", 900}, {"30min", 1800}, {"30m", 1800},
+        {"60min", 3600}, {"60m", 3600}, {"1hour", 3600}, {"1h", 3600},
+        {"4hour", 14400}, {"1d", 86400}, {"1day", 86400}, {"daily", 86400}
+    };
+    for (const auto& [name, seconds] : known) {
+        if (interval == name) {
+            return seconds * NS_PER_SECOND;
+        }
+    }
+    return 0;
+}
+
+uint64_t BarCache::now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+std::string BarCache::file_path(const std::string& symbol, const std::string& interval, uint64_t day_ns) const {
+    std::time_t seconds = static_cast<std::time_t>(day_ns / NS_PER_SECOND);
+    std::tm utc{};
+    gmtime_r(&seconds, &utc);
+    char day[16];
+    std::strftime(day, sizeof(day), "%Y%m%d", &utc);
+    return root_ + "/" + path_component(symbol) + "/" + day + "." + path_component(interval) + ".bars";
+}
+
+size_t BarCache::read(const std::string& symbol, const std::string& interval,
+                      uint64_t from_ns, uint64_t to_ns, std::vector<OHLCV>& out) const {
+    uint64_t step = interval_ns(interval);
+    if (!step || to_ns <= from_ns) {
+        return 0;
+    }
+    
+    size_t base = out.size();
+    columnar::MappedFile file;
+    for (uint64_t day = from_ns / NS_PER_DAY; day <= (to_ns - 1) / NS_PER_DAY; ++day) {
+        if (!file.map(file_path(symbol, interval, day * NS_PER_DAY))) continue;
+        size_t first = out.size();
+        decode_file(file, symbol, step, out);
+        out.erase(std::remove_if(out.begin() + first, out.end(), [&](const OHLCV& bar) {
+            return bar.timestamp < from_ns || bar.timestamp >= to_ns;
+        }), out.end());
+    }
+    return out.size() - base;
+}
+
+size_t BarCache::read_latest(const std::string& symbol, const std::string& interval, int limit,
+                             std::vector<OHLCV>& out) const {
+    uint64_t step = interval_ns(interval);
+    if (!step || limit <= 0) {
+        return 0;
+    }
+    
+    // Day files for this interval, newest first (names start with YYYYMMDD)
+    const std::string suffix = "." + path_component(interval) + ".bars";
+    std::vector<std::string> files;
+    std::error_code error;
+    for (std::filesystem::directory_iterator it(root_ + "/" + path_component(symbol), error), end;
+         !error && it != end; it.increment(error)) {
+        std::string name = it->path().filename().string();
+        if (name.size() == 8 + suffix.size() && name.compare(8, suffix.size(), suffix) == 0) {
+            files.push_back(it->path().string());
+        }
+    }
+    std::sort(files.rbegin(), files.rend());
+    
+    // Decode backwards a day at a time until enough bars are in hand
+    std::vector<std::vector<OHLCV>> days;
+    size_t total = 0;
+    columnar::MappedFile file;
+    for (const auto& path : files) {
+        if (total >= static_cast<size_t>(limit)) break;
+        if (!file.map(path)) continue;
+        days.emplace_back();
+        decode_file(file, symbol, step, days.back());
+        total += days.back().size();
+    }
+    
+    size_t skip = total > static_cast<size_t>(limit) ? total - limit : 0;
+    size_t added = 0;
+    for (auto day = days.rbegin(); day != days.rend(); ++day) {
+        size_t first = std::min(skip, day->size());
+        skip -= first;
+        out.insert(out.end(), day->begin() + first, day->end());
+        added += day->size() - first;
+    }
+    return added;
+}
+
+size_t BarCache::append(const std::string& symbol, const std::string& interval,
+                        const std::vector<OHLCV>& bars, uint64_t now_ns) {
+    uint64_t step = interval_ns(interval);
+    if (!step) {
+        return 0;
+    }
+    
+    std::vector<OHLCV> closed;
+    closed.reserve(bars.size());
+    for (const auto& bar : bars) {
+        if (bar.timestamp != 0 && bar.timestamp + step <= now_ns) {
+            closed.push_back(bar);
+        }
+    }
+    std::stable_sort(closed.begin(), closed.end(), [](const OHLCV& a, const OHLCV& b) {
+        return a.timestamp < b.timestamp;
+    });
+    closed.erase(std::unique(closed.begin(), closed.end(), [](const OHLCV& a, const OHLCV& b) {
+        return a.timestamp == b.timestamp;
+    }), closed.end());
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t written = 0;
+    for (size_t first = 0; first < closed.size();) {
+        uint64_t day = closed[first].timestamp / NS_PER_DAY;
+        size_t last = first;
+        while (last < closed.size() && closed[last].timestamp / NS_PER_DAY == day) ++last;
+        
+        std::string path = file_path(symbol, interval, day * NS_PER_DAY);
+        uint64_t newest = last_on_disk(path, step);
+        size_t start = first;
+        while (start < last && closed[start].timestamp <= newest) ++start;
+        if (start < last) {
+            if (write_block(path, step, day * NS_PER_DAY, closed, start, last)) {
+                last_written_[path] = closed[last - 1].timestamp;
+                written += last - start;
+            } else {
+                last_written_.erase(path);  // Rescan (and trim) before the next append
+            }
+        }
+        first = last;
+    }
+    return written;
+}
+
+int BarCache::bars_to_fetch(const std::string& symbol, const std::string& interval, int limit,
+                            uint64_t now_ns) {
+    uint64_t step = interval_ns(interval);
+    if (!step || limit <= 0) {
+        return limit;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = coverage_.find(cache_key(symbol, interval));
+    if (it == coverage_.end() || it->second.depth < limit) {
+        return limit + 1;
+    }
+    uint64_t through = last_closed_start(now_ns, step);
+    if (through <= it->second.through) {
+        return 0;
+    }
+    uint64_t gap = (through - it->second.through) / step;
+    return static_cast<int>(std::min<uint64_t>(gap, static_cast<uint64_t>(limit))) + 1;
+}
+
+void BarCache::store(const std::string& symbol, const std::string& interval, int requested,
+                     const std::vector<OHLCV>& bars, uint64_t now_ns) {
+    uint64_t step = interval_ns(interval);
+    if (!step) {
+        return;
+    }
+    append(symbol, interval, bars, now_ns);
+    
+    // A short answer still counts: the provider has nothing older to give
+    uint64_t through = last_closed_start(now_ns, step);
+    std::lock_guard<std::mutex> lock(mutex_);
+    Coverage& coverage = coverage_[cache_key(symbol, interval)];
+    uint64_t gap = coverage.through && through > coverage.through ? (through - coverage.through) / step : 0;
+    if (coverage.through && gap < static_cast<uint64_t>(requested)) {
+        coverage.depth = static_cast<int>(std::min<uint64_t>(coverage.depth + gap, MAX_DEPTH));
+    } else {
+        coverage.depth = std::max(requested - 1, 0);
+    }
+    coverage.through = std::max(coverage.through, through);
+}
+
+bool BarCache::latest(const std::string& symbol, const std::string& interval, int limit,
+                      const std::vector<OHLCV>& fresh, uint64_t now_ns, std::vector<OHLCV>& out) const {
+    out.clear();
+    uint64_t step = interval_ns(interval);
+    if (!step || limit <= 0) {
+        return false;
+    }
+    
+    const OHLCV* forming = nullptr;
+    for (const auto& bar : fresh) {
+        if (bar.timestamp + step > now_ns && (!forming || bar.timestamp > forming->timestamp)) {
+            forming = &bar;
+        }
+    }
+    
+    read_latest(symbol, interval, forming ? limit - 1 : limit, out);
+    if (forming && (out.empty() || forming->timestamp > out.back().timestamp)) {
+        out.push_back(*forming);
+    }
+    return !out.empty();
+}
+
+uint64_t BarCache::last_on_disk(const std::string& path, uint64_t interval_ns) {
+    auto it = last_written_.find(path);
+    if (it != last_written_.end()) {
+        return it->second;
+    }
+    
+    // First touch this run: find the newest bar and cut off a torn tail,
+    // but only behind a header we recognise
+    uint64_t newest = 0;
+    columnar::MappedFile file;
+    if (file.map(path) && file.size() > 0) {
+        std::vector<OHLCV> bars;
+        size_t good = decode_file(file, std::string(), interval_ns, bars);
+        if (!bars.empty()) {
+            newest = bars.back().timestamp;
+        }
+        if (good == 0) {
+            newest = UINT64_MAX;  // Another version's (or not our) file: never append to it
+        } else if (good < file.size()) {
+            file.unmap();
+            if (::truncate(path.c_str(), static_cast<off_t>(good)) != 0) {
+                newest = UINT64_MAX;  // Leave a file we cannot repair alone
+            }
+        }
+    }
+    last_written_[path] = newest;
+    return newest;
+}
+
+bool BarCache::write_block(const std::string& path, uint64_t interval_ns, uint64_t day_start,
+                           const std::vector<OHLCV>& bars, size_t first, size_t last) {
+    std::string payload;
+    payload.reserve((last - first) * 12);
+    
+    const int64_t step = static_cast<int64_t>(interval_ns);
+    for (size_t i = first; i < last; ++i) {
+        if (i == first) {
+            columnar::put_varint(payload, bars[i].timestamp - day_start);
+        } else {
+            columnar::put_svarint(payload, static_cast<int64_t>(bars[i].timestamp - bars[i - 1].timestamp) - step);
+        }
+    }
+    Price open = 0;
+    for (size_t i = first; i < last; ++i) {
+        columnar::put_svarint(payload, bars[i].open - open);
+        open = bars[i].open;
+    }
+    for (size_t i = first; i < last; ++i) columnar::put_svarint(payload, bars[i].high - bars[i].open);
+    for (size_t i = first; i < last; ++i) columnar::put_svarint(payload, bars[i].low - bars[i].open);
+    for (size_t i = first; i < last; ++i) columnar::put_svarint(payload, bars[i].close - bars[i].open);
+    for (size_t i = first; i < last; ++i) columnar::put_varint(payload, bars[i].volume);
+    
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    
+    // Header (on a new file) and block go out in one write
+    std::string buffer;
+    buffer.reserve(FILE_HEADER_SIZE + columnar::BLOCK_HEADER_SIZE + payload.size());
+    if (::lseek(fd, 0, SEEK_END) == 0) {
+        buffer.append(FILE_MAGIC, sizeof(FILE_MAGIC));
+        columnar::put_u32(buffer, FILE_VERSION);
+        columnar::put_u32(buffer, static_cast<uint32_t>(interval_ns / NS_PER_SECOND));
+        columnar::put_u32(buffer, static_cast<uint32_t>(day_start / NS_PER_DAY));
+    }
+    columnar::put_u32(buffer, static_cast<uint32_t>(last - first));
+    columnar::put_u32(buffer, static_cast<uint32_t>(payload.size()));
+    columnar::put_u32(buffer, columnar::checksum(reinterpret_cast<const uint8_t*>(payload.data()), payload.size()));
+    buffer += payload;
+    
+    bool ok = columnar::write_all(fd, buffer);
+    ::close(fd);
+    return ok;
+}
+
+} // namespace OrderBookNS
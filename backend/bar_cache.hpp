@@ -0,0 +1,104 @@
+#pragma once
+
+#include "market_data.hpp"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+
+namespace OrderBookNS {
+
+// On-disk columnar OHLCV cache
+// One append-only file per symbol, UTC day and interval:
+//
+//   <root>/<SYMBOL>/<YYYYMMDD>.<interval>.bars
+//
+// A file is a 16-byte header ("OBB1", uint32 version, uint32 interval
+// seconds, uint32 UTC day number) followed by blocks. Each append writes one
+// block: uint32 rows, uint32 payload bytes, uint32 FNV-1a of the payload, then
+// the payload column by column, all varints:
+//
+//   timestamp  first: ns since the file's UTC midnight; then zigzag(delta - interval)
+//   open       zigzag(open - previous open), first against 0
+//   high/low/close  zigzag(value - open)
+//   volume     plain
+//
+// so a regular run of 1-minute bars costs a few bytes per bar. Only bars that
+// have closed are stored, and each file only grows forward in time: bars at
+// or before the newest one on disk are dropped. A block torn by a crash is cut
+// off the next time the file is appended to; readers stop before it.
+//
+// Reads map the files (columnar::MappedFile) and decode straight into OHLCV,
+// so backtests and simulator calibration can replay days without a provider.
+// bars_to_fetch/store let the aggregator fetch only the bars it is missing.
+class BarCache {
+public:
+    explicit BarCache(std::string root = "data/bars");
+    
+    BarCache(const BarCache&) = delete;
+    BarCache& operator=(const BarCache&) = delete;
+    
+    const std::string& root() const { return root_; }
+    
+    // Bar length of a provider interval string ("1min", "5m", "1h", "1d", ...);
+    // 0 if the interval is not cached
+    static uint64_t interval_ns(const std::string& interval);
+    
+    // Current wall-clock time in Unix nanoseconds
+    static uint64_t now_ns();
+    
+    // Bars with from_ns <= timestamp < to_ns, oldest first, appended to out;
+    // returns how many were added
+    size_t read(const std::string& symbol, const std::string& interval,
+                uint64_t from_ns, uint64_t to_ns, std::vector<OHLCV>& out) const;
+    
+    // The newest `limit` bars on disk, oldest first, appended to out
+    size_t read_latest(const std::string& symbol, const std::string& interval, int limit,
+                       std::vector<OHLCV>& out) const;
+    
+    // Write the bars that had closed by now_ns and are newer than what is on
+    // disk (any order, duplicates allowed); returns how many were written
+    size_t append(const std::string& symbol, const std::string& interval,
+                  const std::vector<OHLCV>& bars, uint64_t now_ns);
+    
+    // How many of the newest bars to ask a provider for so that the last
+    // `limit` closed bars are on disk: 0 when they already are, a few after
+    // new bars have closed, or a full limit + 1 the first time (the provider
+    // counts the bar still forming). Coverage is kept in memory, so a fresh
+    // process starts with one full fetch per symbol and interval.
+    int bars_to_fetch(const std::string& symbol, const std::string& interval, int limit,
+                      uint64_t now_ns);
+    
+    // Record a provider answer to a request for `requested` bars made at now_ns
+    void store(const std::string& symbol, const std::string& interval, int requested,
+               const std::vector<OHLCV>& bars, uint64_t now_ns);
+    
+    // get_ohlcv's answer: the newest `limit` bars, oldest first. Closed bars
+    // come from disk; the bar still forming is taken from `fresh` (what was
+    // just fetched, if anything). Replaces the contents of out.
+    bool latest(const std::string& symbol, const std::string& interval, int limit,
+                const std::vector<OHLCV>& fresh, uint64_t now_ns, std::vector<OHLCV>& out) const;
+    
+    // File holding a symbol's bars for the UTC day containing day_ns
+    std::string file_path(const std::string& symbol, const std::string& interval, uint64_t day_ns) const;
+    
+private:
+    // Per symbol and interval: bars up to `through` (start of the newest
+    // closed bar at the last fetch) and `depth` bars back from it are known
+    struct Coverage {
+        uint64_t through = 0;
+        int depth = 0;
+    };
+    
+    std::string root_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Coverage> coverage_;
+    std::unordered_map<std::string, uint64_t> last_written_;  // Path -> newest timestamp on disk
+    
+    uint64_t last_on_disk(const std::string& path, uint64_t interval_ns);
+    bool write_block(const std::string& path, uint64_t interval_ns, uint64_t day_start,
+                     const std::vector<OHLCV>& bars, size_t first, size_t last);
+};
+
+} // namespace OrderBookNS
@@ -0,0 +1,292 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace OrderBookNS {
+namespace columnar {
+
+// Building blocks for the on-disk column files
+// Columns are stored as LEB128 varints: timestamps as deltas from the previous
+// row, signed values zigzag-encoded so small moves either way take one byte.
+// Files are appended block by block and read back through mmap.
+
+inline uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+inline void put_varint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+inline void put_svarint(std::string& out, int64_t value) {
+    put_varint(out, zigzag(value));
+}
+
+// Reads one varint at p, advancing it; false if the buffer ends mid-value
+// or the value does not fit in 64 bits
+inline bool get_varint(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        uint8_t byte = *p++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool get_svarint(const uint8_t*& p, const uint8_t* end, int64_t& value) {
+    uint64_t raw;
+    if (!get_varint(p, end, raw)) return false;
+    value = unzigzag(raw);
+    return true;
+}
+
+// Little-endian fixed-width fields for file and block headers
+inline void put_u32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+inline uint32_t get_u32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+           static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+// FNV-1a over a block payload, to spot a block torn by a crash mid-append
+inline uint32_t checksum(const uint8_t* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Read-only mapping of a whole file
+// map() maps the file at its current size and can be called again to pick up
+// bytes appended since; the mapping is kept when the same file has not grown.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { unmap(); }
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    MappedFile(MappedFile&& other) noexcept
+        : path_(std::move(other.path_)), data_(std::exchange(other.data_, nullptr)),
+          size_(std::exchange(other.size_, 0)) {}
+    
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            path_ = std::move(other.path_);
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+    
+    // False if the file cannot be opened; an empty file maps to size 0
+    bool map(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            unmap();
+            return false;
+        }
+        
+        struct stat st;
+        bool ok = ::fstat(fd, &st) == 0;
+        size_t size = ok ? static_cast<size_t>(st.st_size) : 0;
+        if (ok && (size != size_ || path != path_)) {
+            unmap();
+            path_ = path;
+            if (size > 0) {
+                void* data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+                if (data == MAP_FAILED) {
+                    ok = false;
+                } else {
+                    ::madvise(data, size, MADV_SEQUENTIAL);
+                    data_ = static_cast<const uint8_t*>(data);
+                    size_ = size;
+                }
+            }
+        }
+        ::close(fd);
+        return ok;
+    }
+    
+    void unmap() {
+        if (data_) {
+            ::munmap(const_cast<uint8_t*>(data_), size_);
+        }
+        path_.clear();
+        data_ = nullptr;
+        size_ = 0;
+    }
+    
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    
+private:
+    std::string path_;
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Single-column files
+// A 16-byte header ("OBC1", uint32 version, uint32 encoding, uint32 reserved)
+// followed by blocks laid out as in the bar cache: uint32 rows, uint32
+// payload bytes, uint32 FNV-1a of the payload, then one varint per row.
+// DELTA values are zigzag(value - previous), starting from 0 in each block,
+// so every block decodes on its own.
+enum class Encoding : uint32_t {
+    VARINT = 0,   // Unsigned, as is
+    DELTA = 1     // Signed, delta from the previous row
+};
+
+constexpr char COLUMN_MAGIC[4] = {'O', 'B', 'C', '1'};
+constexpr uint32_t COLUMN_VERSION = 1;
+constexpr size_t COLUMN_HEADER_SIZE = 16;
+constexpr size_t BLOCK_HEADER_SIZE = 12;
+
+// Writes everything in buffer to fd; false on an I/O error
+inline bool write_all(int fd, const std::string& buffer) {
+    const char* p = buffer.data();
+    size_t left = buffer.size();
+    while (left > 0) {
+        ssize_t n = ::write(fd, p, left);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        left -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Encodes one column block by block; flush() appends the block to the file
+class ColumnWriter {
+public:
+    ColumnWriter(std::string path, Encoding encoding) : path_(std::move(path)), encoding_(encoding) {}
+    ~ColumnWriter() {
+        if (fd_ >= 0) ::close(fd_);
+    }
+    
+    ColumnWriter(const ColumnWriter&) = delete;
+    ColumnWriter& operator=(const ColumnWriter&) = delete;
+    
+    void push(int64_t value) {
+        if (encoding_ == Encoding::DELTA) {
+            put_svarint(block_, value - previous_);
+            previous_ = value;
+        } else {
+            put_varint(block_, static_cast<uint64_t>(value));
+        }
+        ++rows_;
+    }
+    
+    uint32_t rows() const { return rows_; }
+    const std::string& path() const { return path_; }
+    
+    // Append the pending block (header first on a new file); false on an I/O error
+    bool flush() {
+        if (rows_ == 0) return true;
+        if (fd_ < 0) {
+            fd_ = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+            if (fd_ < 0) return false;
+        }
+        
+        std::string buffer;
+        buffer.reserve(COLUMN_HEADER_SIZE + BLOCK_HEADER_SIZE + block_.size());
+        if (::lseek(fd_, 0, SEEK_END) == 0) {
+            buffer.append(COLUMN_MAGIC, sizeof(COLUMN_MAGIC));
+            put_u32(buffer, COLUMN_VERSION);
+            put_u32(buffer, static_cast<uint32_t>(encoding_));
+            put_u32(buffer, 0);
+        }
+        put_u32(buffer, rows_);
+        put_u32(buffer, static_cast<uint32_t>(block_.size()));
+        put_u32(buffer, checksum(reinterpret_cast<const uint8_t*>(block_.data()), block_.size()));
+        buffer += block_;
+        
+        block_.clear();
+        rows_ = 0;
+        previous_ = 0;
+        return write_all(fd_, buffer);
+    }
+    
+private:
+    std::string path_;
+    Encoding encoding_;
+    int fd_ = -1;
+    std::string block_;
+    uint32_t rows_ = 0;
+    int64_t previous_ = 0;
+};
+
+// Appends every intact block of a column file to values (read through mmap);
+// stops at the first torn or corrupt block. False if the file is missing or
+// not a column file.
+inline bool read_column(const std::string& path, std::vector<int64_t>& values) {
+    MappedFile file;
+    if (!file.map(path)) return false;
+    const uint8_t* data = file.data();
+    const uint8_t* end = data + file.size();
+    if (file.size() < COLUMN_HEADER_SIZE || std::memcmp(data, COLUMN_MAGIC, sizeof(COLUMN_MAGIC)) != 0 ||
+        get_u32(data + 4) != COLUMN_VERSION) {
+        return false;
+    }
+    const bool delta = get_u32(data + 8) == static_cast<uint32_t>(Encoding::DELTA);
+    
+    const uint8_t* block = data + COLUMN_HEADER_SIZE;
+    while (static_cast<size_t>(end - block) >= BLOCK_HEADER_SIZE) {
+        uint32_t rows = get_u32(block);
+        uint32_t bytes = get_u32(block + 4);
+        const uint8_t* p = block + BLOCK_HEADER_SIZE;
+        const uint8_t* payload_end = p + bytes;
+        if (bytes > static_cast<size_t>(end - p) || checksum(p, bytes) != get_u32(block + 8)) {
+            break;
+        }
+        
+        size_t base = values.size();
+        int64_t previous = 0;
+        bool ok = true;
+        for (uint32_t i = 0; ok && i < rows; ++i) {
+            uint64_t raw = 0;
+            ok = get_varint(p, payload_end, raw);
+            previous = delta ? previous + unzigzag(raw) : static_cast<int64_t>(raw);
+            values.push_back(previous);
+        }
+        if (!ok || p != payload_end) {
+            values.resize(base);
+            break;
+        }
+        block = payload_end;
+    }
+    return true;
+}
+
+} // namespace columnar
+} // namespace OrderBookNS
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "order.hpp"
+#include "timer_wheel.hpp"
+#include <cstdint>
+
+namespace orderbook {
+
+// Simulated time in nanoseconds
+using SimTime = uint64_t;
+
+enum class SimEventType : uint8_t {
+    MARKET_ORDER = 0,    // Background order flow arrival
+    AGENT_DECISION = 1,  // Agent wakes up and chooses an action
+    ORDER_ENTRY = 2,     // Agent order reaches the book (after entry latency)
+    MARKET_DATA = 3,     // Book update reaches the agent (after market-data latency)
+    TIMER = 4            // Generic user timer
+};
+
+// Plain-old-data event payload; copying it is the only per-event work
+struct SimEvent {
+    SimEventType type;
+    Side side;
+    OrderType order_type;
+    uint8_t action;
+    Price price;       // Order price, or best bid for MARKET_DATA
+    Price price2;      // Best ask for MARKET_DATA
+    Quantity quantity;
+    uint64_t tag;      // Free for the owner (ids, sequence numbers)
+    
+    SimEvent() : type(SimEventType::TIMER), side(Side::BUY), order_type(OrderType::LIMIT),
+                 action(0), price(0), price2(0), quantity(0), tag(0) {}
+    
+    explicit SimEvent(SimEventType t) : SimEvent() { type = t; }
+};
+
+// Discrete-event scheduler
+// Orders events in simulated time on a hierarchical timer wheel, so
+// scheduling and dispatch are O(1) and no heap is involved.
+class EventScheduler {
+public:
+    using Handle = TimerWheel<SimEvent>::Handle;
+
+private:
+    TimerWheel<SimEvent> wheel_;
+    uint64_t processed_;
+
+public:
+    explicit EventScheduler(SimTime start = 0, size_t initial_blocks = 4)
+        : wheel_(start, initial_blocks), processed_(0) {}
+    
+    Handle schedule_at(SimTime time, const SimEvent& event) {
+        return wheel_.schedule(time, event);
+    }
+    
+    Handle schedule_after(SimTime delay, const SimEvent& event) {
+        return wheel_.schedule(wheel_.now() + delay, event);
+    }
+    
+    void cancel(Handle handle) { wheel_.cancel(handle); }
+    
+    // Dispatch every event up to and including end; handler(const SimEvent&, SimTime now)
+    // Handlers may schedule further events, which are dispatched in time order.
+    template<typename Handler>
+    uint64_t run_until(SimTime end, Handler&& handler) {
+        size_t n = wheel_.advance(end, [&](const SimEvent& ev, uint64_t t) { handler(ev, t); });
+        processed_ += n;
+        return n;
+    }
+    
+    // Dispatch all events of the next pending timestamp; false when idle
+    template<typename Handler>
+    bool step(Handler&& handler) {
+        size_t n = wheel_.run_next([&](const SimEvent& ev, uint64_t t) { handler(ev, t); });
+        processed_ += n;
+        return n > 0;
+    }
+    
+    SimTime now() const { return wheel_.now(); }
+    size_t pending() const { return wheel_.size(); }
+    uint64_t processed() const { return processed_; }
+};
+
+} // namespace orderbook
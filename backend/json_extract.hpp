@@ -0,0 +1,365 @@
+#pragma once
+
+#include <string_view>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace OrderBookNS {
+
+// On-demand JSON extraction
+// A JsonView is two pointers into the response buffer: the first byte of a
+// value and the end of the document. Nothing is parsed until asked for, and
+// nothing is allocated. Looking up a member or element scans forward from the
+// value, skipping siblings with a SIMD search for structural characters
+// (SSE2 or NEON, scalar elsewhere). Strings come back raw (escapes are not
+// decoded), which is all provider field names and symbols need.
+//
+// Invalid or missing paths give an invalid view, and every accessor on an
+// invalid view returns its fallback, so extraction chains need no checks in
+// between. Malformed input never reads past the end of the buffer.
+class JsonView {
+public:
+    JsonView() : p_(nullptr), end_(nullptr) {}
+    
+    static JsonView parse(std::string_view document) {
+        const char* end = document.data() + document.size();
+        const char* p = skip_ws(document.data(), end);
+        return p < end ? JsonView(p, end) : JsonView();
+    }
+    
+    bool valid() const { return p_ != nullptr; }
+    bool is_object() const { return p_ && *p_ == '{'; }
+    bool is_array() const { return p_ && *p_ == '['; }
+    bool is_string() const { return p_ && *p_ == '"'; }
+    bool is_null() const { return p_ && *p_ == 'n'; }
+    bool is_number() const { return p_ && (*p_ == '-' || (*p_ >= '0' && *p_ <= '9')); }
+    
+    // Sequential access to array elements or object members
+    class Iterator {
+    public:
+        Iterator() : p_(nullptr), end_(nullptr) {}
+        
+        // Next element (arrays); false at the end
+        bool next(JsonView& value) {
+            std::string_view key;
+            return next(key, value);
+        }
+        
+        // Next member (objects); key is the raw name without quotes
+        bool next(std::string_view& key, JsonView& value) {
+            if (!p_) return false;
+            const char* p = skip_ws(p_, end_);
+            if (p >= end_ || *p == ']' || *p == '}') {
+                p_ = nullptr;
+                return false;
+            }
+            if (object_) {
+                if (*p != '"') return fail();
+                const char* close = closing_quote(p, end_);
+                if (!close) return fail();
+                key = std::string_view(p + 1, static_cast<size_t>(close - p - 1));
+                p = skip_ws(close + 1, end_);
+                if (p >= end_ || *p != ':') return fail();
+                p = skip_ws(p + 1, end_);
+            }
+            if (p >= end_) return fail();
+            value = JsonView(p, end_);
+            
+            p = skip_ws(skip_value(p, end_), end_);
+            if (p < end_ && *p == ',') ++p;
+            p_ = p;
+            return true;
+        }
+        
+        // Skip n entries; false if the container ran out first
+        bool skip(size_t n) {
+            JsonView ignored;
+            while (n-- > 0) {
+                if (!next(ignored)) return false;
+            }
+            return true;
+        }
+    
+    private:
+        friend class JsonView;
+        const char* p_;
+        const char* end_;
+        bool object_ = false;
+        
+        Iterator(const char* p, const char* end, bool object) : p_(p), end_(end), object_(object) {}
+        
+        bool fail() {
+            p_ = nullptr;
+            return false;
+        }
+    };
+    
+    Iterator elements() const {
+        return is_array() ? Iterator(p_ + 1, end_, false) : Iterator();
+    }
+    
+    Iterator members() const {
+        return is_object() ? Iterator(p_ + 1, end_, true) : Iterator();
+    }
+    
+    // Object member by (raw) name
+    JsonView operator[](std::string_view key) const {
+        Iterator it = members();
+        std::string_view name;
+        JsonView value;
+        while (it.next(name, value)) {
+            if (name == key) return value;
+        }
+        return JsonView();
+    }
+    
+    JsonView operator[](const char* key) const {
+        return (*this)[std::string_view(key)];
+    }
+    
+    // Array element by index
+    JsonView operator[](size_t index) const {
+        Iterator it = elements();
+        JsonView value;
+        return it.skip(index) && it.next(value) ? value : JsonView();
+    }
+    
+    JsonView operator[](int index) const {
+        return index < 0 ? JsonView() : (*this)[static_cast<size_t>(index)];
+    }
+    
+    // Element count (arrays) or member count (objects)
+    size_t size() const {
+        Iterator it = is_array() ? elements() : members();
+        size_t count = 0;
+        std::string_view key;
+        JsonView value;
+        while (it.next(key, value)) ++count;
+        return count;
+    }
+    
+    // Raw string contents (no unescaping)
+    std::string_view as_string_view() const {
+        if (!is_string()) return std::string_view();
+        const char* close = closing_quote(p_, end_);
+        return close ? std::string_view(p_ + 1, static_cast<size_t>(close - p_ - 1)) : std::string_view();
+    }
+    
+    // Numbers, and strings holding a number (some APIs quote every price)
+    double as_double(double fallback = 0.0) const {
+        double value;
+        return read_number(value) ? value : fallback;
+    }
+    
+    int64_t as_int64(int64_t fallback = 0) const {
+        double value;
+        return read_number(value) ? static_cast<int64_t>(value) : fallback;
+    }
+    
+    uint64_t as_uint64(uint64_t fallback = 0) const {
+        const char* p = p_;
+        const char* end = end_;
+        if (is_string()) {
+            ++p;
+        }
+        // Integers (timestamps, volumes) are read exactly; anything else via double
+        uint64_t value = 0;
+        const char* q = p;
+        while (q < end && *q >= '0' && *q <= '9' && q - p < 19) {
+            value = value * 10 + static_cast<uint64_t>(*q - '0');
+            ++q;
+        }
+        if (q > p && (q >= end || !is_number_char(*q))) return value;
+        
+        double d;
+        return read_number(d) && d >= 0.0 ? static_cast<uint64_t>(d) : fallback;
+    }
+
+private:
+    const char* p_;    // First byte of the value
+    const char* end_;  // End of the document
+    
+    JsonView(const char* p, const char* end) : p_(p), end_(end) {}
+    
+    static bool is_number_char(char c) {
+        return (c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '-' || c == '+';
+    }
+    
+    static const char* skip_ws(const char* p, const char* end) {
+        while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) ++p;
+        return p;
+    }
+    
+    // First byte in [p, end) equal to any of the given characters, or end
+    template<char... Cs>
+    static const char* find_any(const char* p, const char* end) {
+#if defined(__SSE2__)
+        while (end - p >= 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            __m128i hits = _mm_setzero_si128();
+            ((hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(Cs)))), ...);
+            int mask = _mm_movemask_epi8(hits);
+            if (mask) return p + __builtin_ctz(static_cast<unsigned>(mask));
+            p += 16;
+        }
+#elif defined(__ARM_NEON)
+        while (end - p >= 16) {
+            uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+            uint8x16_t hits = vdupq_n_u8(0);
+            ((hits = vorrq_u8(hits, vceqq_u8(chunk, vdupq_n_u8(static_cast<uint8_t>(Cs))))), ...);
+            // Narrow each byte to a nibble: 64-bit mask, 4 bits per input byte
+            uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(
+                vshrn_n_u16(vreinterpretq_u16_u8(hits), 4)), 0);
+            if (mask) return p + (__builtin_ctzll(mask) >> 2);
+            p += 16;
+        }
+#endif
+        while (p < end) {
+            char c = *p;
+            if (((c == Cs) || ...)) return p;
+            ++p;
+        }
+        return end;
+    }
+    
+    // p at an opening quote; returns the closing quote, or nullptr when the
+    // string is not closed before end
+    static const char* closing_quote(const char* p, const char* end) {
+        ++p;
+        while (true) {
+            p = find_any<'"', '\\'>(p, end);
+            if (p >= end) return nullptr;
+            if (*p == '"') return p;
+            p += 2;  // Escaped character
+            if (p >= end) return nullptr;
+        }
+    }
+    
+    // p at '"'; returns one past the closing quote (end if unterminated)
+    static const char* skip_string(const char* p, const char* end) {
+        const char* close = closing_quote(p, end);
+        return close ? close + 1 : end;
+    }
+    
+    // p at '{' or '['; returns one past the matching close
+    static const char* skip_container(const char* p, const char* end) {
+        int depth = 0;
+        while (true) {
+            p = find_any<'"', '{', '}', '[', ']'>(p, end);
+            if (p >= end) return end;
+            switch (*p) {
+                case '"':
+                    p = skip_string(p, end);
+                    continue;
+                case '{':
+                case '[':
+                    ++depth;
+                    break;
+                default:
+                    if (--depth == 0) return p + 1;
+                    break;
+            }
+            ++p;
+        }
+    }
+    
+    static const char* skip_value(const char* p, const char* end) {
+        if (p >= end) return end;
+        switch (*p) {
+            case '"':
+                return skip_string(p, end);
+            case '{':
+            case '[':
+                return skip_container(p, end);
+            default:
+                // Number or literal
+                while (p < end && *p != ',' && *p != '}' && *p != ']' &&
+                       *p != ' ' && *p != '\n' && *p != '\r' && *p != '\t') {
+                    ++p;
+                }
+                return p;
+        }
+    }
+    
+    // Decimal number, optionally quoted. Up to 19 significant digits with a
+    // small exponent are converted exactly (one multiply or divide by an exact
+    // power of ten); anything else goes through strtod on a stack copy.
+    bool read_number(double& out) const {
+        if (!p_) return false;
+        const char* p = p_;
+        const char* end = end_;
+        if (*p == '"') {
+            ++p;
+        }
+        
+        const char* start = p;
+        bool negative = p < end && *p == '-';
+        if (negative) ++p;
+        
+        uint64_t mantissa = 0;
+        int digits = 0;
+        int exponent = 0;
+        bool truncated = false;
+        const char* q = p;
+        while (q < end && *q >= '0' && *q <= '9') {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*q - '0');
+                if (mantissa) ++digits;
+            } else {
+                ++exponent;
+                truncated = true;
+            }
+            ++q;
+        }
+        bool any_digit = q > p;
+        if (q < end && *q == '.') {
+            ++q;
+            const char* frac = q;
+            while (q < end && *q >= '0' && *q <= '9') {
+                if (digits < 19) {
+                    mantissa = mantissa * 10 + static_cast<uint64_t>(*q - '0');
+                    if (mantissa) ++digits;
+                    --exponent;
+                } else {
+                    truncated = true;
+                }
+                ++q;
+            }
+            any_digit = any_digit || q > frac;
+        }
+        if (!any_digit) return false;
+        
+        bool has_exponent = q < end && (*q == 'e' || *q == 'E');
+        if (!has_exponent && !truncated && mantissa < (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+            static constexpr double POW10[] = {
+                1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+            };
+            double value = static_cast<double>(mantissa);
+            value = exponent < 0 ? value / POW10[-exponent] : value * POW10[exponent];
+            out = negative ? -value : value;
+            return true;
+        }
+        
+        // Rare path: exponent notation or very long mantissas
+        char buffer[64];
+        const char* stop = start;
+        while (stop < end && is_number_char(*stop) && stop - start < 63) ++stop;
+        size_t length = static_cast<size_t>(stop - start);
+        std::memcpy(buffer, start, length);
+        buffer[length] = '\0';
+        char* parsed_end = nullptr;
+        out = std::strtod(buffer, &parsed_end);
+        return parsed_end != buffer;
+    }
+};
+
+} // namespace OrderBookNS
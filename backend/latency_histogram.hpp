@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace orderbook {
+
+struct LatencySnapshot {
+    uint64_t count = 0;
+    double avg_ns = 0.0;
+    uint64_t p50_ns = 0;      // Bucket upper bounds
+    uint64_t p99_ns = 0;
+    uint64_t p999_ns = 0;
+    uint64_t max_ns = 0;
+};
+
+// Lock-free log2 latency histogram
+// Bucket b counts samples in [2^(b-1), 2^b) ns, so percentiles are upper
+// bounds within a factor of two. record() is a few relaxed atomic adds and is
+// safe from any thread; snapshot() can be taken from any thread at any time.
+class LatencyHistogram {
+public:
+    static constexpr size_t BUCKETS = 40;
+    
+    static uint64_t now_ns() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+    
+    static size_t bucket_of(uint64_t ns) {
+        size_t bucket = ns == 0 ? 0 : static_cast<size_t>(64 - __builtin_clzll(ns));
+        return bucket < BUCKETS ? bucket : BUCKETS - 1;
+    }
+    
+    // Largest value that lands in a bucket
+    static uint64_t bucket_bound(size_t bucket) {
+        return bucket == 0 ? 0 : (1ULL << bucket) - 1;
+    }
+    
+    void record(uint64_t ns) noexcept {
+        buckets_[bucket_of(ns)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        total_ns_.fetch_add(ns, std::memory_order_relaxed);
+        uint64_t max = max_ns_.load(std::memory_order_relaxed);
+        while (ns > max && !max_ns_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+        }
+    }
+    
+    uint64_t bucket(size_t index) const { return buckets_[index].load(std::memory_order_relaxed); }
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t total_ns() const { return total_ns_.load(std::memory_order_relaxed); }
+    
+    LatencySnapshot snapshot() const {
+        LatencySnapshot snap;
+        uint64_t counts[BUCKETS];
+        for (size_t b = 0; b < BUCKETS; ++b) {
+            counts[b] = bucket(b);
+            snap.count += counts[b];
+        }
+        snap.max_ns = max_ns_.load(std::memory_order_relaxed);
+        if (snap.count == 0) return snap;
+        snap.avg_ns = static_cast<double>(total_ns()) / static_cast<double>(snap.count);
+        
+        uint64_t seen = 0;
+        for (size_t b = 0; b < BUCKETS; ++b) {
+            seen += counts[b];
+            if (snap.p50_ns == 0 && seen * 2 >= snap.count) snap.p50_ns = bucket_bound(b);
+            if (snap.p99_ns == 0 && seen * 100 >= snap.count * 99) snap.p99_ns = bucket_bound(b);
+            if (seen * 1000 >= snap.count * 999) {
+                snap.p999_ns = bucket_bound(b);
+                break;
+            }
+        }
+        return snap;
+    }
+    
+private:
+    std::atomic<uint64_t> buckets_[BUCKETS] = {};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> total_ns_{0};
+    std::atomic<uint64_t> max_ns_{0};
+};
+
+// Records the time from construction to destruction; when constructed
+// disabled it reads no clock and records nothing
+class ScopedLatency {
+public:
+    explicit ScopedLatency(LatencyHistogram& histogram, bool enabled = true)
+        : histogram_(enabled ? &histogram : nullptr), start_ns_(enabled ? LatencyHistogram::now_ns() : 0) {}
+    ~ScopedLatency() {
+        if (histogram_) histogram_->record(LatencyHistogram::now_ns() - start_ns_);
+    }
+    
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+    
+private:
+    LatencyHistogram* histogram_;
+    uint64_t start_ns_;
+};
+
+} // namespace orderbook
@@ -1,13 +1,68 @@
 #include "market_data.hpp"
+#include "request_scheduler.hpp"
+#include "quote_stream.hpp"
+#include "json_extract.hpp"
+#include "bar_cache.hpp"
+#include "tick_recorder.hpp"
+#include "thread_topology.hpp"
+#include "async_logger.hpp"
+#include "trace.hpp"
 #include <curl/curl.h>
-#include <iostream>
 #include <sstream>
 #include <thread>
 #include <cstring>
-#include <json/json.h>
+#include <ctime>
+#include <condition_variable>
+#include <algorithm>
 
 namespace OrderBookNS {
 
+// Alpha Vantage and FMP stamp intraday bars "YYYY-MM-DD HH:MM:SS" in US
+// Eastern time; convert to Unix nanoseconds like Yahoo's (0 if malformed).
+// DST follows the US rule: second Sunday of March to first Sunday of November.
+static uint64_t parse_eastern_time(std::string_view text) {
+    int fields[6] = {};
+    const int widths[6] = {4, 2, 2, 2, 2, 2};
+    size_t pos = 0;
+    for (int f = 0; f < 6; ++f) {
+        if (f > 0) {
+            if (pos >= text.size()) return 0;
+            ++pos;  // '-', ' ' or ':'
+        }
+        for (int d = 0; d < widths[f]; ++d, ++pos) {
+            if (pos >= text.size() || text[pos] < '0' || text[pos] > '9') return 0;
+            fields[f] = fields[f] * 10 + (text[pos] - '0');
+        }
+    }
+    
+    std::tm local{};
+    local.tm_year = fields[0] - 1900;
+    local.tm_mon = fields[1] - 1;
+    local.tm_mday = fields[2];
+    local.tm_hour = fields[3];
+    local.tm_min = fields[4];
+    local.tm_sec = fields[5];
+    time_t as_utc = timegm(&local);  // Wall time as if it were UTC; also fills tm_wday
+    if (as_utc < 0) return 0;
+    
+    // Sunday on or after the given day of the month
+    auto sunday_from = [&](int mday) { return mday + (7 - (local.tm_wday + mday - local.tm_mday + 35) % 7) % 7; };
+    bool dst;
+    if (local.tm_mon > 2 && local.tm_mon < 10) {
+        dst = true;
+    } else if (local.tm_mon == 2) {
+        int start = sunday_from(8);
+        dst = local.tm_mday > start || (local.tm_mday == start && local.tm_hour >= 2);
+    } else if (local.tm_mon == 10) {
+        int end = sunday_from(1);
+        dst = local.tm_mday < end || (local.tm_mday == end && local.tm_hour < 2);
+    } else {
+        dst = false;
+    }
+    
+    return static_cast<uint64_t>(as_utc + (dst ? 4 : 5) * 3600) * 1000000000ULL;
+}
+
 // ============================================================================
 // HTTPClient Implementation
 // ============================================================================
@@ -18,7 +73,11 @@ static size_t write_callback(void* contents, size_t size, size_t nmemb, void* us
 }
 
 HTTPClient::HTTPClient() : timeout_(10) {
+    ensure_curl_global_init();
     curl_handle_ = curl_easy_init();
+    if (curl_handle_) {
+        configure_easy_handle(curl_handle_);
+    }
 }
 
 HTTPClient::~HTTPClient() {
@@ -31,6 +90,7 @@ bool HTTPClient::get(const std::string& url, std::string& response,
                      const std::map<std::string, std::string>& headers) {
     if (!curl_handle_) return false;
     
+    std::lock_guard<std::mutex> lock(mutex_);
     CURL* curl = (CURL*)curl_handle_;
     response.clear();
     
@@ -53,11 +113,13 @@ bool HTTPClient::get(const std::string& url, std::string& response,
     CURLcode res = curl_easy_perform(curl);
     
     if (header_list) {
+        // The handle is reused; don't leave it pointing at the freed list
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, nullptr);
         curl_slist_free_all(header_list);
     }
     
     if (res != CURLE_OK) {
-        std::cerr << "curl_easy_perform() failed: " << curl_easy_strerror(res) << std::endl;
+        OB_LOG_WARN("curl_easy_perform() failed: %s", curl_easy_strerror(res));
         return false;
     }
     
@@ -83,40 +145,40 @@ bool YahooFinanceProvider::is_available() const {
 }
 
 bool YahooFinanceProvider::get_quote(const std::string& symbol, Quote& quote) {
-    std::string url = base_url_ + "/chart/" + symbol + "?interval=1m&range=1d";
+    HTTPRequest request;
     std::string response;
     
-    if (!http_client_.get(url, response)) {
+    if (!build_quote_request(symbol, request) || !http_client_.get(request.url, response)) {
         return false;
     }
     
-    try {
-        Json::Value root;
-        Json::Reader reader;
-        if (!reader.parse(response, root)) {
-            return false;
-        }
-        
-        auto chart = root["chart"]["result"][0];
-        auto meta = chart["meta"];
-        auto indicators = chart["indicators"]["quote"][0];
-        
-        // Get current price
-        Price current_price = static_cast<Price>(meta["regularMarketPrice"].asDouble() * 100);
-        
-        quote.symbol = symbol;
-        quote.bid_price = current_price - 1; // Approximate bid
-        quote.ask_price = current_price + 1; // Approximate ask
-        quote.bid_size = 100;
-        quote.ask_size = 100;
-        quote.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
-            std::chrono::system_clock::now().time_since_epoch()).count();
-        
-        return true;
-    } catch (const std::exception& e) {
-        std::cerr << "Yahoo Finance parse error: " << e.what() << std::endl;
+    return parse_quote(symbol, response, quote);
+}
+
+bool YahooFinanceProvider::build_quote_request(const std::string& symbol, HTTPRequest& request) {
+    request.url = base_url_ + "/chart/" + symbol + "?interval=1m&range=1d";
+    return true;
+}
+
+bool YahooFinanceProvider::parse_quote(const std::string& symbol, const std::string& body, Quote& quote) const {
+    JsonView meta = JsonView::parse(body)["chart"]["result"][0]["meta"];
+    JsonView market_price = meta["regularMarketPrice"];
+    if (!market_price.is_number()) {
         return false;
     }
+    
+    // Get current price
+    Price current_price = static_cast<Price>(market_price.as_double() * 100);
+    
+    quote.symbol = symbol;
+    quote.bid_price = current_price - 1; // Approximate bid
+    quote.ask_price = current_price + 1; // Approximate ask
+    quote.bid_size = 100;
+    quote.ask_size = 100;
+    quote.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    
+    return true;
 }
 
 bool YahooFinanceProvider::get_trades(const std::string& symbol, std::vector<Trade>& trades, int limit) {
@@ -129,78 +191,94 @@ bool YahooFinanceProvider::get_trades(const std::string& symbol, std::vector<Tra
         return false;
     }
     
-    try {
-        Json::Value root;
-        Json::Reader reader;
-        if (!reader.parse(response, root)) {
-            return false;
-        }
-        
-        auto chart = root["chart"]["result"][0];
-        auto timestamps = chart["timestamp"];
-        auto indicators = chart["indicators"]["quote"][0];
-        auto closes = indicators["close"];
-        auto volumes = indicators["volume"];
-        
-        trades.clear();
-        int count = std::min(limit, static_cast<int>(timestamps.size()));
-        
-        for (int i = timestamps.size() - count; i < static_cast<int>(timestamps.size()); ++i) {
-            Trade trade;
-            trade.symbol = symbol;
-            trade.price = static_cast<Price>(closes[i].asDouble() * 100);
-            trade.quantity = volumes[i].asUInt64() / 100; // Approximate
-            trade.timestamp = timestamps[i].asUInt64() * 1000000000ULL; // Convert to nanoseconds
-            trades.push_back(trade);
-        }
+    JsonView chart = JsonView::parse(response)["chart"]["result"][0];
+    JsonView timestamps = chart["timestamp"];
+    JsonView indicators = chart["indicators"]["quote"][0];
+    
+    trades.clear();
+    size_t total = timestamps.size();
+    size_t count = std::min(static_cast<size_t>(std::max(limit, 0)), total);
+    
+    // Walk the parallel arrays once, starting at the last `count` entries
+    auto times = timestamps.elements();
+    auto closes = indicators["close"].elements();
+    auto volumes = indicators["volume"].elements();
+    times.skip(total - count);
+    closes.skip(total - count);
+    volumes.skip(total - count);
+    
+    JsonView time, close, volume;
+    while (times.next(time)) {
+        if (!closes.next(close)) close = JsonView();
+        if (!volumes.next(volume)) volume = JsonView();
         
-        return !trades.empty();
-    } catch (const std::exception& e) {
-        std::cerr << "Yahoo Finance parse error: " << e.what() << std::endl;
-        return false;
+        Trade trade;
+        trade.symbol = symbol;
+        trade.price = static_cast<Price>(close.as_double() * 100);
+        trade.quantity = volume.as_uint64() / 100; // Approximate
+        trade.timestamp = time.as_uint64() * 1000000000ULL; // Convert to nanoseconds
+        trades.push_back(trade);
     }
+    
+    return !trades.empty();
 }
 
 bool YahooFinanceProvider::get_ohlcv(const std::string& symbol, std::vector<OHLCV>& data, 
                                      const std::string& interval, int limit) {
-    std::string url = base_url_ + "/chart/" + symbol + "?interval=" + interval + "&range=1d";
+    HTTPRequest request;
     std::string response;
     
-    if (!http_client_.get(url, response)) {
+    if (!build_ohlcv_request(symbol, interval, limit, request) || !http_client_.get(request.url, response)) {
         return false;
     }
     
-    try {
-        Json::Value root;
-        Json::Reader reader;
-        if (!reader.parse(response, root)) {
-            return false;
-        }
-        
-        auto chart = root["chart"]["result"][0];
-        auto timestamps = chart["timestamp"];
-        auto indicators = chart["indicators"]["quote"][0];
-        
-        data.clear();
-        int count = std::min(limit, static_cast<int>(timestamps.size()));
-        
-        for (int i = timestamps.size() - count; i < static_cast<int>(timestamps.size()); ++i) {
-            OHLCV bar;
-            bar.symbol = symbol;
-            bar.timestamp = timestamps[i].asUInt64() * 1000000000ULL;
-            bar.open = static_cast<Price>(indicators["open"][i].asDouble() * 100);
-            bar.high = static_cast<Price>(indicators["high"][i].asDouble() * 100);
-            bar.low = static_cast<Price>(indicators["low"][i].asDouble() * 100);
-            bar.close = static_cast<Price>(indicators["close"][i].asDouble() * 100);
-            bar.volume = indicators["volume"][i].asUInt64();
-            data.push_back(bar);
+    return parse_ohlcv(symbol, limit, response, data);
+}
+
+bool YahooFinanceProvider::build_ohlcv_request(const std::string& symbol, const std::string& interval, int,
+                                               HTTPRequest& request) {
+    request.url = base_url_ + "/chart/" + symbol + "?interval=" + interval + "&range=1d";
+    return true;
+}
+
+bool YahooFinanceProvider::parse_ohlcv(const std::string& symbol, int limit, const std::string& body,
+                                       std::vector<OHLCV>& data) const {
+    JsonView chart = JsonView::parse(body)["chart"]["result"][0];
+    JsonView timestamps = chart["timestamp"];
+    JsonView indicators = chart["indicators"]["quote"][0];
+    
+    data.clear();
+    size_t total = timestamps.size();
+    size_t count = std::min(static_cast<size_t>(std::max(limit, 0)), total);
+    data.reserve(count);
+    
+    // One forward pass over each column; missing or null candles read as 0
+    JsonView::Iterator columns[6] = {
+        timestamps.elements(), indicators["open"].elements(), indicators["high"].elements(),
+        indicators["low"].elements(), indicators["close"].elements(), indicators["volume"].elements()
+    };
+    for (auto& column : columns) {
+        column.skip(total - count);
+    }
+    
+    JsonView cells[6];
+    while (columns[0].next(cells[0])) {
+        for (int c = 1; c < 6; ++c) {
+            if (!columns[c].next(cells[c])) cells[c] = JsonView();
         }
         
-        return !data.empty();
-    } catch (const std::exception& e) {
-        std::cerr << "Yahoo Finance parse error: " << e.what() << std::endl;
-        return false;
+        OHLCV bar;
+        bar.symbol = symbol;
+        bar.timestamp = cells[0].as_uint64() * 1000000000ULL;
+        bar.open = static_cast<Price>(cells[1].as_double() * 100);
+        bar.high = static_cast<Price>(cells[2].as_double() * 100);
+        bar.low = static_cast<Price>(cells[3].as_double() * 100);
+        bar.close = static_cast<Price>(cells[4].as_double() * 100);
+        bar.volume = cells[5].as_uint64();
+        data.push_back(bar);
     }
+    
+    return !data.empty();
 }
 
 // ============================================================================
@@ -208,63 +286,54 @@ bool YahooFinanceProvider::get_ohlcv(const std::string& symbol, std::vector<OHLC
 // ============================================================================
 
 AlphaVantageProvider::AlphaVantageProvider(const std::string& api_key)
-    : api_key_(api_key), base_url_("https://www.alphavantage.co/query") {
-    last_request_time_ = std::chrono::steady_clock::now() - std::chrono::seconds(60);
+    : api_key_(api_key), base_url_("https://www.alphavantage.co/query"),
+      rate_limiter_(5.0 / 60.0, 1.0) {
 }
 
 bool AlphaVantageProvider::is_available() const {
     return !api_key_.empty();
 }
 
-void AlphaVantageProvider::rate_limit() {
-    // Alpha Vantage free tier: 5 requests per minute
-    auto now = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_request_time_);
-    
-    if (elapsed.count() < 12000) { // 12 seconds between requests
-        std::this_thread::sleep_for(std::chrono::milliseconds(12000 - elapsed.count()));
-    }
-    
-    last_request_time_ = std::chrono::steady_clock::now();
-}
-
 bool AlphaVantageProvider::get_quote(const std::string& symbol, Quote& quote) {
-    rate_limit();
+    // Out of budget: fail fast and let the caller move on instead of sleeping
+    if (!rate_limiter_.try_acquire()) {
+        return false;
+    }
     
-    std::string url = base_url_ + "?function=GLOBAL_QUOTE&symbol=" + symbol + "&apikey=" + api_key_;
+    HTTPRequest request;
     std::string response;
     
-    if (!http_client_.get(url, response)) {
+    if (!build_quote_request(symbol, request) || !http_client_.get(request.url, response)) {
         return false;
     }
     
-    try {
-        Json::Value root;
-        Json::Reader reader;
-        if (!reader.parse(response, root)) {
-            return false;
-        }
-        
-        auto global_quote = root["Global Quote"];
-        if (global_quote.isNull()) {
-            return false;
-        }
-        
-        Price price = static_cast<Price>(std::stod(global_quote["05. price"].asString()) * 100);
-        
-        quote.symbol = symbol;
-        quote.bid_price = price - 1;
-        quote.ask_price = price + 1;
-        quote.bid_size = 100;
-        quote.ask_size = 100;
-        quote.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
-            std::chrono::system_clock::now().time_since_epoch()).count();
-        
-        return true;
-    } catch (const std::exception& e) {
-        std::cerr << "Alpha Vantage parse error: " << e.what() << std::endl;
+    return parse_quote(symbol, response, quote);
+}
+
+bool AlphaVantageProvider::build_quote_request(const std::string& symbol, HTTPRequest& request) {
+    request.url = base_url_ + "?function=GLOBAL_QUOTE&symbol=" + symbol + "&apikey=" + api_key_;
+    return true;
+}
+
+bool AlphaVantageProvider::parse_quote(const std::string& symbol, const std::string& body, Quote& quote) const {
+    // Alpha Vantage quotes every number as a string
+    JsonView price_field = JsonView::parse(body)["Global Quote"]["05. price"];
+    double price_value = price_field.is_string() ? price_field.as_double(-1.0) : -1.0;
+    if (price_value < 0.0) {
         return false;
     }
+    
+    Price price = static_cast<Price>(price_value * 100);
+    
+    quote.symbol = symbol;
+    quote.bid_price = price - 1;
+    quote.ask_price = price + 1;
+    quote.bid_size = 100;
+    quote.ask_size = 100;
+    quote.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    
+    return true;
 }
 
 bool AlphaVantageProvider::get_trades(const std::string& symbol, std::vector<Trade>& trades, int limit) {
@@ -274,49 +343,64 @@ bool AlphaVantageProvider::get_trades(const std::string& symbol, std::vector<Tra
 
 bool AlphaVantageProvider::get_ohlcv(const std::string& symbol, std::vector<OHLCV>& data, 
                                      const std::string& interval, int limit) {
-    rate_limit();
+    if (!rate_limiter_.try_acquire()) {
+        return false;
+    }
     
-    std::string url = base_url_ + "?function=TIME_SERIES_INTRADAY&symbol=" + symbol + 
-                     "&interval=" + interval + "&apikey=" + api_key_;
+    HTTPRequest request;
     std::string response;
     
-    if (!http_client_.get(url, response)) {
+    if (!build_ohlcv_request(symbol, interval, limit, request) || !http_client_.get(request.url, response)) {
         return false;
     }
     
-    try {
-        Json::Value root;
-        Json::Reader reader;
-        if (!reader.parse(response, root)) {
-            return false;
-        }
-        
-        std::string time_series_key = "Time Series (" + interval + ")";
-        auto time_series = root[time_series_key];
-        
-        if (time_series.isNull()) {
-            return false;
-        }
-        
-        data.clear();
-        int count = 0;
-        
-        for (auto it = time_series.begin(); it != time_series.end() && count < limit; ++it, ++count) {
-            OHLCV bar;
-            bar.symbol = symbol;
-            bar.open = static_cast<Price>(std::stod((*it)["1. open"].asString()) * 100);
-            bar.high = static_cast<Price>(std::stod((*it)["2. high"].asString()) * 100);
-            bar.low = static_cast<Price>(std::stod((*it)["3. low"].asString()) * 100);
-            bar.close = static_cast<Price>(std::stod((*it)["4. close"].asString()) * 100);
-            bar.volume = std::stoull((*it)["5. volume"].asString());
-            data.push_back(bar);
+    return parse_ohlcv(symbol, limit, response, data);
+}
+
+bool AlphaVantageProvider::build_ohlcv_request(const std::string& symbol, const std::string& interval, int,
+                                               HTTPRequest& request) {
+    request.url = base_url_ + "?function=TIME_SERIES_INTRADAY&symbol=" + symbol +
+                  "&interval=" + interval + "&apikey=" + api_key_;
+    return true;
+}
+
+bool AlphaVantageProvider::parse_ohlcv(const std::string& symbol, int limit, const std::string& body,
+                                       std::vector<OHLCV>& data) const {
+    // The series is keyed by interval, e.g. "Time Series (1min)"
+    JsonView time_series;
+    auto sections = JsonView::parse(body).members();
+    std::string_view key;
+    JsonView section;
+    while (sections.next(key, section)) {
+        if (key.substr(0, 13) == "Time Series (") {
+            time_series = section;
+            break;
         }
-        
-        return !data.empty();
-    } catch (const std::exception& e) {
-        std::cerr << "Alpha Vantage parse error: " << e.what() << std::endl;
+    }
+    
+    if (!time_series.is_object()) {
         return false;
     }
+    
+    data.clear();
+    int count = 0;
+    
+    auto bars = time_series.members();
+    JsonView entry;
+    while (count < limit && bars.next(key, entry)) {
+        OHLCV bar;
+        bar.symbol = symbol;
+        bar.timestamp = parse_eastern_time(key);
+        bar.open = static_cast<Price>(entry["1. open"].as_double() * 100);
+        bar.high = static_cast<Price>(entry["2. high"].as_double() * 100);
+        bar.low = static_cast<Price>(entry["3. low"].as_double() * 100);
+        bar.close = static_cast<Price>(entry["4. close"].as_double() * 100);
+        bar.volume = entry["5. volume"].as_uint64();
+        data.push_back(bar);
+        ++count;
+    }
+    
+    return !data.empty();
 }
 
 // ============================================================================
@@ -332,41 +416,85 @@ bool FinancialModelingPrepProvider::is_available() const {
 }
 
 bool FinancialModelingPrepProvider::get_quote(const std::string& symbol, Quote& quote) {
-    std::string url = base_url_ + "/quote?symbol=" + symbol + "&apikey=" + api_key_;
+    HTTPRequest request;
     std::string response;
     
-    if (!http_client_.get(url, response)) {
+    if (!build_quote_request(symbol, request) || !http_client_.get(request.url, response)) {
         return false;
     }
     
-    try {
-        Json::Value root;
-        Json::Reader reader;
-        if (!reader.parse(response, root)) {
-            return false;
-        }
-        
-        if (root.isArray() && root.size() > 0) {
-            auto quote_data = root[0];
-            
-            Price price = static_cast<Price>(quote_data["price"].asDouble() * 100);
-            
-            quote.symbol = symbol;
-            quote.bid_price = price - 1;
-            quote.ask_price = price + 1;
-            quote.bid_size = 100;
-            quote.ask_size = 100;
-            quote.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
-                std::chrono::system_clock::now().time_since_epoch()).count();
-            
-            return true;
-        }
-        
+    return parse_quote(symbol, response, quote);
+}
+
+bool FinancialModelingPrepProvider::build_quote_request(const std::string& symbol, HTTPRequest& request) {
+    request.url = base_url_ + "/quote?symbol=" + symbol + "&apikey=" + api_key_;
+    return true;
+}
+
+bool FinancialModelingPrepProvider::parse_quote(const std::string& symbol, const std::string& body,
+                                                Quote& quote) const {
+    JsonView price_field = JsonView::parse(body)[0]["price"];
+    if (!price_field.is_number()) {
         return false;
-    } catch (const std::exception& e) {
-        std::cerr << "FMP parse error: " << e.what() << std::endl;
+    }
+    
+    Price price = static_cast<Price>(price_field.as_double() * 100);
+    
+    quote.symbol = symbol;
+    quote.bid_price = price - 1;
+    quote.ask_price = price + 1;
+    quote.bid_size = 100;
+    quote.ask_size = 100;
+    quote.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    
+    return true;
+}
+
+bool FinancialModelingPrepProvider::build_batch_quote_request(const std::vector<SymbolId>& symbols,
+                                                              HTTPRequest& request) {
+    if (symbols.empty() || symbols.size() > max_batch_quotes()) {
         return false;
     }
+    request.url = base_url_ + "/batch-quote?symbols=" + SymbolTable::global().join(symbols) +
+                  "&apikey=" + api_key_;
+    return true;
+}
+
+size_t FinancialModelingPrepProvider::parse_batch_quotes(const std::string& body,
+                                                         std::vector<SymbolQuote>& quotes) const {
+    const SymbolTable& table = SymbolTable::global();
+    uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    
+    auto elements = JsonView::parse(body).elements();
+    JsonView entry;
+    size_t added = 0;
+    while (elements.next(entry)) {
+        std::string_view name = entry["symbol"].as_string_view();
+        JsonView price_field = entry["price"];
+        SymbolId id = table.find(name);
+        if (id == INVALID_SYMBOL || !price_field.is_number()) continue;
+        
+        Price price = static_cast<Price>(price_field.as_double() * 100);
+        SymbolQuote result{id, Quote()};
+        result.quote.symbol = std::string(name);
+        result.quote.bid_price = price - 1;
+        result.quote.ask_price = price + 1;
+        result.quote.bid_size = 100;
+        result.quote.ask_size = 100;
+        result.quote.timestamp = now;
+        quotes.push_back(std::move(result));
+        ++added;
+    }
+    return added;
+}
+
+size_t FinancialModelingPrepProvider::get_quotes(const std::vector<SymbolId>& symbols,
+                                                 std::vector<SymbolQuote>& quotes) {
+    return get_quotes_batched(symbols, quotes, [this](const HTTPRequest& request, std::string& body) {
+        return http_client_.get(request.url, body, request.headers);
+    });
 }
 
 bool FinancialModelingPrepProvider::get_trades(const std::string& symbol, std::vector<Trade>& trades, int limit) {
@@ -376,69 +504,524 @@ bool FinancialModelingPrepProvider::get_trades(const std::string& symbol, std::v
 
 bool FinancialModelingPrepProvider::get_ohlcv(const std::string& symbol, std::vector<OHLCV>& data, 
                                               const std::string& interval, int limit) {
-    // FMP uses different interval format: 1min, 5min, 15min, 30min, 1hour, 4hour
-    std::string url = base_url_ + "/historical-chart/" + interval + "/" + symbol + "?apikey=" + api_key_;
+    HTTPRequest request;
     std::string response;
     
-    if (!http_client_.get(url, response)) {
+    if (!build_ohlcv_request(symbol, interval, limit, request) || !http_client_.get(request.url, response)) {
         return false;
     }
     
-    try {
-        Json::Value root;
-        Json::Reader reader;
-        if (!reader.parse(response, root)) {
-            return false;
-        }
-        
-        data.clear();
-        int count = std::min(limit, static_cast<int>(root.size()));
-        
-        for (int i = 0; i < count; ++i) {
-            auto bar_data = root[i];
-            OHLCV bar;
-            bar.symbol = symbol;
-            bar.open = static_cast<Price>(bar_data["open"].asDouble() * 100);
-            bar.high = static_cast<Price>(bar_data["high"].asDouble() * 100);
-            bar.low = static_cast<Price>(bar_data["low"].asDouble() * 100);
-            bar.close = static_cast<Price>(bar_data["close"].asDouble() * 100);
-            bar.volume = bar_data["volume"].asUInt64();
-            data.push_back(bar);
-        }
-        
-        return !data.empty();
-    } catch (const std::exception& e) {
-        std::cerr << "FMP parse error: " << e.what() << std::endl;
-        return false;
+    return parse_ohlcv(symbol, limit, response, data);
+}
+
+bool FinancialModelingPrepProvider::build_ohlcv_request(const std::string& symbol, const std::string& interval, int,
+                                                        HTTPRequest& request) {
+    request.url = base_url_ + "/historical-chart/" + interval + "/" + symbol + "?apikey=" + api_key_;
+    return true;
+}
+
+bool FinancialModelingPrepProvider::parse_ohlcv(const std::string& symbol, int limit, const std::string& body,
+                                                std::vector<OHLCV>& data) const {
+    data.clear();
+    int count = 0;
+    
+    auto bars = JsonView::parse(body).elements();
+    JsonView bar_data;
+    while (count < limit && bars.next(bar_data)) {
+        OHLCV bar;
+        bar.symbol = symbol;
+        bar.timestamp = parse_eastern_time(bar_data["date"].as_string_view());
+        bar.open = static_cast<Price>(bar_data["open"].as_double() * 100);
+        bar.high = static_cast<Price>(bar_data["high"].as_double() * 100);
+        bar.low = static_cast<Price>(bar_data["low"].as_double() * 100);
+        bar.close = static_cast<Price>(bar_data["close"].as_double() * 100);
+        bar.volume = bar_data["volume"].as_uint64();
+        data.push_back(bar);
+        ++count;
     }
+    
+    return !data.empty();
 }
 
 // ============================================================================
 // Market Data Aggregator Implementation
 // ============================================================================
 
-MarketDataAggregator::MarketDataAggregator() {
+MarketDataAggregator::MarketDataAggregator()
+    : hedge_delay_(150), quote_timeout_(3000), probe_running_(false), probe_symbol_("AAPL") {
+}
+
+MarketDataAggregator::~MarketDataAggregator() {
+    {
+        std::lock_guard<std::mutex> lock(probe_mutex_);
+        probe_running_ = false;
+    }
+    probe_cv_.notify_all();
+    if (probe_thread_.joinable()) {
+        probe_thread_.join();
+    }
 }
 
 void MarketDataAggregator::add_provider(std::shared_ptr<IMarketDataProvider> provider) {
     if (provider && provider->is_available()) {
+        std::lock_guard<std::mutex> lock(probe_mutex_);
         providers_.push_back(provider);
-        std::cout << "Added market data provider: " << provider->get_name() << std::endl;
+        health_.push_back(std::make_shared<ProviderHealth>(breaker_config_));
+        if (!probe_running_) {
+            probe_running_ = true;
+            probe_thread_ = std::thread(&MarketDataAggregator::probe_loop, this);
+        }
+        OB_LOG_INFO("Added market data provider: %s", provider->get_name().c_str());
     }
 }
 
+void MarketDataAggregator::set_probe_symbol(const std::string& symbol) {
+    std::lock_guard<std::mutex> lock(probe_mutex_);
+    probe_symbol_ = symbol;
+}
+
+std::vector<size_t> MarketDataAggregator::ranked_providers() const {
+    std::vector<std::pair<double, size_t>> ranked;
+    for (size_t i = 0; i < health_.size(); ++i) {
+        if (health_[i]->available()) {
+            ranked.emplace_back(health_[i]->score(), i);
+        }
+    }
+    // Ties (e.g. providers not measured yet) keep registration order
+    std::stable_sort(ranked.begin(), ranked.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+    
+    std::vector<size_t> order;
+    order.reserve(ranked.size());
+    for (const auto& entry : ranked) {
+        order.push_back(entry.second);
+    }
+    return order;
+}
+
+std::vector<std::pair<std::string, ProviderHealth::Snapshot>> MarketDataAggregator::get_provider_health() const {
+    std::vector<std::pair<std::string, ProviderHealth::Snapshot>> result;
+    for (size_t i = 0; i < providers_.size(); ++i) {
+        result.emplace_back(providers_[i]->get_name(), health_[i]->snapshot());
+    }
+    return result;
+}
+
+std::vector<std::pair<std::string, std::shared_ptr<const ProviderHealth>>> MarketDataAggregator::get_provider_trackers() const {
+    std::vector<std::pair<std::string, std::shared_ptr<const ProviderHealth>>> result;
+    for (size_t i = 0; i < providers_.size(); ++i) {
+        result.emplace_back(providers_[i]->get_name(), health_[i]);
+    }
+    return result;
+}
+
+void MarketDataAggregator::probe_loop() {
+    std::unique_lock<std::mutex> lock(probe_mutex_);
+    while (probe_running_) {
+        probe_cv_.wait_for(lock, std::chrono::milliseconds(250));
+        if (!probe_running_) break;
+        
+        // add_provider may grow the vectors while probes run, so probe a copy
+        std::string symbol = probe_symbol_;
+        std::vector<std::shared_ptr<IMarketDataProvider>> providers = providers_;
+        std::vector<std::shared_ptr<ProviderHealth>> health = health_;
+        lock.unlock();
+        for (size_t i = 0; i < providers.size(); ++i) {
+            if (health[i]->begin_probe()) {
+                probe(providers[i], health[i], symbol);
+            }
+        }
+        lock.lock();
+    }
+}
+
+void MarketDataAggregator::probe(const std::shared_ptr<IMarketDataProvider>& provider,
+                                 const std::shared_ptr<ProviderHealth>& health, const std::string& symbol) {
+    // A probe spends real quota; without a token, give the slot back and
+    // retry on a later pass rather than count a failure
+    TokenBucket* limiter = provider->rate_limiter();
+    if (limiter && !limiter->try_acquire()) {
+        health->abandon_probe();
+        return;
+    }
+    
+    if (provider->supports_async_quotes()) {
+        HTTPRequest request;
+        request.timeout_ms = quote_timeout_.count();
+        if (!provider->build_quote_request(symbol, request)) {
+            health->abandon_probe();
+            return;
+        }
+        http().submit(std::move(request), [provider, health, symbol](HTTPResponse&& response) {
+            Quote quote;
+            bool ok = response.ok() && provider->parse_quote(symbol, response.body, quote);
+            health->end_probe(ok, response.elapsed_ms);
+        });
+        return;
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    Quote quote;
+    bool ok = provider->get_quote(symbol, quote);
+    health->end_probe(ok, std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+void MarketDataAggregator::warm_up(std::chrono::seconds keepalive_idle) {
+    std::vector<std::string> endpoints;
+    for (const auto& provider : providers_) {
+        std::string endpoint = provider->endpoint();
+        if (!endpoint.empty()) {
+            endpoints.push_back(std::move(endpoint));
+        }
+    }
+    http().keep_warm(endpoints, keepalive_idle);
+}
+
+AsyncHTTPClient& MarketDataAggregator::http() {
+    std::lock_guard<std::mutex> lock(http_mutex_);
+    if (!http_) {
+        http_ = std::make_unique<AsyncHTTPClient>();
+    }
+    return *http_;
+}
+
+RequestScheduler& MarketDataAggregator::scheduler() {
+    AsyncHTTPClient& client = http();
+    std::lock_guard<std::mutex> lock(http_mutex_);
+    if (!scheduler_) {
+        scheduler_ = std::make_unique<RequestScheduler>(client, providers_, health_);
+        scheduler_->set_bar_cache(bar_cache_);
+    }
+    return *scheduler_;
+}
+
+namespace {
+
+// Why a completed request gave no quote, for the log
+const char* failure_reason(const HTTPResponse& response) {
+    if (!response.error.empty()) return response.error.c_str();
+    return response.status == 200 ? "unparseable body" : "bad status";
+}
+
+// One request to one provider on behalf of a hedged symbol
+struct HedgeAttempt {
+    AsyncHTTPClient::RequestId id;
+    size_t provider;
+    std::chrono::steady_clock::time_point start;
+    bool finished = false;
+};
+
+// One symbol being hedged across providers
+struct HedgedQuote {
+    std::string symbol;
+    size_t next_provider = 0;
+    int outstanding = 0;
+    bool done = false;
+    Quote quote;
+    std::chrono::steady_clock::time_point next_hedge;
+    std::vector<HedgeAttempt> attempts;
+};
+
+// Shared with the completion callbacks, which may outlive the caller's wait
+struct HedgedBatch {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<HedgedQuote> fetches;
+};
+
+// Batch-endpoint requests to one provider, shared with their callbacks
+struct BatchRound {
+    std::mutex mutex;
+    std::condition_variable cv;
+    int outstanding = 0;
+    bool closed = false;          // Caller stopped waiting; late callbacks are ignored
+    std::vector<bool> finished;   // Per request
+    std::vector<SymbolQuote> quotes;
+};
+
+} // namespace
+
 bool MarketDataAggregator::get_quote(const std::string& symbol, Quote& quote) {
-    for (auto& provider : providers_) {
+    auto result = get_quotes({symbol});
+    if (!result[0]) {
+        return false;
+    }
+    quote = *result[0];
+    return true;
+}
+
+std::vector<std::optional<Quote>> MarketDataAggregator::get_quotes(const std::vector<std::string>& symbols) {
+    using Clock = std::chrono::steady_clock;
+    std::vector<std::optional<Quote>> results(symbols.size());
+    
+    // Fastest healthy provider first; open circuits are skipped entirely
+    std::vector<size_t> async_providers;
+    for (size_t index : ranked_providers()) {
+        if (providers_[index]->supports_async_quotes()) {
+            async_providers.push_back(index);
+        }
+    }
+    
+    if (!async_providers.empty() && !symbols.empty()) {
+        AsyncHTTPClient& client = http();
+        auto batch = std::make_shared<HedgedBatch>();
+        batch->fetches.resize(symbols.size());
+        for (size_t i = 0; i < symbols.size(); ++i) {
+            batch->fetches[i].symbol = symbols[i];
+        }
+        
+        // Fire the next provider willing to take the request (caller holds the lock)
+        auto launch = [&](size_t index) {
+            HedgedQuote& fetch = batch->fetches[index];
+            while (fetch.next_provider < async_providers.size()) {
+                size_t provider_index = async_providers[fetch.next_provider++];
+                auto provider = providers_[provider_index];
+                auto health = health_[provider_index];
+                TokenBucket* limiter = provider->rate_limiter();
+                if (limiter && !limiter->try_acquire()) {
+                    continue;  // Out of budget: hedge to the next provider now
+                }
+                HTTPRequest request;
+                request.timeout_ms = quote_timeout_.count();
+                if (!provider->build_quote_request(fetch.symbol, request)) {
+                    continue;
+                }
+                
+                ++fetch.outstanding;
+                auto now = Clock::now();
+                fetch.next_hedge = now + hedge_delay_;
+                size_t attempt = fetch.attempts.size();
+                fetch.attempts.push_back({0, provider_index, now});
+                fetch.attempts[attempt].id = client.submit(std::move(request),
+                    [batch, provider, health, index, attempt](HTTPResponse&& response) {
+                        // Losers are cancelled after the batch has already scored them
+                        if (response.cancelled) return;
+                        std::lock_guard<std::mutex> lock(batch->mutex);
+                        HedgedQuote& f = batch->fetches[index];
+                        --f.outstanding;
+                        f.attempts[attempt].finished = true;
+                        Quote parsed;
+                        if (response.ok() && provider->parse_quote(f.symbol, response.body, parsed)) {
+                            health->record_success(response.elapsed_ms);
+                            if (!f.done) {
+                                f.quote = parsed;
+                                f.done = true;
+                            }
+                        } else {
+                            health->record_failure();
+                            OB_LOG_WARN("%s: quote %s failed: HTTP %ld, %s", provider->get_name().c_str(),
+                                        f.symbol.c_str(), response.status, failure_reason(response));
+                        }
+                        batch->cv.notify_all();
+                    });
+                return;
+            }
+        };
+        
+        std::unique_lock<std::mutex> lock(batch->mutex);
+        const auto deadline = Clock::now() + quote_timeout_;
+        for (size_t i = 0; i < symbols.size(); ++i) {
+            launch(i);
+        }
+        
+        while (true) {
+            auto now = Clock::now();
+            auto wake = deadline;
+            bool pending = false;
+            
+            for (size_t i = 0; i < batch->fetches.size(); ++i) {
+                HedgedQuote& fetch = batch->fetches[i];
+                if (fetch.done) continue;
+                
+                // Hedge when the delay has passed or everything in flight has failed
+                if (fetch.next_provider < async_providers.size() &&
+                    (fetch.outstanding == 0 || now >= fetch.next_hedge)) {
+                    launch(i);
+                }
+                bool more = fetch.next_provider < async_providers.size();
+                if (fetch.outstanding > 0 || more) pending = true;
+                if (more) wake = std::min(wake, fetch.next_hedge);
+            }
+            
+            if (!pending || now >= deadline) break;
+            batch->cv.wait_until(lock, wake);
+        }
+        
+        // Cancel the losers and anything still outstanding. A loser was at
+        // least this slow, so its latency estimate rises without counting as
+        // a success; a request that ran into the deadline with no answer at
+        // all counts as a failure.
+        const auto now = Clock::now();
+        for (size_t i = 0; i < batch->fetches.size(); ++i) {
+            HedgedQuote& fetch = batch->fetches[i];
+            for (auto& attempt : fetch.attempts) {
+                if (attempt.finished) continue;
+                client.cancel(attempt.id);
+                if (fetch.done) {
+                    health_[attempt.provider]->record_slow(
+                        std::chrono::duration<double, std::milli>(now - attempt.start).count());
+                } else {
+                    health_[attempt.provider]->record_failure();
+                    OB_LOG_WARN("%s: quote %s timed out", providers_[attempt.provider]->get_name().c_str(),
+                                fetch.symbol.c_str());
+                }
+            }
+            if (fetch.done) {
+                results[i] = fetch.quote;
+            }
+        }
+    }
+    
+    // Providers without async support, one at a time
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        if (results[i]) continue;
+        Quote quote;
+        if (get_quote_sync(symbols[i], quote)) {
+            results[i] = quote;
+        }
+    }
+    
+    return results;
+}
+
+size_t MarketDataAggregator::get_quotes(const std::vector<SymbolId>& symbols, std::vector<SymbolQuote>& quotes) {
+    // Requested ids, and which of them have a quote so far (indexed by SymbolId)
+    SymbolId max_id = 0;
+    for (SymbolId id : symbols) {
+        max_id = std::max(max_id, id);
+    }
+    std::vector<uint8_t> wanted(symbols.empty() ? 0 : max_id + 1, 0);
+    for (SymbolId id : symbols) {
+        wanted[id] = 1;
+    }
+    
+    size_t added = 0;
+    std::vector<SymbolId> missing = symbols;
+    std::vector<SymbolQuote> batch;
+    for (size_t index : ranked_providers()) {
+        if (missing.empty()) break;
+        const auto& provider = providers_[index];
+        if (provider->max_batch_quotes() == 0 || !provider->supports_async_quotes()) continue;
+        
+        batch.clear();
+        fetch_batch_quotes(index, missing, batch);
+        for (auto& result : batch) {
+            // Drop duplicates and symbols nobody asked for
+            if (result.symbol >= wanted.size() || wanted[result.symbol] != 1) continue;
+            wanted[result.symbol] = 2;
+            quotes.push_back(std::move(result));
+            ++added;
+        }
+        missing.erase(std::remove_if(missing.begin(), missing.end(),
+                                     [&](SymbolId id) { return wanted[id] == 2; }),
+                      missing.end());
+    }
+    
+    // Per-symbol hedging for the rest
+    if (!missing.empty()) {
+        const SymbolTable& table = SymbolTable::global();
+        std::vector<std::string> names;
+        names.reserve(missing.size());
+        for (SymbolId id : missing) {
+            names.push_back(table.name(id));
+        }
+        auto results = get_quotes(names);
+        for (size_t i = 0; i < missing.size(); ++i) {
+            if (results[i]) {
+                quotes.push_back({missing[i], std::move(*results[i])});
+                ++added;
+            }
+        }
+    }
+    return added;
+}
+
+void MarketDataAggregator::fetch_batch_quotes(size_t index, const std::vector<SymbolId>& symbols,
+                                              std::vector<SymbolQuote>& quotes) {
+    auto provider = providers_[index];
+    auto health = health_[index];
+    AsyncHTTPClient& client = http();
+    size_t chunk = provider->max_batch_quotes();
+    auto round = std::make_shared<BatchRound>();
+    std::vector<AsyncHTTPClient::RequestId> ids;
+    
+    std::unique_lock<std::mutex> lock(round->mutex);
+    for (size_t first = 0; first < symbols.size(); first += chunk) {
+        TokenBucket* limiter = provider->rate_limiter();
+        if (limiter && !limiter->try_acquire()) {
+            break;  // Out of budget: leave the rest to the next provider
+        }
+        std::vector<SymbolId> batch(symbols.begin() + first,
+                                    symbols.begin() + std::min(first + chunk, symbols.size()));
+        HTTPRequest request;
+        request.timeout_ms = quote_timeout_.count();
+        if (!provider->build_batch_quote_request(batch, request)) {
+            continue;
+        }
+        
+        size_t slot = ids.size();
+        round->finished.push_back(false);
+        ++round->outstanding;
+        ids.push_back(client.submit(std::move(request), [round, provider, health, slot](HTTPResponse&& response) {
+            std::vector<SymbolQuote> parsed;
+            bool ok = response.ok() && provider->parse_batch_quotes(response.body, parsed) > 0;
+            
+            std::lock_guard<std::mutex> lock(round->mutex);
+            if (round->closed) return;
+            if (ok) {
+                health->record_success(response.elapsed_ms);
+            } else {
+                health->record_failure();
+                OB_LOG_WARN("%s: batch quote failed: HTTP %ld, %s", provider->get_name().c_str(),
+                            response.status, failure_reason(response));
+            }
+            round->finished[slot] = true;
+            --round->outstanding;
+            for (auto& result : parsed) {
+                round->quotes.push_back(std::move(result));
+            }
+            round->cv.notify_all();
+        }));
+    }
+    
+    round->cv.wait_for(lock, quote_timeout_, [&]() { return round->outstanding == 0; });
+    round->closed = true;
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (!round->finished[i]) {
+            client.cancel(ids[i]);
+            health->record_failure();
+            OB_LOG_WARN("%s: batch quote timed out", provider->get_name().c_str());
+        }
+    }
+    for (auto& result : round->quotes) {
+        quotes.push_back(std::move(result));
+    }
+}
+
+bool MarketDataAggregator::get_quote_sync(const std::string& symbol, Quote& quote) {
+    for (size_t index : ranked_providers()) {
+        auto& provider = providers_[index];
+        if (provider->supports_async_quotes()) continue;
+        
+        auto start = std::chrono::steady_clock::now();
         if (provider->get_quote(symbol, quote)) {
+            health_[index]->record_success(std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count());
             return true;
         }
+        health_[index]->record_failure();
+        OB_LOG_WARN("%s: quote %s failed", provider->get_name().c_str(), symbol.c_str());
     }
     return false;
 }
 
+// Trades and bars skip open circuits but do not feed the breaker: a false
+// return there also means "not supported by this provider"
+
 bool MarketDataAggregator::get_trades(const std::string& symbol, std::vector<Trade>& trades, int limit) {
-    for (auto& provider : providers_) {
-        if (provider->get_trades(symbol, trades, limit)) {
+    for (size_t index : ranked_providers()) {
+        if (providers_[index]->get_trades(symbol, trades, limit)) {
             return true;
         }
     }
@@ -447,12 +1030,31 @@ bool MarketDataAggregator::get_trades(const std::string& symbol, std::vector<Tra
 
 bool MarketDataAggregator::get_ohlcv(const std::string& symbol, std::vector<OHLCV>& data, 
                                      const std::string& interval, int limit) {
-    for (auto& provider : providers_) {
-        if (provider->get_ohlcv(symbol, data, interval, limit)) {
-            return true;
+    std::shared_ptr<BarCache> cache = bar_cache_;
+    if (!cache || !BarCache::interval_ns(interval)) {
+        for (size_t index : ranked_providers()) {
+            if (providers_[index]->get_ohlcv(symbol, data, interval, limit)) {
+                return true;
+            }
         }
+        return false;
     }
-    return false;
+    
+    // Ask only for the bars that closed since the last fetch; if every
+    // provider fails, whatever is on disk is still returned
+    uint64_t now = BarCache::now_ns();
+    int fetch = cache->bars_to_fetch(symbol, interval, limit, now);
+    std::vector<OHLCV> fresh;
+    if (fetch > 0) {
+        for (size_t index : ranked_providers()) {
+            if (providers_[index]->get_ohlcv(symbol, fresh, interval, fetch)) {
+                cache->store(symbol, interval, fetch, fresh, now);
+                break;
+            }
+            fresh.clear();
+        }
+    }
+    return cache->latest(symbol, interval, limit, fresh, now, data);
 }
 
 std::vector<std::string> MarketDataAggregator::get_available_providers() const {
@@ -470,32 +1072,162 @@ std::vector<std::string> MarketDataAggregator::get_available_providers() const {
 // ============================================================================
 
 MarketDataFeed::MarketDataFeed(MarketDataAggregator& aggregator)
-    : aggregator_(aggregator), running_(false), update_interval_ms_(1000) {
+    : aggregator_(aggregator), running_(false), update_interval_ms_(1000), updates_(0), recorder_(nullptr) {
+}
+
+MarketDataFeed::~MarketDataFeed() {
+    stop();
 }
 
 void MarketDataFeed::start(const std::string& symbol) {
-    symbol_ = symbol;
+    start(std::vector<std::string>{symbol});
+}
+
+void MarketDataFeed::start(const std::vector<std::string>& symbols) {
+    stop();
+    watch(symbols);
+    running_ = true;
+    poll_thread_ = std::thread(&MarketDataFeed::poll_loop, this);
+}
+
+void MarketDataFeed::start_stream(const std::string& server_url, const std::vector<std::string>& symbols) {
+    stop();
+    watch(symbols);
     running_ = true;
+    stream_ = std::make_unique<QuoteStream>(server_url, symbol_ids_, [this](const SymbolQuote& quote) {
+        publish(&quote, 1);
+    });
+    stream_->start();
+}
+
+void MarketDataFeed::watch(const std::vector<std::string>& symbols) {
+    SymbolTable& table = SymbolTable::global();
+    symbols_.clear();
+    symbol_ids_.clear();
+    slot_of_.clear();
+    for (const auto& symbol : symbols) {
+        SymbolId id = table.intern(symbol);
+        if (id < slot_of_.size() && slot_of_[id] != NO_SLOT) continue;  // Listed twice
+        if (id >= slot_of_.size()) {
+            slot_of_.resize(id + 1, NO_SLOT);
+        }
+        slot_of_[id] = static_cast<uint32_t>(symbols_.size());
+        symbols_.push_back(symbol);
+        symbol_ids_.push_back(id);
+    }
+    slots_.reset(new SeqLock<QuoteSlot>[symbols_.size()]);
+    updates_.store(0, std::memory_order_relaxed);
 }
 
 void MarketDataFeed::stop() {
-    running_ = false;
+    {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        running_ = false;
+    }
+    wait_cv_.notify_all();
+    if (poll_thread_.joinable()) {
+        poll_thread_.join();
+    }
+    stream_.reset();
 }
 
-bool MarketDataFeed::get_latest_quote(Quote& quote) {
-    if (!running_) return false;
-    
-    if (aggregator_.get_quote(symbol_, latest_quote_)) {
-        quote = latest_quote_;
+void MarketDataFeed::poll_loop() {
+    // Waits stay interval-driven; the role only places the thread and counts its polls
+    PollLoop loop(ThreadRole::FEED);
+    std::vector<SymbolQuote> quotes;
+    while (running_.load(std::memory_order_relaxed)) {
+        uint64_t start = loop.begin();
+        quotes.clear();
+        {
+            OB_TRACE_SCOPE("feed.fetch");
+            if (symbol_ids_.size() == 1) {
+                // A single symbol is better served by hedging across providers
+                Quote quote;
+                if (aggregator_.get_quote(symbols_[0], quote)) {
+                    quotes.push_back({symbol_ids_[0], std::move(quote)});
+                }
+            } else if (!symbol_ids_.empty()) {
+                aggregator_.get_quotes(symbol_ids_, quotes);
+            }
+        }
         
-        if (quote_callback_) {
-            quote_callback_(quote);
+        if (!quotes.empty()) {
+            publish(quotes.data(), quotes.size());
         }
+        loop.record(start, !quotes.empty());
         
-        return true;
+        std::unique_lock<std::mutex> lock(wait_mutex_);
+        wait_cv_.wait_for(lock, std::chrono::milliseconds(update_interval_ms_.load(std::memory_order_relaxed)),
+                          [this]() { return !running_.load(std::memory_order_relaxed); });
+    }
+}
+
+void MarketDataFeed::publish(const SymbolQuote* quotes, size_t count) {
+    OB_TRACE_SCOPE("feed.publish");
+    int64_t received = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    for (size_t i = 0; i < count; ++i) {
+        if (quotes[i].symbol >= slot_of_.size() || slot_of_[quotes[i].symbol] == NO_SLOT) continue;
+        const Quote& quote = quotes[i].quote;
+        slots_[slot_of_[quotes[i].symbol]].store({quote.bid_price, quote.ask_price, quote.bid_size,
+                                                  quote.ask_size, quote.timestamp, received});
+    }
+    {
+        // Pairs with wait_for_update's predicate check so no wakeup is lost
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        updates_.fetch_add(1, std::memory_order_release);
     }
+    wait_cv_.notify_all();
     
-    return false;
+    if (recorder_) {
+        for (size_t i = 0; i < count; ++i) {
+            recorder_->record(quotes[i].symbol, quotes[i].quote);
+        }
+    }
+    if (quote_callback_) {
+        for (size_t i = 0; i < count; ++i) {
+            quote_callback_(quotes[i].quote);
+        }
+    }
+}
+
+bool MarketDataFeed::get_latest_quote(Quote& quote) const {
+    std::chrono::nanoseconds age;
+    return get_latest_quote(quote, age);
+}
+
+bool MarketDataFeed::get_latest_quote(Quote& quote, std::chrono::nanoseconds& age) const {
+    return !symbol_ids_.empty() && get_latest_quote(symbol_ids_[0], quote, age);
+}
+
+bool MarketDataFeed::get_latest_quote(const std::string& symbol, Quote& quote) const {
+    std::chrono::nanoseconds age;
+    SymbolId id = SymbolTable::global().find(symbol);
+    return id != INVALID_SYMBOL && get_latest_quote(id, quote, age);
+}
+
+bool MarketDataFeed::get_latest_quote(SymbolId symbol, Quote& quote, std::chrono::nanoseconds& age) const {
+    if (symbol >= slot_of_.size() || slot_of_[symbol] == NO_SLOT) return false;
+    
+    uint32_t index = slot_of_[symbol];
+    if (slots_[index].version() == 0) return false;
+    
+    QuoteSlot slot = slots_[index].load();
+    quote.symbol = symbols_[index];
+    quote.bid_price = slot.bid_price;
+    quote.ask_price = slot.ask_price;
+    quote.bid_size = slot.bid_size;
+    quote.ask_size = slot.ask_size;
+    quote.timestamp = slot.timestamp;
+    age = std::chrono::steady_clock::now().time_since_epoch() - std::chrono::nanoseconds(slot.received_ns);
+    return true;
+}
+
+bool MarketDataFeed::wait_for_update(uint64_t seen, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(wait_mutex_);
+    return wait_cv_.wait_for(lock, timeout, [this, seen]() {
+        return updates() > seen || !running_.load(std::memory_order_relaxed);
+    }) && updates() > seen;
 }
 
 void MarketDataFeed::set_quote_callback(std::function<void(const Quote&)> callback) {
@@ -6,10 +6,26 @@
 #include <functional>
 #include <chrono>
 #include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
 #include "order.hpp"
+#include "async_http.hpp"
+#include "token_bucket.hpp"
+#include "provider_health.hpp"
+#include "seqlock.hpp"
+#include "symbol_table.hpp"
 
 namespace OrderBookNS {
 
+class RequestScheduler;
+class QuoteStream;
+class BarCache;
+class TickRecorder;
+
 // Use types from orderbook namespace
 using orderbook::Price;
 using orderbook::Quantity;
@@ -26,6 +42,12 @@ struct Quote {
     Quote() : bid_price(0), ask_price(0), bid_size(0), ask_size(0), timestamp(0) {}
 };
 
+// Quote keyed by interned symbol (batch results)
+struct SymbolQuote {
+    SymbolId symbol;
+    Quote quote;
+};
+
 struct Trade {
     std::string symbol;
     Price price;
@@ -69,11 +91,73 @@ public:
         return false; // Not all providers support this
     }
     
+    // Async quote support: describe the HTTP request for a quote and parse its
+    // body. The aggregator fires these on the shared AsyncHTTPClient; providers
+    // that do not override them are queried through get_quote instead.
+    virtual bool supports_async_quotes() const { return false; }
+    virtual bool build_quote_request(const std::string&, HTTPRequest&) { return false; }
+    virtual bool parse_quote(const std::string&, const std::string&, Quote&) const { return false; }
+    
+    // Same for OHLCV bars (symbol, interval, limit)
+    virtual bool supports_async_ohlcv() const { return false; }
+    virtual bool build_ohlcv_request(const std::string&, const std::string&, int, HTTPRequest&) { return false; }
+    virtual bool parse_ohlcv(const std::string&, int, const std::string&, std::vector<OHLCV>&) const { return false; }
+    
+    // Batch quotes: many symbols in one round trip. max_batch_quotes is the
+    // most symbols one request may carry (0 means no batch endpoint). Parsed
+    // quotes are appended in response order; symbols the response lacks, or
+    // that were never interned, are simply absent. Returns how many were added.
+    virtual size_t max_batch_quotes() const { return 0; }
+    virtual bool build_batch_quote_request(const std::vector<SymbolId>&, HTTPRequest&) { return false; }
+    virtual size_t parse_batch_quotes(const std::string&, std::vector<SymbolQuote>&) const { return 0; }
+    
+    // Blocking batch quote; the default asks get_quote once per symbol
+    virtual size_t get_quotes(const std::vector<SymbolId>& symbols, std::vector<SymbolQuote>& quotes) {
+        const SymbolTable& table = SymbolTable::global();
+        size_t added = 0;
+        for (SymbolId id : symbols) {
+            Quote quote;
+            if (get_quote(table.name(id), quote)) {
+                quotes.push_back({id, std::move(quote)});
+                ++added;
+            }
+        }
+        return added;
+    }
+    
+    // Request budget shared by every caller of this provider; nullptr if unlimited.
+    // Async callers take a token before building a request; the provider's own
+    // blocking calls take one themselves and fail fast when none is left.
+    virtual TokenBucket* rate_limiter() { return nullptr; }
+    
+    // Base URL requests go to, for connection warm-up; empty if none
+    virtual std::string endpoint() const { return std::string(); }
+    
     // Check if provider is available
     virtual bool is_available() const = 0;
     
     // Get provider name
     virtual std::string get_name() const = 0;
+    
+protected:
+    // get_quotes over the batch endpoint: one fetch(request, body) per
+    // max_batch_quotes symbols
+    template<typename Fetch>
+    size_t get_quotes_batched(const std::vector<SymbolId>& symbols, std::vector<SymbolQuote>& quotes,
+                              Fetch&& fetch) {
+        size_t chunk = std::max<size_t>(max_batch_quotes(), 1);
+        size_t added = 0;
+        for (size_t first = 0; first < symbols.size(); first += chunk) {
+            std::vector<SymbolId> batch(symbols.begin() + first,
+                                        symbols.begin() + std::min(first + chunk, symbols.size()));
+            HTTPRequest request;
+            std::string body;
+            if (build_batch_quote_request(batch, request) && fetch(request, body)) {
+                added += parse_batch_quotes(body, quotes);
+            }
+        }
+        return added;
+    }
 };
 
 // HTTP Client for making API requests
@@ -92,6 +176,7 @@ public:
 private:
     void* curl_handle_; // CURL*
     long timeout_;
+    std::mutex mutex_;  // One easy handle; the health probe may call in from its own thread
 };
 
 // Yahoo Finance provider
@@ -101,11 +186,20 @@ public:
     ~YahooFinanceProvider() override = default;
     
     bool get_quote(const std::string& symbol, Quote& quote) override;
+    bool supports_async_quotes() const override { return true; }
+    bool build_quote_request(const std::string& symbol, HTTPRequest& request) override;
+    bool parse_quote(const std::string& symbol, const std::string& body, Quote& quote) const override;
+    bool supports_async_ohlcv() const override { return true; }
+    bool build_ohlcv_request(const std::string& symbol, const std::string& interval, int limit,
+                             HTTPRequest& request) override;
+    bool parse_ohlcv(const std::string& symbol, int limit, const std::string& body,
+                     std::vector<OHLCV>& data) const override;
     bool get_trades(const std::string& symbol, std::vector<Trade>& trades, int limit = 100) override;
     bool get_ohlcv(const std::string& symbol, std::vector<OHLCV>& data, 
                    const std::string& interval = "1min", int limit = 100) override;
     bool is_available() const override;
     std::string get_name() const override { return "Yahoo Finance"; }
+    std::string endpoint() const override { return base_url_; }
     
 private:
     HTTPClient http_client_;
@@ -119,19 +213,27 @@ public:
     ~AlphaVantageProvider() override = default;
     
     bool get_quote(const std::string& symbol, Quote& quote) override;
+    bool supports_async_quotes() const override { return true; }
+    bool build_quote_request(const std::string& symbol, HTTPRequest& request) override;
+    bool parse_quote(const std::string& symbol, const std::string& body, Quote& quote) const override;
+    bool supports_async_ohlcv() const override { return true; }
+    bool build_ohlcv_request(const std::string& symbol, const std::string& interval, int limit,
+                             HTTPRequest& request) override;
+    bool parse_ohlcv(const std::string& symbol, int limit, const std::string& body,
+                     std::vector<OHLCV>& data) const override;
     bool get_trades(const std::string& symbol, std::vector<Trade>& trades, int limit = 100) override;
     bool get_ohlcv(const std::string& symbol, std::vector<OHLCV>& data, 
                    const std::string& interval = "1min", int limit = 100) override;
     bool is_available() const override;
     std::string get_name() const override { return "Alpha Vantage"; }
+    std::string endpoint() const override { return base_url_; }
+    TokenBucket* rate_limiter() override { return &rate_limiter_; }
     
 private:
     HTTPClient http_client_;
     std::string api_key_;
     std::string base_url_;
-    std::chrono::steady_clock::time_point last_request_time_;
-    
-    void rate_limit(); // Alpha Vantage has rate limits
+    TokenBucket rate_limiter_; // Free tier: 5 requests per minute
 };
 
 // Financial Modeling Prep provider
@@ -141,11 +243,24 @@ public:
     ~FinancialModelingPrepProvider() override = default;
     
     bool get_quote(const std::string& symbol, Quote& quote) override;
+    bool supports_async_quotes() const override { return true; }
+    bool build_quote_request(const std::string& symbol, HTTPRequest& request) override;
+    bool parse_quote(const std::string& symbol, const std::string& body, Quote& quote) const override;
+    size_t max_batch_quotes() const override { return 100; }
+    bool build_batch_quote_request(const std::vector<SymbolId>& symbols, HTTPRequest& request) override;
+    size_t parse_batch_quotes(const std::string& body, std::vector<SymbolQuote>& quotes) const override;
+    size_t get_quotes(const std::vector<SymbolId>& symbols, std::vector<SymbolQuote>& quotes) override;
+    bool supports_async_ohlcv() const override { return true; }
+    bool build_ohlcv_request(const std::string& symbol, const std::string& interval, int limit,
+                             HTTPRequest& request) override;
+    bool parse_ohlcv(const std::string& symbol, int limit, const std::string& body,
+                     std::vector<OHLCV>& data) const override;
     bool get_trades(const std::string& symbol, std::vector<Trade>& trades, int limit = 100) override;
     bool get_ohlcv(const std::string& symbol, std::vector<OHLCV>& data, 
                    const std::string& interval = "1min", int limit = 100) override;
     bool is_available() const override;
     std::string get_name() const override { return "Financial Modeling Prep"; }
+    std::string endpoint() const override { return base_url_; }
     
 private:
     HTTPClient http_client_;
@@ -154,67 +269,197 @@ private:
 };
 
 // Market data aggregator - tries multiple providers
+// Quotes are hedged across providers on a shared async HTTP client: the first
+// provider is asked, the next one is added each time the hedge delay passes
+// without a valid answer, and the first valid response wins (the rest are
+// cancelled). Providers without async support are tried afterwards, in order.
 class MarketDataAggregator {
 public:
     MarketDataAggregator();
-    ~MarketDataAggregator() = default;
+    ~MarketDataAggregator();
     
     // Add a data provider
     void add_provider(std::shared_ptr<IMarketDataProvider> provider);
     
-    // Get quote from first available provider
+    // Hedged quote; blocks for at most the quote timeout (plus sync fallbacks)
     bool get_quote(const std::string& symbol, Quote& quote);
     
+    // Hedged quotes for many symbols, all in flight concurrently
+    std::vector<std::optional<Quote>> get_quotes(const std::vector<std::string>& symbols);
+    
+    // Quotes for many interned symbols. Batch-capable providers go first, with
+    // one request per max_batch_quotes symbols; whatever they miss falls back
+    // to hedged per-symbol quotes. Appends at most one quote per requested
+    // symbol and returns how many were added.
+    size_t get_quotes(const std::vector<SymbolId>& symbols, std::vector<SymbolQuote>& quotes);
+    
+    // Hedging parameters
+    void set_hedge_delay(std::chrono::milliseconds delay) { hedge_delay_ = delay; }
+    void set_quote_timeout(std::chrono::milliseconds timeout) { quote_timeout_ = timeout; }
+    
     // Get trades from first available provider
     bool get_trades(const std::string& symbol, std::vector<Trade>& trades, int limit = 100);
     
-    // Get OHLCV from first available provider
+    // Get OHLCV from first available provider. With a bar cache, closed bars
+    // come from disk and only the ones missing since the last call are
+    // fetched; bars are then returned oldest first.
     bool get_ohlcv(const std::string& symbol, std::vector<OHLCV>& data, 
                    const std::string& interval = "1min", int limit = 100);
     
+    // On-disk bar cache for get_ohlcv and scheduler().request_ohlcv (set
+    // before the scheduler is first used); nullptr disables it
+    void set_bar_cache(std::shared_ptr<BarCache> cache) { bar_cache_ = std::move(cache); }
+    std::shared_ptr<BarCache> bar_cache() const { return bar_cache_; }
+    
     // Get list of available providers
     std::vector<std::string> get_available_providers() const;
     
+    // Circuit breaker state per provider, in registration order
+    std::vector<std::pair<std::string, ProviderHealth::Snapshot>> get_provider_health() const;
+    // The trackers themselves, for lock-free reads of their counters and
+    // latency histograms (providers added later are not included)
+    std::vector<std::pair<std::string, std::shared_ptr<const ProviderHealth>>> get_provider_trackers() const;
+    
+    // Circuit breaker tuning (applies to providers added afterwards) and the
+    // symbol background probes ask for
+    void set_circuit_breaker(const CircuitBreakerConfig& config) { breaker_config_ = config; }
+    void set_probe_symbol(const std::string& symbol);
+    
+    // Connect to every provider's endpoint now, so the first quote does not
+    // pay for DNS, TCP and TLS setup, and ping them while the client has been
+    // idle for keepalive_idle so the connections stay open. Call after adding
+    // providers; safe to call again when they change.
+    void warm_up(std::chrono::seconds keepalive_idle = std::chrono::seconds(30));
+    
+    // Shared event-loop client (created on first use)
+    AsyncHTTPClient& http();
+    
+    // Non-blocking, rate-limit aware requests over the current providers
+    // (created on first use; add providers before calling)
+    RequestScheduler& scheduler();
+    
 private:
     std::vector<std::shared_ptr<IMarketDataProvider>> providers_;
+    std::vector<std::shared_ptr<ProviderHealth>> health_;  // Parallel to providers_
+    CircuitBreakerConfig breaker_config_;
+    std::unique_ptr<AsyncHTTPClient> http_;
+    std::unique_ptr<RequestScheduler> scheduler_;  // Destroyed before http_
+    std::shared_ptr<BarCache> bar_cache_;
+    std::mutex http_mutex_;
+    std::chrono::milliseconds hedge_delay_;
+    std::chrono::milliseconds quote_timeout_;
+    
+    // Background probing of open circuits (started by the first add_provider)
+    std::thread probe_thread_;
+    std::mutex probe_mutex_;
+    std::condition_variable probe_cv_;
+    bool probe_running_;
+    std::string probe_symbol_;
+    
+    bool get_quote_sync(const std::string& symbol, Quote& quote);
+    
+    // All chunks of a batch to one provider, concurrently; waits up to the quote timeout
+    void fetch_batch_quotes(size_t index, const std::vector<SymbolId>& symbols,
+                            std::vector<SymbolQuote>& quotes);
+    
+    // Indices of providers with a closed circuit, fastest healthy first
+    std::vector<size_t> ranked_providers() const;
+    void probe_loop();
+    void probe(const std::shared_ptr<IMarketDataProvider>& provider,
+               const std::shared_ptr<ProviderHealth>& health, const std::string& symbol);
 };
 
 // Market data feed that converts real data into order book orders
+// A polling thread fetches quotes every update interval and publishes each
+// into its symbol's seqlock slot. get_latest_quote is a lock-free read of a
+// slot and never touches the network, so UI and simulation threads can call
+// it freely. A watch list is fetched as one batch per interval where the
+// providers allow it.
 class MarketDataFeed {
 public:
     explicit MarketDataFeed(MarketDataAggregator& aggregator);
-    ~MarketDataFeed() = default;
+    ~MarketDataFeed();
     
-    // Start streaming market data for a symbol
+    // Start polling a symbol or a watch list (restarts if already running).
+    // Call start/stop from one thread, not concurrently with readers.
     void start(const std::string& symbol);
+    void start(const std::vector<std::string>& symbols);
     
-    // Stop streaming
+    // Instead of polling, subscribe to the local quote server's push stream
+    // (GET /stream); each quote is published as soon as it arrives
+    void start_stream(const std::string& server_url, const std::vector<std::string>& symbols);
+    
+    // Stop polling and join the thread
     void stop();
     
     // Check if feed is running
-    bool is_running() const { return running_; }
+    bool is_running() const { return running_.load(std::memory_order_relaxed); }
     
-    // Get latest quote
-    bool get_latest_quote(Quote& quote);
+    // Latest published quote for the first symbol; false until one arrives
+    bool get_latest_quote(Quote& quote) const;
     
-    // Set callback for new quotes
-    void set_quote_callback(std::function<void(const Quote&)> callback);
+    // Same, plus how long ago the quote was received
+    bool get_latest_quote(Quote& quote, std::chrono::nanoseconds& age) const;
+    
+    // Latest quote for a watched symbol; false if not watched or none yet
+    bool get_latest_quote(SymbolId symbol, Quote& quote, std::chrono::nanoseconds& age) const;
+    bool get_latest_quote(const std::string& symbol, Quote& quote) const;
     
-    // Set callback for new trades
+    // Watched symbols, in the order given to start()
+    const std::vector<std::string>& symbols() const { return symbols_; }
+    
+    // Poll rounds (or streamed quotes) published so far; compare to see
+    // whether anything new arrived
+    uint64_t updates() const { return updates_.load(std::memory_order_acquire); }
+    
+    // Block until more than `seen` rounds have been published or the timeout
+    // passes (for callers that have nothing better to do than wait)
+    bool wait_for_update(uint64_t seen, std::chrono::milliseconds timeout);
+    
+    // Callbacks run on the polling thread; set them before start()
+    void set_quote_callback(std::function<void(const Quote&)> callback);
     void set_trade_callback(std::function<void(const Trade&)> callback);
     
-    // Update interval in milliseconds
-    void set_update_interval(int milliseconds) { update_interval_ms_ = milliseconds; }
+    // Record every published quote (nullptr stops); set before start()
+    void set_recorder(TickRecorder* recorder) { recorder_ = recorder; }
+    
+    // Update interval in milliseconds (takes effect after the current wait)
+    void set_update_interval(int milliseconds) { update_interval_ms_.store(milliseconds, std::memory_order_relaxed); }
     
 private:
+    // Everything in Quote except the symbol, which is fixed per run
+    struct QuoteSlot {
+        Price bid_price;
+        Price ask_price;
+        Quantity bid_size;
+        Quantity ask_size;
+        uint64_t timestamp;
+        int64_t received_ns;  // steady_clock
+    };
+    
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;
+    
     MarketDataAggregator& aggregator_;
-    std::string symbol_;
-    bool running_;
-    int update_interval_ms_;
-    Quote latest_quote_;
+    std::vector<std::string> symbols_;
+    std::vector<SymbolId> symbol_ids_;
+    std::unique_ptr<SeqLock<QuoteSlot>[]> slots_;  // Parallel to symbols_
+    std::vector<uint32_t> slot_of_;                // SymbolId -> slot, or NO_SLOT
+    std::atomic<bool> running_;
+    std::atomic<int> update_interval_ms_;
+    std::atomic<uint64_t> updates_;
+    
+    std::thread poll_thread_;
+    std::unique_ptr<QuoteStream> stream_;  // Set in streaming mode instead of poll_thread_
+    std::mutex wait_mutex_;
+    std::condition_variable wait_cv_;  // Wakes the poller on stop, waiters on publish
     
     std::function<void(const Quote&)> quote_callback_;
+    TickRecorder* recorder_;
     std::function<void(const Trade&)> trade_callback_;
+    
+    void watch(const std::vector<std::string>& symbols);
+    void publish(const SymbolQuote* quotes, size_t count);
+    void poll_loop();
 };
 
 } // namespace OrderBookNS
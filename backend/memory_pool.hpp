@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <vector>
 #include <cstddef>
 #include <new>
@@ -44,10 +45,17 @@ private:
     Node* free_list_;
     size_t block_size_;
     
+    // Occupancy, for diagnostics and metrics. Only the allocating thread
+    // writes these, so they are plain stores that any thread may read.
+    std::atomic<size_t> capacity_;
+    std::atomic<size_t> in_use_;
+    std::atomic<size_t> high_water_;
+    
     void allocate_block() {
         Block* new_block = new Block(block_size_);
         new_block->next = blocks_;
         blocks_ = new_block;
+        capacity_.store(capacity_.load(std::memory_order_relaxed) + block_size_, std::memory_order_relaxed);
         
         // Link all nodes in the new block to free list
         for (size_t i = 0; i < block_size_ - 1; ++i) {
@@ -59,7 +67,8 @@ private:
     
 public:
     explicit MemoryPool(size_t initial_blocks = 1)
-        : blocks_(nullptr), free_list_(nullptr), block_size_(BlockSize) {
+        : blocks_(nullptr), free_list_(nullptr), block_size_(BlockSize),
+          capacity_(0), in_use_(0), high_water_(0) {
         for (size_t i = 0; i < initial_blocks; ++i) {
             allocate_block();
         }
@@ -86,6 +95,11 @@ public:
         
         Node* node = free_list_;
         free_list_ = node->next;
+        size_t in_use = in_use_.load(std::memory_order_relaxed) + 1;
+        in_use_.store(in_use, std::memory_order_relaxed);
+        if (in_use > high_water_.load(std::memory_order_relaxed)) {
+            high_water_.store(in_use, std::memory_order_relaxed);
+        }
         
         // Construct object in-place
         return new (&node->data) T(std::forward<Args>(args)...);
@@ -102,7 +116,14 @@ public:
         Node* node = reinterpret_cast<Node*>(ptr);
         node->next = free_list_;
         free_list_ = node;
+        in_use_.store(in_use_.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
     }
+    
+    // Objects allocated now, the most ever allocated at once, and the
+    // objects the allocated blocks can hold
+    size_t in_use() const { return in_use_.load(std::memory_order_relaxed); }
+    size_t high_water() const { return high_water_.load(std::memory_order_relaxed); }
+    size_t capacity() const { return capacity_.load(std::memory_order_relaxed); }
 };
 
 } // namespace orderbook
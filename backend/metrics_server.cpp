@@ -0,0 +1,331 @@
+#include "metrics_server.hpp"
+#include "orderbook.hpp"
+#include "provider_health.hpp"
+#include "thread_topology.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace OrderBookNS {
+
+namespace {
+
+constexpr int ACCEPT_POLL_MS = 200;     // How often the server checks for stop()
+constexpr size_t MAX_REQUEST_BYTES = 4096;
+
+bool send_all(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t sent = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        data += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+} // namespace
+
+void MetricsWriter::family(const char* name, const char* type, const char* help) {
+    text_ += "# HELP ";
+    text_ += name;
+    text_ += ' ';
+    text_ += help;
+    text_ += "\n# TYPE ";
+    text_ += name;
+    text_ += ' ';
+    text_ += type;
+    text_ += '\n';
+}
+
+void MetricsWriter::sample(const char* name, double value, const std::string& labels) {
+    char number[32];
+    std::snprintf(number, sizeof(number), "%.10g", value);
+    text_ += name;
+    if (!labels.empty()) {
+        text_ += '{';
+        text_ += labels;
+        text_ += '}';
+    }
+    text_ += ' ';
+    text_ += number;
+    text_ += '\n';
+}
+
+void MetricsWriter::sample(const char* name, uint64_t value, const std::string& labels) {
+    char number[24];
+    std::snprintf(number, sizeof(number), "%llu", static_cast<unsigned long long>(value));
+    text_ += name;
+    if (!labels.empty()) {
+        text_ += '{';
+        text_ += labels;
+        text_ += '}';
+    }
+    text_ += ' ';
+    text_ += number;
+    text_ += '\n';
+}
+
+void MetricsWriter::counter(const char* name, const char* help, uint64_t value) {
+    family(name, "counter", help);
+    sample(name, value);
+}
+
+void MetricsWriter::gauge(const char* name, const char* help, double value) {
+    family(name, "gauge", help);
+    sample(name, value);
+}
+
+void MetricsWriter::histogram(const char* name, const orderbook::LatencyHistogram& histogram,
+                              const std::string& labels) {
+    using orderbook::LatencyHistogram;
+    const std::string bucket = std::string(name) + "_bucket";
+    const std::string prefix = labels.empty() ? std::string() : labels + ",";
+    
+    // Bucket b holds samples below 2^b ns. Writers keep recording while the
+    // buckets are read, so _count is the sum of what was read and always
+    // matches the +Inf bucket.
+    uint64_t cumulative = 0;
+    char le[48];
+    for (size_t b = 0; b + 1 < LatencyHistogram::BUCKETS; ++b) {
+        cumulative += histogram.bucket(b);
+        std::snprintf(le, sizeof(le), "le=\"%.10g\"", static_cast<double>(1ULL << b) / 1e9);
+        sample(bucket.c_str(), cumulative, prefix + le);
+    }
+    cumulative += histogram.bucket(LatencyHistogram::BUCKETS - 1);
+    sample(bucket.c_str(), cumulative, prefix + "le=\"+Inf\"");
+    sample((std::string(name) + "_sum").c_str(), static_cast<double>(histogram.total_ns()) / 1e9, labels);
+    sample((std::string(name) + "_count").c_str(), cumulative, labels);
+}
+
+std::string MetricsWriter::label(const char* key, const std::string& value) {
+    std::string result = key;
+    result += "=\"";
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            result += '\\';
+            result += c;
+        } else if (c == '\n') {
+            result += "\\n";
+        } else {
+            result += c;
+        }
+    }
+    result += '"';
+    return result;
+}
+
+void collect_book_metrics(MetricsWriter& out, const orderbook::OrderBook& book) {
+    const orderbook::BookCounters& c = book.counters();
+    auto read = [](const std::atomic<uint64_t>& counter) { return counter.load(std::memory_order_relaxed); };
+    
+    out.counter("orderbook_orders_added_total", "Orders submitted to the book", read(c.orders_added));
+    out.counter("orderbook_orders_cancelled_total", "Orders cancelled", read(c.orders_cancelled));
+    out.counter("orderbook_orders_expired_total", "DAY/GTD orders expired", read(c.orders_expired));
+    out.counter("orderbook_orders_matched_total", "Orders fully filled by matching", read(c.orders_matched));
+    out.counter("orderbook_trades_total", "Trades executed", read(c.trades));
+    out.counter("orderbook_traded_quantity_total", "Quantity traded", read(c.traded_quantity));
+    out.gauge("orderbook_resting_orders", "Orders in the book's index",
+              static_cast<double>(read(c.resting_orders)));
+    
+    out.family("orderbook_price_levels", "gauge", "Price levels per side");
+    out.sample("orderbook_price_levels", read(c.bid_levels), "side=\"bid\"");
+    out.sample("orderbook_price_levels", read(c.ask_levels), "side=\"ask\"");
+    
+    const auto& orders = book.order_pool();
+    const auto& levels = book.price_level_pool();
+    out.family("orderbook_pool_in_use", "gauge", "Objects allocated from a pool");
+    out.sample("orderbook_pool_in_use", static_cast<uint64_t>(orders.in_use()), "pool=\"orders\"");
+    out.sample("orderbook_pool_in_use", static_cast<uint64_t>(levels.in_use()), "pool=\"price_levels\"");
+    out.family("orderbook_pool_high_water", "gauge", "Most objects ever allocated from a pool at once");
+    out.sample("orderbook_pool_high_water", static_cast<uint64_t>(orders.high_water()), "pool=\"orders\"");
+    out.sample("orderbook_pool_high_water", static_cast<uint64_t>(levels.high_water()), "pool=\"price_levels\"");
+    out.family("orderbook_pool_capacity", "gauge", "Objects a pool's allocated blocks can hold");
+    out.sample("orderbook_pool_capacity", static_cast<uint64_t>(orders.capacity()), "pool=\"orders\"");
+    out.sample("orderbook_pool_capacity", static_cast<uint64_t>(levels.capacity()), "pool=\"price_levels\"");
+    
+    out.family("orderbook_operation_latency_seconds", "histogram",
+               "Wall time of book operations (add includes matching)");
+    out.histogram("orderbook_operation_latency_seconds", book.add_latency(), "op=\"add\"");
+    out.histogram("orderbook_operation_latency_seconds", book.cancel_latency(), "op=\"cancel\"");
+    out.histogram("orderbook_operation_latency_seconds", book.modify_latency(), "op=\"modify\"");
+}
+
+void collect_provider_metrics(MetricsWriter& out, const ProviderTrackers& providers) {
+    if (providers.empty()) return;
+    
+    out.family("orderbook_feed_requests_total", "counter", "Market data requests per provider");
+    for (const auto& [name, health] : providers) {
+        out.sample("orderbook_feed_requests_total", health->successes() + health->failures(),
+                   MetricsWriter::label("provider", name));
+    }
+    out.family("orderbook_feed_request_errors_total", "counter", "Failed market data requests per provider");
+    for (const auto& [name, health] : providers) {
+        out.sample("orderbook_feed_request_errors_total", health->failures(), MetricsWriter::label("provider", name));
+    }
+    out.family("orderbook_feed_circuit_state", "gauge", "Provider circuit breaker: 0 closed, 1 open, 2 half-open");
+    for (const auto& [name, health] : providers) {
+        out.sample("orderbook_feed_circuit_state", static_cast<uint64_t>(health->state()),
+                   MetricsWriter::label("provider", name));
+    }
+    out.family("orderbook_feed_request_latency_seconds", "histogram",
+               "Latency of successful market data requests per provider");
+    for (const auto& [name, health] : providers) {
+        out.histogram("orderbook_feed_request_latency_seconds", health->latency(),
+                      MetricsWriter::label("provider", name));
+    }
+}
+
+MetricsServer::MetricsServer(uint16_t port, std::string address)
+    : port_(port), address_(std::move(address)), listen_fd_(-1), running_(false), scrapes_(0) {}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+void MetricsServer::add_collector(Collector collector) {
+    collectors_.push_back(std::move(collector));
+}
+
+bool MetricsServer::start() {
+    if (running_.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port_);
+    if (inet_pton(AF_INET, address_.c_str(), &addr.sin_addr) != 1) {
+        error_ = "invalid address " + address_;
+        return false;
+    }
+    
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        error_ = std::string("socket: ") + std::strerror(errno);
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listen_fd_, 16) != 0) {
+        error_ = address_ + ":" + std::to_string(port_) + ": " + std::strerror(errno);
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    
+    // Port 0 asked the OS to pick one
+    socklen_t length = sizeof(addr);
+    if (getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &length) == 0) {
+        port_ = ntohs(addr.sin_port);
+    }
+    
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&MetricsServer::serve_loop, this);
+    return true;
+}
+
+void MetricsServer::stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+}
+
+std::string MetricsServer::render() {
+    MetricsWriter out;
+    collect(out);
+    return out.text();
+}
+
+void MetricsServer::collect(MetricsWriter& out) {
+    out.counter("orderbook_metrics_scrapes_total", "Scrapes served", scrapes());
+    for (const auto& collector : collectors_) {
+        collector(out);
+    }
+}
+
+void MetricsServer::serve_loop() {
+    // Blocks in poll(); the role only places the thread and counts scrapes
+    PollLoop loop(ThreadRole::METRICS);
+    pollfd listener{listen_fd_, POLLIN, 0};
+    while (running_.load(std::memory_order_acquire)) {
+        int ready = ::poll(&listener, 1, ACCEPT_POLL_MS);
+        uint64_t start = loop.begin();
+        bool worked = false;
+        if (ready > 0 && (listener.revents & POLLIN)) {
+            int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd >= 0) {
+                handle(fd);
+                ::close(fd);
+                worked = true;
+            }
+        }
+        loop.record(start, worked);
+    }
+}
+
+void MetricsServer::handle(int fd) {
+    // A client that never finishes its request cannot hold the thread
+    timeval timeout{1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    
+    char request[MAX_REQUEST_BYTES];
+    size_t used = 0;
+    while (used < sizeof(request) - 1) {
+        ssize_t received = ::recv(fd, request + used, sizeof(request) - 1 - used, 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) break;
+        used += static_cast<size_t>(received);
+        request[used] = '\0';
+        if (std::strstr(request, "\r\n\r\n")) break;
+    }
+    request[used] = '\0';
+    
+    // Only the request line matters: "GET /metrics HTTP/1.1"
+    const char* status = "404 Not Found";
+    const char* type = "text/plain; charset=utf-8";
+    const std::string* body = nullptr;
+    static const std::string not_found = "Not found; metrics are at /metrics\n";
+    static const std::string not_allowed = "Only GET is supported\n";
+    if (std::strncmp(request, "GET ", 4) != 0) {
+        status = "405 Method Not Allowed";
+        body = &not_allowed;
+    } else {
+        const char* path = request + 4;
+        size_t length = std::strcspn(path, " ?\r\n");
+        if (length == 8 && std::strncmp(path, "/metrics", 8) == 0) {
+            scrapes_.store(scrapes_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            writer_.clear();
+            collect(writer_);
+            status = "200 OK";
+            type = "text/plain; version=0.0.4; charset=utf-8";
+            body = &writer_.text();
+        } else {
+            body = &not_found;
+        }
+    }
+    
+    char header[192];
+    int header_length = std::snprintf(header, sizeof(header),
+                                      "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\n"
+                                      "Connection: close\r\n\r\n",
+                                      status, type, body->size());
+    if (send_all(fd, header, static_cast<size_t>(header_length))) {
+        send_all(fd, body->data(), body->size());
+    }
+}
+
+} // namespace OrderBookNS
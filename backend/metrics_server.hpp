@@ -0,0 +1,109 @@
+#pragma once
+
+#include "latency_histogram.hpp"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace orderbook {
+class OrderBook;
+}
+
+namespace OrderBookNS {
+
+class ProviderHealth;
+
+// Builds a Prometheus text exposition (format 0.0.4)
+// A metric family is announced once with family(), then given one sample
+// per label set. Labels are written as-is: `provider="Yahoo Finance"`.
+class MetricsWriter {
+public:
+    void family(const char* name, const char* type, const char* help);
+    void sample(const char* name, double value, const std::string& labels = std::string());
+    void sample(const char* name, uint64_t value, const std::string& labels = std::string());
+    
+    // Single-sample families
+    void counter(const char* name, const char* help, uint64_t value);
+    void gauge(const char* name, const char* help, double value);
+    
+    // Cumulative _bucket, _sum and _count samples of a log2 latency histogram,
+    // in seconds; announce the family with type "histogram" first
+    void histogram(const char* name, const orderbook::LatencyHistogram& histogram,
+                   const std::string& labels = std::string());
+    
+    // Label value with quotes, backslashes and newlines escaped
+    static std::string label(const char* key, const std::string& value);
+    
+    const std::string& text() const { return text_; }
+    void clear() { text_.clear(); }
+    
+private:
+    std::string text_;
+};
+
+// Per-provider health trackers by provider name
+using ProviderTrackers = std::vector<std::pair<std::string, std::shared_ptr<const ProviderHealth>>>;
+
+// Standard collectors; each reads only atomics, so a scrape never waits on
+// the thread that owns what it reads
+void collect_book_metrics(MetricsWriter& out, const orderbook::OrderBook& book);
+void collect_provider_metrics(MetricsWriter& out, const ProviderTrackers& providers);
+
+// Embedded HTTP listener for Prometheus scrapes
+// One thread (ThreadRole::METRICS) accepts connections on the loopback
+// interface and answers GET /metrics by running every collector into a
+// MetricsWriter; anything else gets a 404. Collectors run on that thread, so
+// they must read only lock-free counters and histograms.
+//
+//   MetricsServer metrics(9464);
+//   metrics.add_collector([&](MetricsWriter& out) { collect_book_metrics(out, book); });
+//   metrics.start();   // curl http://127.0.0.1:9464/metrics
+class MetricsServer {
+public:
+    using Collector = std::function<void(MetricsWriter&)>;
+    
+    // Port 0 picks a free port (see port() after start())
+    explicit MetricsServer(uint16_t port = 9464, std::string address = "127.0.0.1");
+    ~MetricsServer();
+    
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+    
+    // Add collectors before start()
+    void add_collector(Collector collector);
+    
+    // Bind and start serving; false (with the reason in error()) if the
+    // address cannot be bound
+    bool start();
+    void stop();
+    
+    // The whole exposition, as a scrape would see it
+    std::string render();
+    
+    uint16_t port() const { return port_; }
+    const std::string& address() const { return address_; }
+    const std::string& error() const { return error_; }
+    uint64_t scrapes() const { return scrapes_.load(std::memory_order_relaxed); }
+    
+private:
+    uint16_t port_;
+    std::string address_;
+    std::string error_;
+    int listen_fd_;
+    std::atomic<bool> running_;
+    std::thread thread_;
+    std::atomic<uint64_t> scrapes_;
+    std::vector<Collector> collectors_;
+    MetricsWriter writer_;   // Server thread only
+    
+    void collect(MetricsWriter& out);
+    void serve_loop();
+    void handle(int fd);
+};
+
+} // namespace OrderBookNS
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace OrderBookNS {
+
+// Bounded lock-free multi-producer, single-consumer queue
+// A ring of cells, each tagged with a sequence number (Vyukov's bounded
+// queue). Producers claim a cell with one CAS on the tail and publish it by
+// bumping its sequence; the consumer reads cells in order. try_push never
+// waits: when the ring is full it fails and the caller decides what to drop.
+// Capacity is rounded up to a power of two.
+template<typename T>
+class MPSCQueue {
+    static_assert(std::is_trivially_copyable<T>::value, "MPSCQueue payload must be trivially copyable");
+    
+    struct Cell {
+        std::atomic<uint64_t> sequence;
+        T value;
+    };
+    
+public:
+    explicit MPSCQueue(size_t capacity)
+        : mask_(round_up(capacity) - 1), cells_(new Cell[mask_ + 1]), head_(0), tail_(0) {
+        for (size_t i = 0; i <= mask_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    
+    MPSCQueue(const MPSCQueue&) = delete;
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+    
+    // Any thread; false if the queue is full
+    bool try_push(const T& value) noexcept {
+        uint64_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            uint64_t seq = cell.sequence.load(std::memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // Full: the consumer has not freed this cell yet
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+    
+    // Consumer thread only; false if nothing is ready
+    bool try_pop(T& value) noexcept {
+        Cell& cell = cells_[head_ & mask_];
+        if (cell.sequence.load(std::memory_order_acquire) != head_ + 1) {
+            return false;
+        }
+        value = cell.value;
+        cell.sequence.store(head_ + mask_ + 1, std::memory_order_release);
+        ++head_;
+        return true;
+    }
+    
+    size_t capacity() const { return mask_ + 1; }
+    
+private:
+    static size_t round_up(size_t n) {
+        size_t size = 2;
+        while (size < n) size <<= 1;
+        return size;
+    }
+    
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) uint64_t head_;                // Consumer only
+    alignas(64) std::atomic<uint64_t> tail_;   // Shared by producers
+};
+
+} // namespace OrderBookNS
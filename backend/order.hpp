@@ -1,5 +1,6 @@
 #pragma once
 
+#include "timer_wheel.hpp"
 #include <cstdint>
 #include <string>
 #include <chrono>
@@ -28,7 +29,15 @@ enum class OrderStatus : uint8_t {
     PARTIALLY_FILLED = 1,
     FILLED = 2,
     CANCELLED = 3,
-    REJECTED = 4
+    REJECTED = 4,
+    EXPIRED = 5   // Time in force ran out
+};
+
+// How long a resting limit order stays in the book
+enum class TimeInForce : uint8_t {
+    GTC = 0,      // Good till cancelled
+    DAY = 1,      // Until the book's day end
+    GTD = 2       // Until an explicit deadline (also good-for-N-ms)
 };
 
 struct Order {
@@ -39,21 +48,26 @@ struct Order {
     Side side;
     OrderType type;
     OrderStatus status;
+    TimeInForce tif;
     Timestamp timestamp;
     
     // For linked list in price level
     Order* next;
     Order* prev;
     
+    // Pending expiry in the book's timer wheel (null for GTC)
+    TimerWheel<Order*>::Handle expiry;
+    
     Order() : id(0), price(0), quantity(0), filled_quantity(0),
               side(Side::BUY), type(OrderType::LIMIT), status(OrderStatus::NEW),
-              timestamp(Timestamp::zero()), next(nullptr), prev(nullptr) {}
+              tif(TimeInForce::GTC), timestamp(Timestamp::zero()),
+              next(nullptr), prev(nullptr), expiry(nullptr) {}
     
     Order(OrderId id_, Price price_, Quantity qty_, Side side_, OrderType type_)
         : id(id_), price(price_), quantity(qty_), filled_quantity(0),
-          side(side_), type(type_), status(OrderStatus::NEW),
+          side(side_), type(type_), status(OrderStatus::NEW), tif(TimeInForce::GTC),
           timestamp(std::chrono::high_resolution_clock::now().time_since_epoch()),
-          next(nullptr), prev(nullptr) {}
+          next(nullptr), prev(nullptr), expiry(nullptr) {}
     
     inline Quantity remaining_quantity() const {
         return quantity - filled_quantity;
@@ -1,4 +1,5 @@
 #include "orderbook.hpp"
+#include "trace.hpp"
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
@@ -6,13 +7,29 @@
 
 namespace orderbook {
 
-static std::atomic<OrderId> next_order_id{1};
+namespace {
 
-OrderBook::OrderBook()
-    : order_pool_(10), price_level_pool_(10),
-      cumulative_volume_(0.0), cumulative_pq_(0.0) {
-    recent_trade_prices_.reserve(MAX_RECENT_TRADES);
-    recent_trade_quantities_.reserve(MAX_RECENT_TRADES);
+// Counters have a single writer, so a plain load/store avoids a locked add
+inline void bump(std::atomic<uint64_t>& counter, uint64_t by = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+}
+
+inline void set(std::atomic<uint64_t>& gauge, size_t value) {
+    gauge.store(value, std::memory_order_relaxed);
+}
+
+} // namespace
+
+OrderBook::OrderBook(const BookCapacity& capacity)
+    : order_pool_(BookCapacity::blocks(capacity.orders)),
+      price_level_pool_(BookCapacity::blocks(capacity.price_levels)),
+      recent_next_(0), cumulative_volume_(0.0), cumulative_pq_(0.0), next_order_id_(1),
+      expiries_(0, BookCapacity::blocks(capacity.expiries)), day_end_ns_(UINT64_MAX),
+      max_recent_trades_(std::max<size_t>(capacity.recent_trades, 1)),
+      depth_levels_(capacity.depth_levels), version_(0), track_latency_(false) {
+    orders_.reserve(capacity.orders);
+    recent_trade_prices_.reserve(max_recent_trades_);
+    recent_trade_quantities_.reserve(max_recent_trades_);
 }
 
 OrderBook::~OrderBook() {
@@ -40,6 +57,7 @@ PriceLevel* OrderBook::get_or_create_level(Price price, Side side) {
         }
         PriceLevel* level = price_level_pool_.allocate(price);
         bid_levels_[price] = level;
+        set(counters_.bid_levels, bid_levels_.size());
         return level;
     } else {
         auto it = ask_levels_.find(price);
@@ -48,6 +66,7 @@ PriceLevel* OrderBook::get_or_create_level(Price price, Side side) {
         }
         PriceLevel* level = price_level_pool_.allocate(price);
         ask_levels_[price] = level;
+        set(counters_.ask_levels, ask_levels_.size());
         return level;
     }
 }
@@ -58,12 +77,14 @@ void OrderBook::remove_level_if_empty(Price price, Side side) {
         if (it != bid_levels_.end() && it->second->is_empty()) {
             price_level_pool_.deallocate(it->second);
             bid_levels_.erase(it);
+            set(counters_.bid_levels, bid_levels_.size());
         }
     } else {
         auto it = ask_levels_.find(price);
         if (it != ask_levels_.end() && it->second->is_empty()) {
             price_level_pool_.deallocate(it->second);
             ask_levels_.erase(it);
+            set(counters_.ask_levels, ask_levels_.size());
         }
     }
 }
@@ -76,15 +97,19 @@ void OrderBook::execute_trade(Order* passive_order, Order* aggressive_order, Qua
     
     if (passive_order->is_fully_filled()) {
         passive_order->status = OrderStatus::FILLED;
+        bump(counters_.orders_matched);
     } else {
         passive_order->status = OrderStatus::PARTIALLY_FILLED;
     }
     
     if (aggressive_order->is_fully_filled()) {
         aggressive_order->status = OrderStatus::FILLED;
+        bump(counters_.orders_matched);
     } else {
         aggressive_order->status = OrderStatus::PARTIALLY_FILLED;
     }
+    bump(counters_.trades);
+    bump(counters_.traded_quantity, quantity);
     
     // Update price level quantities
     PriceLevel* level = get_or_create_level(passive_order->price, passive_order->side);
@@ -110,10 +135,21 @@ void OrderBook::execute_trade(Order* passive_order, Order* aggressive_order, Qua
     if (passive_order->is_fully_filled()) {
         level->remove_order(passive_order);
         remove_level_if_empty(passive_order->price, passive_order->side);
+        erase_order(passive_order);
+    }
+}
+
+void OrderBook::erase_order(Order* order) {
+    if (order->expiry) {
+        expiries_.cancel(order->expiry);
     }
+    orders_.erase(order->id);
+    order_pool_.deallocate(order);
+    set(counters_.resting_orders, orders_.size());
 }
 
 void OrderBook::match_order(Order* incoming_order) {
+    OB_TRACE_SCOPE("book.match");
     if (incoming_order->side == Side::BUY) {
         // Match against asks
         while (!incoming_order->is_fully_filled() && !ask_levels_.empty()) {
@@ -179,10 +215,30 @@ void OrderBook::match_order(Order* incoming_order) {
     }
 }
 
-OrderId OrderBook::add_order(Price price, Quantity quantity, Side side, OrderType type) {
-    OrderId id = next_order_id.fetch_add(1);
+OrderId OrderBook::add_order(Price price, Quantity quantity, Side side, OrderType type,
+                             TimeInForce tif, uint64_t expire_at_ns) {
+    ScopedLatency timer(add_latency_, track_latency_);
+    OB_TRACE_SCOPE("book.add");
+    return insert_order(price, quantity, side, type, tif, expire_at_ns);
+}
+
+OrderId OrderBook::insert_order(Price price, Quantity quantity, Side side, OrderType type,
+                                TimeInForce tif, uint64_t expire_at_ns) {
+    OrderId id = next_order_id_++;
     Order* order = order_pool_.allocate(id, price, quantity, side, type);
+    order->tif = tif;
     orders_[id] = order;
+    bump(counters_.orders_added);
+    set(counters_.resting_orders, orders_.size());
+    
+    // A deadline that has already passed never reaches the book; the
+    // rejection is still reported like any other order update
+    if (tif == TimeInForce::GTD && expire_at_ns <= expiries_.now()) {
+        order->status = OrderStatus::REJECTED;
+        notify_order_update(*order);
+        erase_order(order);
+        return id;
+    }
     
     // Market orders always match
     if (type == OrderType::MARKET) {
@@ -202,14 +258,17 @@ OrderId OrderBook::add_order(Price price, Quantity quantity, Side side, OrderTyp
         order->status != OrderStatus::CANCELLED && 
         order->status != OrderStatus::REJECTED &&
         type == OrderType::LIMIT) {
-        
+            
         PriceLevel* level = get_or_create_level(price, side);
         level->add_order(order);
+        if (tif != TimeInForce::GTC) {
+            order->expiry = expiries_.schedule(tif == TimeInForce::DAY ? day_end_ns_ : expire_at_ns, order);
+        }
         notify_order_update(*order);
-    } else if (order->status == OrderStatus::CANCELLED || order->status == OrderStatus::REJECTED) {
-        // Remove rejected/cancelled orders
-        orders_.erase(id);
-        order_pool_.deallocate(order);
+    } else {
+        // Filled, cancelled, rejected or an unmatched market/IOC remainder:
+        // nothing rests, so the order is done
+        erase_order(order);
     }
     
     // Notify state update for RL
@@ -221,6 +280,12 @@ OrderId OrderBook::add_order(Price price, Quantity quantity, Side side, OrderTyp
 }
 
 bool OrderBook::cancel_order(OrderId order_id) {
+    ScopedLatency timer(cancel_latency_, track_latency_);
+    OB_TRACE_SCOPE("book.cancel");
+    return remove_order(order_id);
+}
+
+bool OrderBook::remove_order(OrderId order_id) {
     auto it = orders_.find(order_id);
     if (it == orders_.end()) {
         return false;
@@ -237,14 +302,76 @@ bool OrderBook::cancel_order(OrderId order_id) {
     
     order->status = OrderStatus::CANCELLED;
     notify_order_update(*order);
+    bump(counters_.orders_cancelled);
     
-    orders_.erase(it);
-    order_pool_.deallocate(order);
+    erase_order(order);
+    
+    return true;
+}
+
+OrderId OrderBook::add_order_for(Price price, Quantity quantity, Side side, std::chrono::nanoseconds lifetime) {
+    uint64_t ttl = lifetime.count() > 0 ? static_cast<uint64_t>(lifetime.count()) : 0;
+    return add_order(price, quantity, side, OrderType::LIMIT, TimeInForce::GTD, expiries_.now() + ttl);
+}
+
+size_t OrderBook::advance_time(uint64_t now_ns) {
+    // A resting order's timer is cancelled whenever the order leaves the
+    // book, so every timer that fires still points at a live order
+    size_t expired = expiries_.advance(now_ns, [this](Order* order, uint64_t) {
+        // The wheel has already released this timer
+        order->expiry = nullptr;
+        
+        PriceLevel* level = get_or_create_level(order->price, order->side);
+        level->remove_order(order);
+        remove_level_if_empty(order->price, order->side);
+        
+        order->status = OrderStatus::EXPIRED;
+        notify_order_update(*order);
+        bump(counters_.orders_expired);
+        erase_order(order);
+    });
+    
+    // One state update for the whole batch
+    if (expired > 0) {
+        for (auto& callback : state_callbacks_) {
+            callback(get_market_state());
+        }
+    }
+    
+    return expired;
+}
+
+bool OrderBook::reduce_order(OrderId order_id, Quantity new_remaining) {
+    auto it = orders_.find(order_id);
+    if (it == orders_.end()) {
+        return false;
+    }
+    
+    Order* order = it->second;
+    Quantity old_remaining = order->remaining_quantity();
+    if (new_remaining >= old_remaining) {
+        return false;
+    }
+    if (new_remaining == 0) {
+        return cancel_order(order_id);
+    }
+    
+    // Shrinking in place keeps the order's place in the queue
+    Quantity removed = old_remaining - new_remaining;
+    order->quantity -= removed;
+    PriceLevel* level = get_or_create_level(order->price, order->side);
+    level->update_quantity(order, old_remaining);
+    for (auto& callback : reduce_callbacks_) {
+        callback(*order, removed);
+    }
+    notify_order_update(*order);
     
     return true;
 }
 
 bool OrderBook::modify_order(OrderId order_id, Price new_price, Quantity new_quantity) {
+    ScopedLatency timer(modify_latency_, track_latency_);
+    OB_TRACE_SCOPE("book.modify");
     // Cancel and replace strategy for simplicity
     auto it = orders_.find(order_id);
     if (it == orders_.end()) {
@@ -254,9 +381,11 @@ bool OrderBook::modify_order(OrderId order_id, Price new_price, Quantity new_qua
     Order* old_order = it->second;
     Side side = old_order->side;
     OrderType type = old_order->type;
+    TimeInForce tif = old_order->tif;
+    uint64_t expire_at_ns = old_order->expiry ? old_order->expiry->deadline : 0;
     
-    cancel_order(order_id);
-    add_order(new_price, new_quantity, side, type);
+    remove_order(order_id);
+    insert_order(new_price, new_quantity, side, type, tif, expire_at_ns);
     
     return true;
 }
@@ -335,29 +464,17 @@ MarketState OrderBook::get_market_state() const {
         state.mid_price = 0.0;
     }
     
-    // Bid depth
-    state.bid_quantity = 0;
-    size_t count = 0;
-    for (const auto& [price, level] : bid_levels_) {
-        if (count >= DEPTH_LEVELS) break;
-        state.bid_levels.emplace_back(price, level->total_quantity);
-        if (count == 0) {
-            state.bid_quantity = level->total_quantity;
-        }
-        ++count;
-    }
-    
-    // Ask depth
-    state.ask_quantity = 0;
-    count = 0;
-    for (const auto& [price, level] : ask_levels_) {
-        if (count >= DEPTH_LEVELS) break;
-        state.ask_levels.emplace_back(price, level->total_quantity);
-        if (count == 0) {
-            state.ask_quantity = level->total_quantity;
-        }
-        ++count;
-    }
+    // Depth
+    state.bid_levels.reserve(depth_levels_);
+    state.ask_levels.reserve(depth_levels_);
+    for_each_level(Side::BUY, depth_levels_, [&state](const PriceLevel& level) {
+        state.bid_levels.emplace_back(level.price, level.total_quantity);
+    });
+    for_each_level(Side::SELL, depth_levels_, [&state](const PriceLevel& level) {
+        state.ask_levels.emplace_back(level.price, level.total_quantity);
+    });
+    state.bid_quantity = state.bid_levels.empty() ? 0 : state.bid_levels.front().second;
+    state.ask_quantity = state.ask_levels.empty() ? 0 : state.ask_levels.front().second;
     
     // Order flow imbalance
     if (state.bid_quantity + state.ask_quantity > 0) {
@@ -370,8 +487,9 @@ MarketState OrderBook::get_market_state() const {
     
     // Recent trade info
     if (!recent_trade_prices_.empty()) {
-        state.last_trade_price = recent_trade_prices_.back();
-        state.last_trade_quantity = recent_trade_quantities_.back();
+        size_t last = (recent_next_ + max_recent_trades_ - 1) % max_recent_trades_;
+        state.last_trade_price = recent_trade_prices_[last];
+        state.last_trade_quantity = recent_trade_quantities_[last];
     } else {
         state.last_trade_price = 0;
         state.last_trade_quantity = 0;
@@ -403,13 +521,15 @@ MarketState OrderBook::get_market_state() const {
 }
 
 void OrderBook::update_market_statistics(const Trade& trade) {
-    recent_trade_prices_.push_back(trade.price);
-    recent_trade_quantities_.push_back(trade.quantity);
-    
-    if (recent_trade_prices_.size() > MAX_RECENT_TRADES) {
-        recent_trade_prices_.erase(recent_trade_prices_.begin());
-        recent_trade_quantities_.erase(recent_trade_quantities_.begin());
+    // Fill the reserved rings, then overwrite the oldest trade
+    if (recent_trade_prices_.size() < max_recent_trades_) {
+        recent_trade_prices_.push_back(trade.price);
+        recent_trade_quantities_.push_back(trade.quantity);
+    } else {
+        recent_trade_prices_[recent_next_] = trade.price;
+        recent_trade_quantities_[recent_next_] = trade.quantity;
     }
+    recent_next_ = (recent_next_ + 1) % max_recent_trades_;
     
     cumulative_volume_ += trade.quantity;
     cumulative_pq_ += trade.price * trade.quantity;
@@ -422,6 +542,7 @@ void OrderBook::notify_trade(const Trade& trade) {
 }
 
 void OrderBook::notify_order_update(const Order& order) {
+    ++version_;
     for (auto& callback : order_callbacks_) {
         callback(order);
     }
@@ -435,35 +556,55 @@ void OrderBook::register_order_callback(OrderUpdateCallback callback) {
     order_callbacks_.push_back(std::move(callback));
 }
 
+void OrderBook::register_reduce_callback(OrderReduceCallback callback) {
+    reduce_callbacks_.push_back(std::move(callback));
+}
+
 void OrderBook::register_state_callback(MarketStateCallback callback) {
     state_callbacks_.push_back(std::move(callback));
 }
 
+BookDiagnostics OrderBook::get_diagnostics() const {
+    BookDiagnostics diag;
+    diag.orders_in_use = order_pool_.in_use();
+    diag.orders_high_water = order_pool_.high_water();
+    diag.orders_capacity = order_pool_.capacity();
+    diag.levels_in_use = price_level_pool_.in_use();
+    diag.levels_high_water = price_level_pool_.high_water();
+    diag.levels_capacity = price_level_pool_.capacity();
+    diag.bid_levels = bid_levels_.size();
+    diag.ask_levels = ask_levels_.size();
+    diag.index_buckets = orders_.bucket_count();
+    diag.index_load_factor = orders_.load_factor();
+    diag.add_latency = add_latency_.snapshot();
+    diag.cancel_latency = cancel_latency_.snapshot();
+    diag.modify_latency = modify_latency_.snapshot();
+    return diag;
+}
+
 void OrderBook::print_book(size_t depth) const {
     std::cout << "\n=== Order Book ===" << std::endl;
     std::cout << std::fixed << std::setprecision(2);
     
     std::cout << "\nAsks:" << std::endl;
     std::vector<std::pair<Price, Quantity>> asks;
-    for (const auto& [price, level] : ask_levels_) {
-        asks.emplace_back(price, level->total_quantity);
-        if (asks.size() >= depth) break;
-    }
-    std::reverse(asks.begin(), asks.end());
-    for (const auto& [price, qty] : asks) {
-        std::cout << "  " << std::setw(10) << price / 100.0 
-                  << " | " << std::setw(10) << qty << std::endl;
+    asks.reserve(depth);
+    for_each_level(Side::SELL, depth, [&asks](const PriceLevel& level) {
+        asks.emplace_back(level.price, level.total_quantity);
+    });
+    // Highest ask on top, down to the best ask next to the spread
+    for (auto it = asks.rbegin(); it != asks.rend(); ++it) {
+        std::cout << "  " << std::setw(10) << it->first / 100.0 
+                  << " | " << std::setw(10) << it->second << std::endl;
     }
     
     std::cout << "  " << std::string(23, '-') << std::endl;
     
     std::cout << "Bids:" << std::endl;
-    size_t count = 0;
-    for (const auto& [price, level] : bid_levels_) {
-        std::cout << "  " << std::setw(10) << price / 100.0 
-                  << " | " << std::setw(10) << level->total_quantity << std::endl;
-        if (++count >= depth) break;
-    }
+    for_each_level(Side::BUY, depth, [](const PriceLevel& level) {
+        std::cout << "  " << std::setw(10) << level.price / 100.0 
+                  << " | " << std::setw(10) << level.total_quantity << std::endl;
+    });
     
     auto spread = get_spread();
     auto mid = get_mid_price();
@@ -3,11 +3,15 @@
 #include "order.hpp"
 #include "price_level.hpp"
 #include "memory_pool.hpp"
+#include "timer_wheel.hpp"
+#include "latency_histogram.hpp"
+#include <atomic>
 #include <map>
 #include <unordered_map>
 #include <vector>
 #include <functional>
 #include <optional>
+#include <chrono>
 #include <cmath>
 
 namespace orderbook {
@@ -45,9 +49,56 @@ struct MarketState {
     Timestamp timestamp;
 };
 
+// Preallocated capacities of a book
+// Pools are reserved up front (in blocks of 4096) and the order index is
+// sized for `orders`, so nothing grows on the hot path until a capacity is
+// exceeded. Defaults match the book's historical fixed sizes.
+struct BookCapacity {
+    size_t orders = 40960;         // Order pool and order index
+    size_t price_levels = 40960;   // Price level pool
+    size_t expiries = 4096;        // DAY/GTD deadlines in the timer wheel
+    size_t recent_trades = 100;    // Trades kept for last price and volatility
+    size_t depth_levels = 10;      // Levels per side in MarketState
+    
+    static constexpr size_t POOL_BLOCK = 4096;
+    static size_t blocks(size_t count) { return (count + POOL_BLOCK - 1) / POOL_BLOCK; }
+};
+
+// Internals of a book for diagnostics panels and metrics
+struct BookDiagnostics {
+    size_t orders_in_use;          // Order pool
+    size_t orders_high_water;
+    size_t orders_capacity;
+    size_t levels_in_use;          // Price level pool
+    size_t levels_high_water;
+    size_t levels_capacity;
+    size_t bid_levels;
+    size_t ask_levels;
+    size_t index_buckets;          // Order index (id -> order)
+    double index_load_factor;
+    LatencySnapshot add_latency;   // Includes matching
+    LatencySnapshot cancel_latency;
+    LatencySnapshot modify_latency;  // Includes its cancel and add
+};
+
+// Running totals and sizes of a book, written only by the thread that drives
+// it and readable from any thread without locks (metrics scrapes)
+struct BookCounters {
+    std::atomic<uint64_t> orders_added{0};
+    std::atomic<uint64_t> orders_cancelled{0};
+    std::atomic<uint64_t> orders_expired{0};
+    std::atomic<uint64_t> orders_matched{0};     // Fully filled
+    std::atomic<uint64_t> trades{0};
+    std::atomic<uint64_t> traded_quantity{0};
+    std::atomic<uint64_t> resting_orders{0};
+    std::atomic<uint64_t> bid_levels{0};
+    std::atomic<uint64_t> ask_levels{0};
+};
+
 // Callbacks for RL agent and monitoring
 using TradeCallback = std::function<void(const Trade&)>;
 using OrderUpdateCallback = std::function<void(const Order&)>;
+using OrderReduceCallback = std::function<void(const Order&, Quantity)>;  // Order, quantity removed
 using MarketStateCallback = std::function<void(const MarketState&)>;
 
 class OrderBook {
@@ -66,16 +117,38 @@ private:
     // Callbacks
     std::vector<TradeCallback> trade_callbacks_;
     std::vector<OrderUpdateCallback> order_callbacks_;
+    std::vector<OrderReduceCallback> reduce_callbacks_;
     std::vector<MarketStateCallback> state_callbacks_;
     
-    // Statistics for RL state
+    // Statistics for RL state (rings of the last max_recent_trades_ trades)
     std::vector<Price> recent_trade_prices_;
     std::vector<Quantity> recent_trade_quantities_;
+    size_t recent_next_;
     double cumulative_volume_;
     double cumulative_pq_;  // Price * Quantity for VWAP
     
-    static constexpr size_t MAX_RECENT_TRADES = 100;
-    static constexpr size_t DEPTH_LEVELS = 10;
+    // Order ids are per book so independent books (sweeps, backtests) never contend
+    OrderId next_order_id_;
+    
+    // Expiry deadlines of DAY/GTD orders, in the book's clock (ns). The wheel
+    // makes adding and removing a deadline O(1); advance_time() fires them.
+    TimerWheel<Order*> expiries_;
+    uint64_t day_end_ns_;
+    
+    // Capacities fixed at construction
+    const size_t max_recent_trades_;
+    const size_t depth_levels_;
+    
+    // Bumped on every change to resting orders
+    uint64_t version_;
+    
+    BookCounters counters_;
+    
+    // Wall time of each public operation, recorded only while tracking is on
+    bool track_latency_;
+    LatencyHistogram add_latency_;
+    LatencyHistogram cancel_latency_;
+    LatencyHistogram modify_latency_;
     
     // Helper methods
     PriceLevel* get_or_create_level(Price price, Side side);
@@ -85,17 +158,53 @@ private:
     void notify_trade(const Trade& trade);
     void notify_order_update(const Order& order);
     void update_market_statistics(const Trade& trade);
+    void erase_order(Order* order);
+    // add_order/cancel_order without timing, so modify_order is timed once
+    OrderId insert_order(Price price, Quantity quantity, Side side, OrderType type,
+                         TimeInForce tif, uint64_t expire_at_ns);
+    bool remove_order(OrderId order_id);
+    
+    template<typename Levels, typename Fn>
+    static size_t visit_levels(const Levels& levels, size_t max_levels, Fn& fn) {
+        size_t visited = 0;
+        for (auto it = levels.begin(); it != levels.end() && visited < max_levels; ++it, ++visited) {
+            fn(static_cast<const PriceLevel&>(*it->second));
+        }
+        return visited;
+    }
     
 public:
-    OrderBook();
+    explicit OrderBook(const BookCapacity& capacity = BookCapacity());
     ~OrderBook();
     
     // Order management
-    OrderId add_order(Price price, Quantity quantity, Side side, OrderType type = OrderType::LIMIT);
+    // DAY orders expire at the day end, GTD orders at expire_at_ns (a GTD
+    // deadline that has already passed is rejected). Only resting limit
+    // orders carry a deadline.
+    OrderId add_order(Price price, Quantity quantity, Side side, OrderType type = OrderType::LIMIT,
+                      TimeInForce tif = TimeInForce::GTC, uint64_t expire_at_ns = 0);
+    // Good-for-N: a GTD limit order that lives `lifetime` from the book's clock
+    OrderId add_order_for(Price price, Quantity quantity, Side side, std::chrono::nanoseconds lifetime);
     bool cancel_order(OrderId order_id);
+    // Lower a resting order's open quantity without losing queue priority;
+    // false if the order is gone or new_remaining is not smaller. Reduce
+    // callbacks get the amount removed, then order callbacks the update.
+    bool reduce_order(OrderId order_id, Quantity new_remaining);
     bool modify_order(OrderId order_id, Price new_price, Quantity new_quantity);
     std::optional<Order> get_order(OrderId order_id) const;
     
+    // Time in force
+    // The book's clock only moves through advance_time(): feed it wall-clock
+    // ns in a live session, simulated ns in a simulation. Every order whose
+    // deadline is <= now_ns is cancelled with status EXPIRED, in deadline
+    // order; returns how many expired.
+    size_t advance_time(uint64_t now_ns);
+    uint64_t now_ns() const { return expiries_.now(); }
+    // Deadline for DAY orders entered from now on (default: never)
+    void set_day_end(uint64_t day_end_ns) { day_end_ns_ = day_end_ns; }
+    uint64_t get_day_end() const { return day_end_ns_; }
+    size_t get_expiring_count() const { return expiries_.size(); }
+    
     // Market data queries
     std::optional<Price> get_best_bid() const;
     std::optional<Price> get_best_ask() const;
@@ -103,18 +212,45 @@ public:
     std::optional<Price> get_spread() const;
     Quantity get_volume_at_price(Price price, Side side) const;
     
+    // Depth visitor: calls fn(const PriceLevel&) for up to max_levels levels
+    // of one side, best price first, straight off the level map (no copies,
+    // no per-tick lookups, empty ticks skipped). Returns the levels visited.
+    // fn must not modify the book.
+    template<typename Fn>
+    size_t for_each_level(Side side, size_t max_levels, Fn&& fn) const {
+        return side == Side::BUY ? visit_levels(bid_levels_, max_levels, fn)
+                                 : visit_levels(ask_levels_, max_levels, fn);
+    }
+    
     // RL interface - get current market state
     MarketState get_market_state() const;
     
     // Register callbacks for RL agent
     void register_trade_callback(TradeCallback callback);
     void register_order_callback(OrderUpdateCallback callback);
+    void register_reduce_callback(OrderReduceCallback callback);
     void register_state_callback(MarketStateCallback callback);
     
-    // Statistics
+    // Statistics (filled and cancelled orders leave the index)
     size_t get_order_count() const { return orders_.size(); }
     size_t get_bid_level_count() const { return bid_levels_.size(); }
     size_t get_ask_level_count() const { return ask_levels_.size(); }
+    // Changes whenever the book does; cheap to poll for redraws and snapshots
+    uint64_t get_version() const { return version_; }
+    
+    // Pool occupancy, level counts, index load and operation latencies
+    BookDiagnostics get_diagnostics() const;
+    // Time add/cancel/modify into the latency histograms (off by default:
+    // two clock reads and a few atomic adds per operation)
+    void set_latency_tracking(bool enabled) { track_latency_ = enabled; }
+    bool latency_tracking() const { return track_latency_; }
+    const LatencyHistogram& add_latency() const { return add_latency_; }
+    const LatencyHistogram& cancel_latency() const { return cancel_latency_; }
+    const LatencyHistogram& modify_latency() const { return modify_latency_; }
+    const BookCounters& counters() const { return counters_; }
+    // Pools, for lock-free occupancy reads
+    const MemoryPool<Order>& order_pool() const { return order_pool_; }
+    const MemoryPool<PriceLevel>& price_level_pool() const { return price_level_pool_; }
     
     // For debugging/visualization
     void print_book(size_t depth = 10) const;
@@ -0,0 +1,193 @@
+#pragma once
+
+#include "latency_histogram.hpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <algorithm>
+#include <cstdint>
+
+namespace OrderBookNS {
+
+struct CircuitBreakerConfig {
+    int failure_threshold = 3;          // Consecutive failures that open the circuit
+    double error_rate_threshold = 0.5;  // ...or an error-rate EWMA above this
+    uint32_t min_samples = 10;          // once this many results have been seen
+    double ewma_alpha = 0.2;            // Weight of the newest sample
+    std::chrono::milliseconds open_duration{2000};       // First wait before a probe
+    std::chrono::milliseconds max_open_duration{60000};  // Backoff cap for failed probes
+    double prior_latency_ms = 250.0;    // Assumed latency until the first success
+};
+
+// Per-provider health and circuit breaker
+// Tracks a latency EWMA over successful calls and an error-rate EWMA over all
+// calls. CLOSED providers take traffic. Repeated failures OPEN the circuit and
+// the provider is skipped. Once the open duration has passed, one background
+// probe runs (HALF_OPEN). If it succeeds the circuit closes; if it fails the
+// circuit reopens with double the wait.
+// The request counters, the latency histogram and the state can also be read
+// without the lock (state(), successes(), failures(), latency()), so a
+// metrics scrape never waits on the feed.
+class ProviderHealth {
+public:
+    using Clock = std::chrono::steady_clock;
+    
+    enum class State : uint8_t {
+        CLOSED = 0,
+        OPEN = 1,
+        HALF_OPEN = 2
+    };
+    
+    struct Snapshot {
+        State state;
+        double latency_ms;      // EWMA over successes, raised by slow losers
+        double error_rate;      // EWMA of failures, 0..1
+        int consecutive_failures;
+        uint64_t successes;
+        uint64_t failures;
+    };
+    
+    explicit ProviderHealth(const CircuitBreakerConfig& config = CircuitBreakerConfig())
+        : config_(config), state_(State::CLOSED), latency_ms_(0.0), error_rate_(0.0),
+          consecutive_failures_(0), successes_(0), failures_(0),
+          open_duration_(config.open_duration) {}
+    
+    void record_success(double latency_ms) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        latency_ms_ = successes() == 0 ? latency_ms : ewma(latency_ms_, latency_ms);
+        error_rate_ = ewma(error_rate_, 0.0);
+        consecutive_failures_ = 0;
+        count(successes_);
+        record_latency(latency_ms);
+    }
+    
+    // A request cancelled unanswered after latency_ms (a hedging loser): the
+    // provider was at least that slow, so the estimate can only rise. Neither
+    // a success nor a failure is counted.
+    void record_slow(double latency_ms) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (latency_ms <= latency_ms_) return;
+        latency_ms_ = successes() == 0 ? latency_ms : ewma(latency_ms_, latency_ms);
+    }
+    
+    // Returns true when this failure opened the circuit
+    bool record_failure() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        error_rate_ = ewma(error_rate_, 1.0);
+        ++consecutive_failures_;
+        count(failures_);
+        
+        bool tripped = consecutive_failures_ >= config_.failure_threshold ||
+                       (successes() + failures() >= config_.min_samples &&
+                        error_rate_ > config_.error_rate_threshold);
+        if (state_ == State::CLOSED && tripped) {
+            state_ = State::OPEN;
+            opened_at_ = Clock::now();
+            return true;
+        }
+        return false;
+    }
+    
+    // Whether regular traffic may use this provider
+    bool available() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return state_ == State::CLOSED;
+    }
+    
+    // Claim the probe slot of an open circuit whose wait has passed
+    bool begin_probe() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (state_ != State::OPEN || Clock::now() - opened_at_ < open_duration_) {
+            return false;
+        }
+        state_ = State::HALF_OPEN;
+        return true;
+    }
+    
+    // Probe outcome: close on success, reopen with backoff on failure
+    void end_probe(bool ok, double latency_ms) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (state_ != State::HALF_OPEN) return;
+        
+        if (ok) {
+            state_ = State::CLOSED;
+            consecutive_failures_ = 0;
+            error_rate_ = 0.0;
+            latency_ms_ = latency_ms;
+            open_duration_ = config_.open_duration;
+            count(successes_);
+            record_latency(latency_ms);
+        } else {
+            state_ = State::OPEN;
+            opened_at_ = Clock::now();
+            open_duration_ = std::min(open_duration_ * 2, config_.max_open_duration);
+            count(failures_);
+        }
+    }
+    
+    // Give the probe slot back without a verdict (e.g. out of rate budget)
+    void abandon_probe() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (state_ == State::HALF_OPEN) {
+            state_ = State::OPEN;
+        }
+    }
+    
+    // Lower is better: expected latency inflated by the error rate. A provider
+    // with no successes yet is assumed to take prior_latency_ms (or longer, if
+    // it has lost hedges after that), so it ranks behind providers measured
+    // faster than that and ahead of slower ones.
+    double score() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        double latency = successes() == 0 ? std::max(config_.prior_latency_ms, latency_ms_) : latency_ms_;
+        return latency * (1.0 + 4.0 * error_rate_);
+    }
+    
+    Snapshot snapshot() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return {state(), latency_ms_, error_rate_, consecutive_failures_, successes(), failures()};
+    }
+    
+    // Lock-free reads
+    State state() const { return state_.load(std::memory_order_relaxed); }
+    uint64_t successes() const { return successes_.load(std::memory_order_relaxed); }
+    uint64_t failures() const { return failures_.load(std::memory_order_relaxed); }
+    // Latency of successful requests
+    const orderbook::LatencyHistogram& latency() const { return latency_; }
+    
+    static const char* state_name(State state) {
+        switch (state) {
+            case State::CLOSED: return "closed";
+            case State::OPEN: return "open";
+            case State::HALF_OPEN: return "half-open";
+        }
+        return "unknown";
+    }
+    
+private:
+    mutable std::mutex mutex_;
+    CircuitBreakerConfig config_;
+    std::atomic<State> state_;
+    double latency_ms_;
+    double error_rate_;
+    int consecutive_failures_;
+    std::atomic<uint64_t> successes_;   // Written under the lock
+    std::atomic<uint64_t> failures_;
+    orderbook::LatencyHistogram latency_;
+    Clock::time_point opened_at_;
+    std::chrono::milliseconds open_duration_;
+    
+    double ewma(double current, double sample) const {
+        return current + config_.ewma_alpha * (sample - current);
+    }
+    
+    static void count(std::atomic<uint64_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    
+    void record_latency(double latency_ms) {
+        latency_.record(latency_ms > 0.0 ? static_cast<uint64_t>(latency_ms * 1e6) : 0);
+    }
+};
+
+} // namespace OrderBookNS
@@ -0,0 +1,123 @@
+#include "quote_reconciler.hpp"
+#include <algorithm>
+
+namespace OrderBookNS {
+
+using orderbook::OrderId;
+using orderbook::Price;
+using orderbook::Quantity;
+using orderbook::Side;
+
+namespace {
+
+size_t side_index(Side side) {
+    return side == Side::BUY ? 0 : 1;
+}
+
+} // namespace
+
+QuoteReconciler::QuoteReconciler(orderbook::OrderBook& book, LadderConfig config)
+    : book_(book), config_(config) {
+    config_.levels = std::max<size_t>(config_.levels, 1);
+    config_.tick = std::max<Price>(config_.tick, 1);
+    config_.size = std::max<Quantity>(config_.size, 1);
+    config_.max_size = std::max<Quantity>(config_.max_size, 1);
+    for (size_t s = 0; s < 2; ++s) {
+        owned_[s].reserve(config_.levels);
+        missing_[s].resize(config_.levels);
+    }
+}
+
+QuoteReconciler::Batch QuoteReconciler::reconcile(const Quote& quote) {
+    Batch batch;
+    if (quote.bid_price <= 0 || quote.ask_price <= 0 || quote.bid_price >= quote.ask_price) {
+        return batch;
+    }
+    
+    auto level_size = [this](Quantity quoted) {
+        if (!config_.quote_sized || quoted == 0) return config_.size;
+        return std::min(quoted, config_.max_size);
+    };
+    
+    // Cancels and reductions on both sides before any add
+    diff_side(Side::BUY, quote.bid_price, level_size(quote.bid_size), batch);
+    diff_side(Side::SELL, quote.ask_price, level_size(quote.ask_size), batch);
+    add_side(Side::BUY, quote.bid_price, batch);
+    add_side(Side::SELL, quote.ask_price, batch);
+    
+    totals_.adds += batch.adds;
+    totals_.cancels += batch.cancels;
+    totals_.amends += batch.amends;
+    return batch;
+}
+
+void QuoteReconciler::diff_side(Side side, Price top, Quantity size, Batch& batch) {
+    auto& owned = owned_[side_index(side)];
+    auto& missing = missing_[side_index(side)];
+    std::fill(missing.begin(), missing.end(), size);
+    
+    size_t kept = 0;
+    for (const OwnedOrder& own : owned) {
+        auto order = book_.get_order(own.id);
+        if (!order) {
+            continue;  // Filled (or cancelled by someone else)
+        }
+        
+        // Target level of this price, if it is still on the ladder
+        Price offset = side == Side::BUY ? top - own.price : own.price - top;
+        size_t level = offset >= 0 && offset % config_.tick == 0
+            ? static_cast<size_t>(offset / config_.tick) : config_.levels;
+        if (level >= config_.levels || missing[level] != size) {
+            book_.cancel_order(own.id);
+            ++batch.cancels;
+            continue;
+        }
+        
+        Quantity remaining = order->remaining_quantity();
+        if (remaining > size) {
+            book_.reduce_order(own.id, size);
+            ++batch.amends;
+        } else if (remaining < size) {
+            // Topping up would lose priority anyway: replace at full size
+            book_.cancel_order(own.id);
+            ++batch.cancels;
+            continue;
+        }
+        missing[level] = 0;
+        owned[kept++] = own;
+    }
+    owned.resize(kept);
+}
+
+void QuoteReconciler::add_side(Side side, Price top, Batch& batch) {
+    auto& owned = owned_[side_index(side)];
+    auto& missing = missing_[side_index(side)];
+    
+    for (size_t level = 0; level < config_.levels; ++level) {
+        if (missing[level] == 0) continue;
+        Price step = static_cast<Price>(level) * config_.tick;
+        Price price = side == Side::BUY ? top - step : top + step;
+        if (price <= 0) break;
+        
+        OrderId id = book_.add_order(price, missing[level], side, orderbook::OrderType::LIMIT);
+        // A crossing add may fill on arrival; only what rests is ours to track
+        if (book_.get_order(id)) {
+            owned.push_back({price, id});
+        }
+        ++batch.adds;
+    }
+}
+
+size_t QuoteReconciler::clear() {
+    size_t cancelled = 0;
+    for (auto& owned : owned_) {
+        for (const OwnedOrder& own : owned) {
+            cancelled += book_.cancel_order(own.id) ? 1 : 0;
+        }
+        owned.clear();
+    }
+    totals_.cancels += cancelled;
+    return cancelled;
+}
+
+} // namespace OrderBookNS
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "market_data.hpp"
+#include "orderbook.hpp"
+#include <vector>
+#include <cstddef>
+
+namespace OrderBookNS {
+
+// Shape of the synthetic ladder kept around the latest quote
+struct LadderConfig {
+    size_t levels = 1;                // Levels per side, starting at the quote
+    orderbook::Price tick = 1;        // Spacing between levels, in cents
+    orderbook::Quantity size = 50;    // Size per level
+    bool quote_sized = false;         // Size levels from the quote's bid/ask size instead
+    orderbook::Quantity max_size = 100000;  // Cap on a quote-sized level
+};
+
+// Keeps a bounded synthetic ladder in a book in line with a live quote
+// Each quote defines a target ladder (levels bids down from the bid, levels
+// asks up from the ask). reconcile() diffs it against the orders this
+// reconciler owns and applies the smallest batch that gets there: orders at
+// prices that left the ladder are cancelled, orders that are too large are
+// reduced in place (keeping queue priority), orders that are too small are
+// cancelled and re-added, and missing levels are added. Cancels run first so
+// a moving quote never trades against our own stale levels. Orders the book
+// filled are noticed and dropped, so the owned set (and the levels it
+// creates) never exceeds 2 * levels however long the session runs.
+//
+// Not thread-safe: call from the thread that drives the book.
+class QuoteReconciler {
+public:
+    // Book operations one reconcile() issued; amends are in-place reductions
+    struct Batch {
+        size_t adds = 0;
+        size_t cancels = 0;
+        size_t amends = 0;
+        
+        size_t total() const { return adds + cancels + amends; }
+    };
+    
+    explicit QuoteReconciler(orderbook::OrderBook& book, LadderConfig config = {});
+    
+    // Move the ladder to `quote`; a one-sided or crossed quote leaves it as is
+    Batch reconcile(const Quote& quote);
+    
+    // Cancel every owned order
+    size_t clear();
+    
+    const LadderConfig& config() const { return config_; }
+    size_t owned() const { return owned_[0].size() + owned_[1].size(); }
+    const Batch& totals() const { return totals_; }
+
+private:
+    struct OwnedOrder {
+        orderbook::Price price;
+        orderbook::OrderId id;
+    };
+    
+    orderbook::OrderBook& book_;
+    LadderConfig config_;
+    std::vector<OwnedOrder> owned_[2];       // By side: bids, asks
+    std::vector<orderbook::Quantity> missing_[2];  // Per target level: size still to add
+    Batch totals_;
+    
+    void diff_side(orderbook::Side side, orderbook::Price top, orderbook::Quantity size, Batch& batch);
+    void add_side(orderbook::Side side, orderbook::Price top, Batch& batch);
+};
+
+} // namespace OrderBookNS
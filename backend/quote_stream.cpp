@@ -0,0 +1,241 @@
+#include "quote_stream.hpp"
+#include "json_extract.hpp"
+#include <curl/curl.h>
+#include <cstring>
+#include <algorithm>
+
+namespace OrderBookNS {
+
+QuoteStream::QuoteStream(const std::string& server_url, const std::vector<SymbolId>& symbols, Callback callback)
+    : callback_(std::move(callback)), min_backoff_(100), max_backoff_(5000), wire_format_(true),
+      multi_(nullptr), easy_(nullptr), running_(false), buffer_(BUFFER_SIZE), buffered_(0),
+      has_data_(false), data_begin_(0), data_end_(0), status_checked_(false), decoder_(false), wire_(false),
+      connected_(false), messages_(0), reconnects_(0), malformed_(0), gaps_(0) {
+    url_ = server_url + "/stream?symbols=" + SymbolTable::global().join(symbols);
+    for (SymbolId id : symbols) {
+        if (id == INVALID_SYMBOL) continue;
+        if (id >= subscribed_.size()) subscribed_.resize(id + 1, false);
+        subscribed_[id] = true;
+    }
+    current_.symbol = INVALID_SYMBOL;
+    current_.quote.symbol.reserve(16);
+    wire_handler_.stream = this;
+    
+    ensure_curl_global_init();
+    multi_ = curl_multi_init();
+    easy_ = curl_easy_init();
+}
+
+QuoteStream::~QuoteStream() {
+    stop();
+    curl_easy_cleanup(static_cast<CURL*>(easy_));
+    curl_multi_cleanup(static_cast<CURLM*>(multi_));
+}
+
+void QuoteStream::start() {
+    stop();
+    running_ = true;
+    thread_ = std::thread(&QuoteStream::run, this);
+}
+
+void QuoteStream::stop() {
+    {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        running_ = false;
+    }
+    wait_cv_.notify_all();
+    curl_multi_wakeup(static_cast<CURLM*>(multi_));
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void QuoteStream::run() {
+    // Waits stay network-driven; the role only places the thread and counts its polls
+    PollLoop loop(ThreadRole::FEED);
+    auto backoff = min_backoff_;
+    while (running_.load(std::memory_order_relaxed)) {
+        bool received = stream_once(loop);
+        connected_.store(false, std::memory_order_relaxed);
+        if (!running_.load(std::memory_order_relaxed)) break;
+        
+        // A connection that delivered quotes resets the backoff
+        if (received) {
+            backoff = min_backoff_;
+        }
+        reconnects_.fetch_add(1, std::memory_order_relaxed);
+        
+        std::unique_lock<std::mutex> lock(wait_mutex_);
+        wait_cv_.wait_for(lock, backoff, [this]() { return !running_.load(std::memory_order_relaxed); });
+        backoff = std::min(backoff * 2, max_backoff_);
+    }
+}
+
+bool QuoteStream::stream_once(PollLoop& loop) {
+    CURLM* multi = static_cast<CURLM*>(multi_);
+    CURL* easy = static_cast<CURL*>(easy_);
+    
+    buffered_ = 0;
+    has_data_ = false;
+    status_checked_ = false;
+    decoder_.reset();
+    wire_.store(false, std::memory_order_relaxed);
+    uint64_t before = messages_.load(std::memory_order_relaxed);
+    
+    curl_easy_reset(easy);
+    configure_easy_handle(easy);
+    std::string accept = wire_format_
+        ? std::string("Accept: ") + wire::CONTENT_TYPE + ", text/event-stream;q=0.5"
+        : std::string("Accept: text/event-stream");
+    curl_slist* headers = curl_slist_append(nullptr, accept.c_str());
+    curl_easy_setopt(easy, CURLOPT_URL, url_.c_str());
+    curl_easy_setopt(easy, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, &QuoteStream::write_callback);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, this);
+    curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT_MS, 3000L);
+    // No overall timeout; the server's heartbeats keep a healthy stream above this
+    curl_easy_setopt(easy, CURLOPT_LOW_SPEED_LIMIT, 1L);
+    curl_easy_setopt(easy, CURLOPT_LOW_SPEED_TIME, 30L);
+    curl_multi_add_handle(multi, easy);
+    
+    while (running_.load(std::memory_order_relaxed)) {
+        uint64_t start = loop.begin();
+        uint64_t seen = messages_.load(std::memory_order_relaxed);
+        int still_running = 0;
+        curl_multi_perform(multi, &still_running);
+        loop.record(start, messages_.load(std::memory_order_relaxed) != seen);
+        if (still_running == 0) break;
+        
+        // Sleeps until bytes arrive or stop() wakes us
+        curl_multi_poll(multi, nullptr, 0, 1000, nullptr);
+    }
+    
+    curl_multi_remove_handle(multi, easy);
+    curl_slist_free_all(headers);
+    return messages_.load(std::memory_order_relaxed) != before;
+}
+
+size_t QuoteStream::write_callback(char* data, size_t size, size_t nmemb, void* self) {
+    auto* stream = static_cast<QuoteStream*>(self);
+    size_t length = size * nmemb;
+    return stream->append(data, length) ? length : 0;  // 0 aborts the transfer
+}
+
+bool QuoteStream::append(const char* data, size_t length) {
+    if (!status_checked_) {
+        long status = 0;
+        char* content_type = nullptr;
+        curl_easy_getinfo(static_cast<CURL*>(easy_), CURLINFO_RESPONSE_CODE, &status);
+        curl_easy_getinfo(static_cast<CURL*>(easy_), CURLINFO_CONTENT_TYPE, &content_type);
+        if (status != 200) return false;
+        status_checked_ = true;
+        wire_.store(content_type && std::strncmp(content_type, wire::CONTENT_TYPE,
+                                                 std::strlen(wire::CONTENT_TYPE)) == 0,
+                    std::memory_order_relaxed);
+        connected_.store(true, std::memory_order_relaxed);
+    }
+    
+    if (wire_.load(std::memory_order_relaxed)) {
+        uint64_t gaps = decoder_.gaps();
+        bool ok = decoder_.feed(data, length, wire_handler_);
+        gaps_.fetch_add(decoder_.gaps() - gaps, std::memory_order_relaxed);
+        if (!ok) {
+            malformed_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return ok;  // A corrupt stream is dropped and reconnected
+    }
+    
+    while (length > 0) {
+        size_t room = buffer_.size() - buffered_;
+        if (room == 0) {
+            // One event outgrew the buffer: drop it and resync at the next blank line
+            malformed_.fetch_add(1, std::memory_order_relaxed);
+            buffered_ = 0;
+            has_data_ = false;
+            room = buffer_.size();
+        }
+        size_t take = std::min(room, length);
+        std::memcpy(buffer_.data() + buffered_, data, take);
+        buffered_ += take;
+        data += take;
+        length -= take;
+        consume();
+    }
+    return true;
+}
+
+void QuoteStream::consume() {
+    char* base = buffer_.data();
+    size_t line = 0;
+    while (line < buffered_) {
+        auto* newline = static_cast<char*>(std::memchr(base + line, '\n', buffered_ - line));
+        if (!newline) break;
+        size_t next = static_cast<size_t>(newline - base) + 1;
+        size_t end = next - 1;
+        if (end > line && base[end - 1] == '\r') --end;
+        
+        if (end == line) {
+            // Blank line ends the event
+            if (has_data_) {
+                dispatch(std::string_view(base + data_begin_, data_end_ - data_begin_));
+                has_data_ = false;
+            }
+        } else if (end - line >= 5 && std::memcmp(base + line, "data:", 5) == 0) {
+            size_t begin = line + 5;
+            if (begin < end && base[begin] == ' ') ++begin;
+            if (!has_data_) {
+                data_begin_ = begin;
+                data_end_ = end;
+                has_data_ = true;
+            } else {
+                // Further data lines join the event with '\n'; slide them down over
+                // the line break so the payload stays contiguous
+                base[data_end_] = '\n';
+                std::memmove(base + data_end_ + 1, base + begin, end - begin);
+                data_end_ += 1 + (end - begin);
+            }
+        }
+        // "event:", "id:", "retry:" and ":" heartbeats need no action
+        line = next;
+    }
+    
+    // Keep the unfinished line, and the pending data line if its event is still open
+    size_t keep = has_data_ ? std::min(data_begin_, line) : line;
+    if (keep > 0) {
+        std::memmove(base, base + keep, buffered_ - keep);
+        buffered_ -= keep;
+        data_begin_ -= has_data_ ? keep : 0;
+        data_end_ -= has_data_ ? keep : 0;
+    }
+}
+
+void QuoteStream::WireHandler::on_quote(const SymbolQuote& quote) {
+    if (!stream->subscribed(quote.symbol)) return;
+    stream->messages_.fetch_add(1, std::memory_order_relaxed);
+    stream->callback_(quote);
+}
+
+void QuoteStream::dispatch(std::string_view json) {
+    JsonView root = JsonView::parse(json);
+    std::string_view name = root["symbol"].as_string_view();
+    if (name.empty() || !root["bid_price"].is_number()) {
+        malformed_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    SymbolId id = SymbolTable::global().find(name);
+    if (!subscribed(id)) return;
+    
+    Quote& quote = current_.quote;
+    current_.symbol = id;
+    quote.symbol.assign(name.data(), name.size());
+    quote.bid_price = root["bid_price"].as_int64();
+    quote.ask_price = root["ask_price"].as_int64();
+    quote.bid_size = root["bid_size"].as_uint64();
+    quote.ask_size = root["ask_size"].as_uint64();
+    quote.timestamp = root["timestamp"].as_uint64() * 1000000000ULL; // Server sends epoch seconds
+    
+    messages_.fetch_add(1, std::memory_order_relaxed);
+    callback_(current_);
+}
+
+} // namespace OrderBookNS
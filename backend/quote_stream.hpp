@@ -0,0 +1,112 @@
+#pragma once
+
+#include "market_data.hpp"
+#include "wire_format.hpp"
+#include "thread_topology.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+namespace OrderBookNS {
+
+// Push-based quotes from the local quote server
+// Holds GET /stream?symbols=... open; the server sends one Server-Sent Event
+// per changed quote ("data: {quote object}" then a blank line) and comment
+// lines as heartbeats. Bytes are decoded incrementally in a fixed buffer, the
+// JSON is read in place with JsonView, and the callback receives a reused
+// SymbolQuote, so steady-state dispatch allocates nothing. If the server
+// answers the Accept header with the binary wire format instead, frames are
+// decoded straight into the same SymbolQuote. A dropped or silent connection
+// is reopened with exponential backoff. Callbacks run on the stream thread
+// and must not block.
+class QuoteStream {
+public:
+    using Callback = std::function<void(const SymbolQuote&)>;
+    
+    // symbols must already be interned; events for other symbols are ignored
+    QuoteStream(const std::string& server_url, const std::vector<SymbolId>& symbols, Callback callback);
+    ~QuoteStream();
+    
+    QuoteStream(const QuoteStream&) = delete;
+    QuoteStream& operator=(const QuoteStream&) = delete;
+    
+    // Connect on a background thread (reconnecting until stop)
+    void start();
+    
+    // Close the connection and join the thread
+    void stop();
+    
+    // Reconnect delay: starts at min, doubles per failed attempt up to max
+    // (set before start)
+    void set_reconnect_backoff(std::chrono::milliseconds min, std::chrono::milliseconds max) {
+        min_backoff_ = min;
+        max_backoff_ = max;
+    }
+    
+    // Offer the binary wire format (default) or ask for SSE only (set before start)
+    void set_wire_format(bool enabled) { wire_format_ = enabled; }
+    
+    bool connected() const { return connected_.load(std::memory_order_relaxed); }
+    uint64_t messages() const { return messages_.load(std::memory_order_relaxed); }
+    uint64_t reconnects() const { return reconnects_.load(std::memory_order_relaxed); }
+    uint64_t malformed() const { return malformed_.load(std::memory_order_relaxed); }
+    uint64_t gaps() const { return gaps_.load(std::memory_order_relaxed); }  // Wire sequence gaps
+    bool using_wire_format() const { return wire_.load(std::memory_order_relaxed); }
+    
+private:
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;  // Longest event we accept
+    
+    std::string url_;
+    std::vector<bool> subscribed_;  // By SymbolId
+    Callback callback_;
+    std::chrono::milliseconds min_backoff_;
+    std::chrono::milliseconds max_backoff_;
+    bool wire_format_;
+    
+    void* multi_;  // CURLM*
+    void* easy_;   // CURL*
+    std::thread thread_;
+    std::atomic<bool> running_;
+    std::mutex wait_mutex_;
+    std::condition_variable wait_cv_;  // Interrupts the reconnect backoff
+    
+    // Stream-thread decode state
+    std::vector<char> buffer_;
+    size_t buffered_;
+    bool has_data_;        // Current event has data (its lines joined) at [data_begin_, data_end_)
+    size_t data_begin_;
+    size_t data_end_;
+    bool status_checked_;
+    SymbolQuote current_;  // Reused for every dispatch
+    
+    // Wire-format connections bypass the SSE decoder
+    struct WireHandler : wire::Handler {
+        QuoteStream* stream;
+        void on_quote(const SymbolQuote& quote);
+    };
+    wire::Decoder decoder_;
+    WireHandler wire_handler_;
+    std::atomic<bool> wire_;
+    
+    std::atomic<bool> connected_;
+    std::atomic<uint64_t> messages_;
+    std::atomic<uint64_t> reconnects_;
+    std::atomic<uint64_t> malformed_;
+    std::atomic<uint64_t> gaps_;
+    
+    void run();
+    bool stream_once(PollLoop& loop);  // One connection; true if any event arrived
+    static size_t write_callback(char* data, size_t size, size_t nmemb, void* self);
+    bool append(const char* data, size_t length);
+    void consume();
+    void dispatch(std::string_view json);
+    bool subscribed(SymbolId id) const { return id < subscribed_.size() && subscribed_[id]; }
+};
+
+} // namespace OrderBookNS
@@ -0,0 +1,390 @@
+#include "request_scheduler.hpp"
+#include "bar_cache.hpp"
+#include <map>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+
+namespace OrderBookNS {
+
+using Clock = std::chrono::steady_clock;
+
+struct RequestScheduler::Request {
+    RequestKind kind;
+    std::string key;
+    std::string symbol;
+    std::string interval;
+    int limit = 0;                          // Bars asked of the provider
+    int wanted = 0;                         // Bars the caller asked for
+    uint64_t asked_ns = 0;                  // Wall clock when the fetch was planned
+    uint64_t seq = 0;
+    size_t next_provider = 0;               // First provider not yet tried
+    bool deferred = false;                  // Waited on a rate limit at least once
+    AsyncHTTPClient::RequestId http_id = 0;
+    std::vector<QuoteCallback> quote_waiters;
+    std::vector<OHLCVCallback> ohlcv_waiters;
+};
+
+struct RequestScheduler::Core {
+    Providers providers;
+    HealthList health;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool running = true;
+    long quote_timeout_ms = 3000;
+    long ohlcv_timeout_ms = 10000;
+    std::shared_ptr<BarCache> bar_cache;
+    uint64_t next_seq = 0;
+    
+    // Ordered by (kind, arrival): quotes first, FIFO within a kind
+    std::map<std::pair<uint8_t, uint64_t>, RequestPtr> queue;
+    std::unordered_map<std::string, RequestPtr> by_key;   // Queued or in flight
+    std::unordered_map<AsyncHTTPClient::RequestId, RequestPtr> in_flight;
+    
+    std::atomic<uint64_t> coalesced{0};
+    std::atomic<uint64_t> dispatched{0};
+    std::atomic<uint64_t> rate_limited{0};
+    
+    void push(const RequestPtr& request) {
+        queue.emplace(std::make_pair(static_cast<uint8_t>(request->kind), request->seq), request);
+    }
+    
+    bool supports(const IMarketDataProvider& provider, RequestKind kind) const {
+        return kind == RequestKind::QUOTE ? provider.supports_async_quotes()
+                                          : provider.supports_async_ohlcv();
+    }
+    
+    bool healthy(size_t index) const {
+        return index >= health.size() || health[index]->available();
+    }
+};
+
+RequestScheduler::RequestScheduler(AsyncHTTPClient& client, Providers providers, HealthList health)
+    : client_(client), core_(std::make_shared<Core>()) {
+    core_->providers = std::move(providers);
+    core_->health = std::move(health);
+    dispatcher_ = std::thread(&RequestScheduler::run, this);
+}
+
+RequestScheduler::~RequestScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(core_->mutex);
+        core_->running = false;
+    }
+    core_->cv.notify_all();
+    if (dispatcher_.joinable()) {
+        dispatcher_.join();
+    }
+    
+    // Requests being parsed right now are in neither map; their callback
+    // sees running == false and completes them itself
+    std::vector<RequestPtr> orphans;
+    std::vector<AsyncHTTPClient::RequestId> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(core_->mutex);
+        for (auto& [order, request] : core_->queue) {
+            orphans.push_back(request);
+        }
+        for (auto& [id, request] : core_->in_flight) {
+            cancelled.push_back(id);
+            orphans.push_back(request);
+        }
+        core_->queue.clear();
+        core_->in_flight.clear();
+        core_->by_key.clear();
+    }
+    for (auto id : cancelled) {
+        client_.cancel(id);
+    }
+    for (auto& request : orphans) {
+        complete(*request, std::nullopt, std::nullopt);
+    }
+}
+
+void RequestScheduler::request_quote(const std::string& symbol, QuoteCallback callback) {
+    auto request = std::make_shared<Request>();
+    request->kind = RequestKind::QUOTE;
+    request->key = "Q|" + symbol;
+    request->symbol = symbol;
+    request->quote_waiters.push_back(std::move(callback));
+    enqueue(std::move(request));
+}
+
+std::future<std::optional<Quote>> RequestScheduler::request_quote(const std::string& symbol) {
+    auto promise = std::make_shared<std::promise<std::optional<Quote>>>();
+    auto future = promise->get_future();
+    request_quote(symbol, [promise](std::optional<Quote> quote) {
+        promise->set_value(std::move(quote));
+    });
+    return future;
+}
+
+void RequestScheduler::request_ohlcv(const std::string& symbol, const std::string& interval, int limit,
+                                     OHLCVCallback callback) {
+    int fetch = limit;
+    uint64_t now = BarCache::now_ns();
+    std::shared_ptr<BarCache> cache;
+    {
+        std::lock_guard<std::mutex> lock(core_->mutex);
+        cache = core_->bar_cache;
+    }
+    if (cache && BarCache::interval_ns(interval)) {
+        fetch = cache->bars_to_fetch(symbol, interval, limit, now);
+        if (fetch == 0) {
+            std::vector<OHLCV> bars;
+            if (cache->latest(symbol, interval, limit, {}, now, bars)) {
+                callback(std::move(bars));
+                return;
+            }
+            fetch = limit + 1;
+        }
+    }
+    
+    auto request = std::make_shared<Request>();
+    request->kind = RequestKind::OHLCV;
+    request->key = "O|" + symbol + "|" + interval + "|" + std::to_string(limit) + "|" + std::to_string(fetch);
+    request->symbol = symbol;
+    request->interval = interval;
+    request->limit = fetch;
+    request->wanted = limit;
+    request->asked_ns = now;
+    request->ohlcv_waiters.push_back(std::move(callback));
+    enqueue(std::move(request));
+}
+
+std::future<std::optional<std::vector<OHLCV>>> RequestScheduler::request_ohlcv(const std::string& symbol,
+                                                                               const std::string& interval,
+                                                                               int limit) {
+    auto promise = std::make_shared<std::promise<std::optional<std::vector<OHLCV>>>>();
+    auto future = promise->get_future();
+    request_ohlcv(symbol, interval, limit, [promise](std::optional<std::vector<OHLCV>> bars) {
+        promise->set_value(std::move(bars));
+    });
+    return future;
+}
+
+void RequestScheduler::set_bar_cache(std::shared_ptr<BarCache> cache) {
+    std::lock_guard<std::mutex> lock(core_->mutex);
+    core_->bar_cache = std::move(cache);
+}
+
+void RequestScheduler::set_quote_timeout(std::chrono::milliseconds timeout) {
+    std::lock_guard<std::mutex> lock(core_->mutex);
+    core_->quote_timeout_ms = timeout.count();
+}
+
+void RequestScheduler::set_ohlcv_timeout(std::chrono::milliseconds timeout) {
+    std::lock_guard<std::mutex> lock(core_->mutex);
+    core_->ohlcv_timeout_ms = timeout.count();
+}
+
+size_t RequestScheduler::pending() const {
+    std::lock_guard<std::mutex> lock(core_->mutex);
+    return core_->by_key.size();
+}
+
+uint64_t RequestScheduler::coalesced() const {
+    return core_->coalesced.load(std::memory_order_relaxed);
+}
+
+uint64_t RequestScheduler::dispatched() const {
+    return core_->dispatched.load(std::memory_order_relaxed);
+}
+
+uint64_t RequestScheduler::rate_limited() const {
+    return core_->rate_limited.load(std::memory_order_relaxed);
+}
+
+void RequestScheduler::enqueue(RequestPtr request) {
+    {
+        std::lock_guard<std::mutex> lock(core_->mutex);
+        if (core_->running) {
+            auto it = core_->by_key.find(request->key);
+            if (it != core_->by_key.end()) {
+                // Ride along with the identical request already queued or in flight
+                Request& existing = *it->second;
+                for (auto& waiter : request->quote_waiters) {
+                    existing.quote_waiters.push_back(std::move(waiter));
+                }
+                for (auto& waiter : request->ohlcv_waiters) {
+                    existing.ohlcv_waiters.push_back(std::move(waiter));
+                }
+                core_->coalesced.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            
+            request->seq = core_->next_seq++;
+            core_->by_key[request->key] = request;
+            core_->push(request);
+            core_->cv.notify_one();
+            return;
+        }
+    }
+    complete(*request, std::nullopt, std::nullopt);
+}
+
+void RequestScheduler::run() {
+    Core& core = *core_;
+    std::unique_lock<std::mutex> lock(core.mutex);
+    
+    while (core.running) {
+        const auto now = Clock::now();
+        auto wake = Clock::time_point::max();
+        std::vector<RequestPtr> exhausted;
+        
+        for (auto it = core.queue.begin(); it != core.queue.end();) {
+            RequestPtr request = it->second;
+            bool sent = false;
+            bool eligible = false;
+            
+            for (size_t i = request->next_provider; i < core.providers.size() && !sent; ++i) {
+                IMarketDataProvider& provider = *core.providers[i];
+                if (!core.supports(provider, request->kind) || !core.healthy(i)) continue;
+                eligible = true;
+                
+                // Out of budget: try the next provider, or come back when a token refills
+                TokenBucket* limiter = provider.rate_limiter();
+                if (limiter) {
+                    auto until = limiter->time_until_available();
+                    if (until > Clock::duration::zero() || !limiter->try_acquire()) {
+                        wake = std::min(wake, now + std::max<Clock::duration>(until, std::chrono::milliseconds(1)));
+                        continue;
+                    }
+                }
+                sent = dispatch(request, i);
+            }
+            
+            if (sent || !eligible) {
+                if (!sent) {
+                    core.by_key.erase(request->key);
+                    exhausted.push_back(request);
+                }
+                it = core.queue.erase(it);
+                continue;
+            }
+            
+            if (!request->deferred) {
+                request->deferred = true;
+                core.rate_limited.fetch_add(1, std::memory_order_relaxed);
+            }
+            ++it;
+        }
+        
+        if (!exhausted.empty()) {
+            lock.unlock();
+            for (auto& request : exhausted) {
+                complete(*request, std::nullopt, std::nullopt);
+            }
+            lock.lock();
+            continue;
+        }
+        
+        if (wake == Clock::time_point::max()) {
+            core.cv.wait(lock);
+        } else {
+            core.cv.wait_until(lock, wake);
+        }
+    }
+}
+
+bool RequestScheduler::dispatch(const RequestPtr& request, size_t provider_index) {
+    auto provider = core_->providers[provider_index];
+    request->next_provider = provider_index + 1;
+    
+    HTTPRequest http;
+    bool built;
+    if (request->kind == RequestKind::QUOTE) {
+        built = provider->build_quote_request(request->symbol, http);
+        http.timeout_ms = core_->quote_timeout_ms;
+    } else {
+        built = provider->build_ohlcv_request(request->symbol, request->interval, request->limit, http);
+        http.timeout_ms = core_->ohlcv_timeout_ms;
+    }
+    if (!built) {
+        return false;
+    }
+    
+    // The core lock is held, so the callback cannot run before http_id is set
+    std::shared_ptr<Core> core = core_;
+    std::shared_ptr<ProviderHealth> health;
+    if (provider_index < core_->health.size()) {
+        health = core_->health[provider_index];
+    }
+    request->http_id = client_.submit(std::move(http), [core, request, provider, health](HTTPResponse&& response) {
+        {
+            std::lock_guard<std::mutex> lock(core->mutex);
+            if (core->in_flight.erase(request->http_id) == 0) {
+                return;  // Cancelled by shutdown, which owns the waiters
+            }
+        }
+        
+        std::optional<Quote> quote;
+        std::optional<std::vector<OHLCV>> bars;
+        if (response.ok()) {
+            if (request->kind == RequestKind::QUOTE) {
+                Quote parsed;
+                if (provider->parse_quote(request->symbol, response.body, parsed)) {
+                    quote = std::move(parsed);
+                }
+            } else {
+                std::vector<OHLCV> parsed;
+                if (provider->parse_ohlcv(request->symbol, request->limit, response.body, parsed)) {
+                    bars = std::move(parsed);
+                }
+                std::shared_ptr<BarCache> cache;
+                {
+                    std::lock_guard<std::mutex> lock(core->mutex);
+                    cache = core->bar_cache;
+                }
+                if (bars && cache && BarCache::interval_ns(request->interval)) {
+                    // Judge which bars had closed as of the request, so a bar
+                    // still forming then is not stored with partial values
+                    std::vector<OHLCV> merged;
+                    cache->store(request->symbol, request->interval, request->limit, *bars, request->asked_ns);
+                    cache->latest(request->symbol, request->interval, request->wanted, *bars,
+                                  request->asked_ns, merged);
+                    bars = std::move(merged);
+                }
+            }
+        }
+        if (health) {
+            if (quote || bars) {
+                health->record_success(response.elapsed_ms);
+            } else {
+                health->record_failure();
+            }
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(core->mutex);
+            if (!quote && !bars && core->running) {
+                // Back into the queue for the next provider, keeping its place in line
+                core->push(request);
+                core->cv.notify_one();
+                return;
+            }
+            core->by_key.erase(request->key);
+        }
+        complete(*request, std::move(quote), std::move(bars));
+    });
+    
+    core_->in_flight[request->http_id] = request;
+    core_->dispatched.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void RequestScheduler::complete(Request& request, std::optional<Quote> quote,
+                                std::optional<std::vector<OHLCV>> bars) {
+    for (auto& waiter : request.quote_waiters) {
+        if (waiter) waiter(quote);
+    }
+    for (auto& waiter : request.ohlcv_waiters) {
+        if (waiter) waiter(bars);
+    }
+    request.quote_waiters.clear();
+    request.ohlcv_waiters.clear();
+}
+
+} // namespace OrderBookNS
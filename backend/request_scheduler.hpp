@@ -0,0 +1,91 @@
+#pragma once
+
+#include "market_data.hpp"
+#include "async_http.hpp"
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <future>
+#include <optional>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+
+namespace OrderBookNS {
+
+// Non-blocking request scheduler over the market data providers
+// Callers enqueue a quote or OHLCV request and get a callback (or future)
+// instead of blocking on HTTP or a provider's rate limit. One dispatcher
+// thread hands queued requests to the async client:
+// - Quotes go before OHLCV; within a kind, requests go first come first served.
+// - A provider whose token bucket is empty is skipped for the next one; when
+//   every remaining provider is out of budget the request waits in the queue
+//   (other requests keep flowing) until the soonest token refills.
+// - A failed request falls through to the next provider; once none are left
+//   (or every remaining circuit is open) its callbacks get nullopt.
+// - Identical requests already queued or in flight are coalesced onto one
+//   HTTP call.
+// - With a bar cache, OHLCV requests ask only for the bars that closed since
+//   the last fetch, and are answered on the caller's thread straight from
+//   disk when nothing new has closed.
+// Callbacks run on the HTTP loop thread (or the caller's thread during
+// shutdown or a cache hit) and must not block.
+class RequestScheduler {
+public:
+    enum class RequestKind : uint8_t {
+        QUOTE = 0,   // Highest priority
+        OHLCV = 1
+    };
+    
+    using QuoteCallback = std::function<void(std::optional<Quote>)>;
+    using OHLCVCallback = std::function<void(std::optional<std::vector<OHLCV>>)>;
+    using Providers = std::vector<std::shared_ptr<IMarketDataProvider>>;
+    using HealthList = std::vector<std::shared_ptr<ProviderHealth>>;
+    
+    // `health`, if given, runs parallel to `providers`: open circuits are
+    // skipped and every response is recorded
+    RequestScheduler(AsyncHTTPClient& client, Providers providers, HealthList health = {});
+    ~RequestScheduler();
+    
+    RequestScheduler(const RequestScheduler&) = delete;
+    RequestScheduler& operator=(const RequestScheduler&) = delete;
+    
+    void request_quote(const std::string& symbol, QuoteCallback callback);
+    std::future<std::optional<Quote>> request_quote(const std::string& symbol);
+    
+    void request_ohlcv(const std::string& symbol, const std::string& interval, int limit,
+                       OHLCVCallback callback);
+    std::future<std::optional<std::vector<OHLCV>>> request_ohlcv(const std::string& symbol,
+                                                                 const std::string& interval = "1min",
+                                                                 int limit = 100);
+    
+    // Serve and fill OHLCV requests through an on-disk cache (nullptr: off)
+    void set_bar_cache(std::shared_ptr<BarCache> cache);
+    
+    // Per-attempt HTTP timeouts
+    void set_quote_timeout(std::chrono::milliseconds timeout);
+    void set_ohlcv_timeout(std::chrono::milliseconds timeout);
+    
+    size_t pending() const;        // Queued or in flight
+    uint64_t coalesced() const;    // Requests merged into an existing one
+    uint64_t dispatched() const;   // HTTP calls issued
+    uint64_t rate_limited() const; // Requests that had to wait for a token
+
+private:
+    struct Request;
+    struct Core;
+    using RequestPtr = std::shared_ptr<Request>;
+    
+    AsyncHTTPClient& client_;
+    std::shared_ptr<Core> core_;  // Shared with in-flight HTTP callbacks
+    std::thread dispatcher_;
+    
+    void run();
+    void enqueue(RequestPtr request);
+    bool dispatch(const RequestPtr& request, size_t provider_index);
+    static void complete(Request& request, std::optional<Quote> quote,
+                         std::optional<std::vector<OHLCV>> bars);
+};
+
+} // namespace OrderBookNS
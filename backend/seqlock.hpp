@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace OrderBookNS {
+
+// Single-writer sequence lock
+// The writer bumps the sequence to odd, stores the value, then bumps it back
+// to even. Readers copy the value and retry if the sequence was odd or moved
+// underneath them. Reads never block the writer and never take a lock, so a
+// reader costs a few loads when there is no concurrent store. The payload is kept
+// in relaxed atomic words, so a torn read is detected, never undefined.
+template<typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock payload must be trivially copyable");
+    
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    
+    alignas(64) std::atomic<uint64_t> sequence_;
+    std::atomic<uint64_t> words_[WORDS];
+
+public:
+    SeqLock() : sequence_(0) {
+        for (auto& word : words_) {
+            word.store(0, std::memory_order_relaxed);
+        }
+    }
+    
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+    
+    // Publish a new value (one writer thread only)
+    void store(const T& value) noexcept {
+        uint64_t buffer[WORDS] = {};
+        std::memcpy(buffer, &value, sizeof(T));
+        
+        uint64_t seq = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; ++i) {
+            words_[i].store(buffer[i], std::memory_order_relaxed);
+        }
+        sequence_.store(seq + 2, std::memory_order_release);
+    }
+    
+    // One read attempt; false if a store was in progress
+    bool try_load(T& out) const noexcept {
+        uint64_t before = sequence_.load(std::memory_order_acquire);
+        if (before & 1) return false;
+        
+        uint64_t buffer[WORDS];
+        for (size_t i = 0; i < WORDS; ++i) {
+            buffer[i] = words_[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence_.load(std::memory_order_relaxed) != before) return false;
+        
+        std::memcpy(&out, buffer, sizeof(T));
+        return true;
+    }
+    
+    // Consistent snapshot; spins only while a store is in flight
+    T load() const noexcept {
+        T out;
+        while (!try_load(out)) {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#elif defined(__aarch64__)
+            asm volatile("yield");
+#endif
+        }
+        return out;
+    }
+    
+    // Number of completed stores
+    uint64_t version() const noexcept {
+        return sequence_.load(std::memory_order_acquire) / 2;
+    }
+};
+
+} // namespace OrderBookNS
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+#include <cstdint>
+
+namespace OrderBookNS {
+
+using SymbolId = uint32_t;
+constexpr SymbolId INVALID_SYMBOL = UINT32_MAX;
+
+// Interned ticker symbols
+// Each distinct name gets a small dense id the first time it is seen, so hot
+// paths compare and index by integer instead of hashing strings. Ids are never
+// reused and names never move, so name() references stay valid for the life
+// of the table. Lookups take a shared lock and do not allocate.
+class SymbolTable {
+public:
+    SymbolTable() = default;
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+    
+    // Process-wide table used by the market data layer
+    static SymbolTable& global() {
+        static SymbolTable table;
+        return table;
+    }
+    
+    // Id for a name, adding it if new
+    SymbolId intern(std::string_view name) {
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            auto it = ids_.find(name);
+            if (it != ids_.end()) return it->second;
+        }
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto it = ids_.find(name);
+        if (it != ids_.end()) return it->second;
+        
+        SymbolId id = static_cast<SymbolId>(names_.size());
+        names_.emplace_back(name);
+        ids_.emplace(std::string_view(names_.back()), id);  // Keyed by the stored copy
+        return id;
+    }
+    
+    // Id for a name already interned, or INVALID_SYMBOL
+    SymbolId find(std::string_view name) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = ids_.find(name);
+        return it != ids_.end() ? it->second : INVALID_SYMBOL;
+    }
+    
+    const std::string& name(SymbolId id) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return names_[id];
+    }
+    
+    // Names of the given ids joined by a separator ("AAPL,MSFT,...")
+    std::string join(const std::vector<SymbolId>& ids, char separator = ',') const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        std::string joined;
+        for (size_t i = 0; i < ids.size(); ++i) {
+            if (i) joined += separator;
+            joined += names_[ids[i]];
+        }
+        return joined;
+    }
+    
+    size_t size() const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return names_.size();
+    }
+
+private:
+    mutable std::shared_mutex mutex_;
+    std::deque<std::string> names_;  // Indexed by id; deque keeps elements in place
+    std::unordered_map<std::string_view, SymbolId> ids_;
+};
+
+} // namespace OrderBookNS
@@ -0,0 +1,262 @@
+#include "thread_topology.hpp"
+#include <algorithm>
+#include <fstream>
+#include <thread>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+namespace OrderBookNS {
+
+namespace {
+
+const char* const ROLE_NAMES[THREAD_ROLE_COUNT] = {"matching", "feed", "ui", "recorder", "logger", "metrics"};
+const char* const WAIT_NAMES[] = {"sleep", "spin_park", "busy_poll"};
+
+constexpr uint64_t CPU_SAMPLE_INTERVAL_NS = 10000000;  // 10 ms
+constexpr uint64_t FIRST_PARK_US = 10;
+constexpr int MPOL_PREFERRED_MODE = 1;  // MPOL_PREFERRED from <numaif.h>
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Counters have a single writer, so a plain load/store avoids a locked add
+inline void bump(std::atomic<uint64_t>& counter, uint64_t by = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+}
+
+uint64_t thread_cpu_ns() {
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0;
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+} // namespace
+
+const char* role_name(ThreadRole role) {
+    size_t index = static_cast<size_t>(role);
+    return index < THREAD_ROLE_COUNT ? ROLE_NAMES[index] : "unknown";
+}
+
+bool parse_role(const std::string& name, ThreadRole& role) {
+    for (size_t i = 0; i < THREAD_ROLE_COUNT; ++i) {
+        if (name == ROLE_NAMES[i]) {
+            role = static_cast<ThreadRole>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* wait_mode_name(WaitMode mode) {
+    return WAIT_NAMES[static_cast<size_t>(mode)];
+}
+
+bool parse_wait_mode(const std::string& name, WaitMode& mode) {
+    for (size_t i = 0; i < sizeof(WAIT_NAMES) / sizeof(WAIT_NAMES[0]); ++i) {
+        if (name == WAIT_NAMES[i]) {
+            mode = static_cast<WaitMode>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+ThreadRoleConfig ThreadRoleConfig::defaults(ThreadRole role) {
+    ThreadRoleConfig config;
+    if (role == ThreadRole::UI) {
+        config.sleep_us = 10000;
+    }
+    return config;
+}
+
+bool numa_node_cpus(int node, cpu_set_t& cpus) {
+    std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    std::string list;
+    if (node < 0 || !file.is_open() || !std::getline(file, list)) {
+        return false;
+    }
+    
+    // The kernel prints ranges: "0-7,16-23"
+    CPU_ZERO(&cpus);
+    size_t pos = 0;
+    while (pos < list.size()) {
+        size_t end = list.find(',', pos);
+        if (end == std::string::npos) end = list.size();
+        std::string range = list.substr(pos, end - pos);
+        size_t dash = range.find('-');
+        try {
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu) {
+                CPU_SET(cpu, &cpus);
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+        pos = end + 1;
+    }
+    return true;
+}
+
+ThreadTopology& ThreadTopology::global() {
+    static ThreadTopology topology;
+    return topology;
+}
+
+ThreadTopology::ThreadTopology() {
+    for (size_t i = 0; i < THREAD_ROLE_COUNT; ++i) {
+        configs_[i] = ThreadRoleConfig::defaults(static_cast<ThreadRole>(i));
+    }
+}
+
+void ThreadTopology::configure(ThreadRole role, const ThreadRoleConfig& config) {
+    configs_[static_cast<size_t>(role)] = config;
+}
+
+const ThreadRoleConfig& ThreadTopology::config(ThreadRole role) const {
+    return configs_[static_cast<size_t>(role)];
+}
+
+bool ThreadTopology::enter(ThreadRole role) {
+    const ThreadRoleConfig& config = configs_[static_cast<size_t>(role)];
+    ThreadStats& stats = stats_[static_cast<size_t>(role)];
+    bool ok = true;
+    
+    std::string name = std::string("ob-") + role_name(role);
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+    
+    // A core, or every core of the node
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    bool pin = false;
+    if (config.cpu >= 0 && config.cpu < CPU_SETSIZE) {
+        CPU_SET(config.cpu, &cpus);
+        pin = true;
+    } else if (config.numa_node >= 0) {
+        pin = numa_node_cpus(config.numa_node, cpus);
+        ok &= pin;
+    }
+    bool pinned = pin && pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+    ok &= pinned == pin;
+    
+    // Prefer the node's memory for what this thread allocates from now on
+    if (config.numa_node >= 0 && config.numa_node < 256) {
+        unsigned long nodes[256 / (8 * sizeof(unsigned long))] = {};
+        nodes[config.numa_node / (8 * sizeof(unsigned long))] |= 1UL << (config.numa_node % (8 * sizeof(unsigned long)));
+        ok &= syscall(SYS_set_mempolicy, MPOL_PREFERRED_MODE, nodes, 8 * sizeof(nodes)) == 0;
+    }
+    
+    bool realtime = false;
+    if (config.fifo_priority > 0) {
+        sched_param param{};
+        param.sched_priority = std::min(config.fifo_priority, sched_get_priority_max(SCHED_FIFO));
+        realtime = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+        ok &= realtime;
+    }
+    
+    uint64_t now = PollLoop::now_ns();
+    stats.pinned.store(pinned, std::memory_order_relaxed);
+    stats.realtime.store(realtime, std::memory_order_relaxed);
+    stats.cpu.store(sched_getcpu(), std::memory_order_relaxed);
+    uint64_t cpu_now = thread_cpu_ns();
+    stats.cpu_start_ns.store(cpu_now, std::memory_order_relaxed);
+    stats.cpu_ns.store(cpu_now, std::memory_order_relaxed);
+    stats.sampled_ns.store(now, std::memory_order_relaxed);
+    stats.started_ns.store(now, std::memory_order_relaxed);
+    stats.active.store(true, std::memory_order_release);
+    return ok;
+}
+
+ThreadStatsSnapshot ThreadTopology::snapshot(ThreadRole role) const {
+    const ThreadStats& stats = stats_[static_cast<size_t>(role)];
+    ThreadStatsSnapshot snap{};
+    snap.role = role;
+    snap.active = stats.active.load(std::memory_order_acquire);
+    snap.pinned = stats.pinned.load(std::memory_order_relaxed);
+    snap.realtime = stats.realtime.load(std::memory_order_relaxed);
+    snap.cpu = stats.cpu.load(std::memory_order_relaxed);
+    snap.loops = stats.loops.load(std::memory_order_relaxed);
+    orderbook::LatencySnapshot work = stats.work.snapshot();
+    snap.work_loops = work.count;
+    snap.avg_work_ns = work.avg_ns;
+    snap.p50_work_ns = work.p50_ns;
+    snap.p99_work_ns = work.p99_ns;
+    snap.max_work_ns = work.max_ns;
+    
+    uint64_t started = stats.started_ns.load(std::memory_order_relaxed);
+    uint64_t sampled = stats.sampled_ns.load(std::memory_order_relaxed);
+    uint64_t cpu_start = stats.cpu_start_ns.load(std::memory_order_relaxed);
+    uint64_t cpu = stats.cpu_ns.load(std::memory_order_relaxed);
+    if (sampled > started && cpu >= cpu_start) {
+        snap.cpu_utilization = static_cast<double>(cpu - cpu_start) / static_cast<double>(sampled - started);
+    }
+    return snap;
+}
+
+PollLoop::PollLoop(ThreadRole role)
+    : role_(role), stats_(ThreadTopology::global().stats(role)),
+      idle_since_ns_(0), park_us_(FIRST_PARK_US), next_sample_ns_(0) {
+    ThreadTopology::global().enter(role);
+    config_ = ThreadTopology::global().config(role);
+    next_sample_ns_ = now_ns() + CPU_SAMPLE_INTERVAL_NS;
+}
+
+void PollLoop::end(uint64_t begin_ns, bool worked) {
+    record(begin_ns, worked);
+    if (!worked) {
+        idle();
+    }
+}
+
+void PollLoop::record(uint64_t begin_ns, bool worked) {
+    uint64_t now = now_ns();
+    bump(stats_.loops);
+    if (worked) {
+        stats_.work.record(now - begin_ns);
+        idle_since_ns_ = 0;
+        park_us_ = FIRST_PARK_US;
+    }
+    if (now >= next_sample_ns_) {
+        sample_cpu(now);
+    }
+}
+
+void PollLoop::idle() {
+    switch (config_.wait) {
+        case WaitMode::BUSY_POLL:
+            cpu_relax();
+            break;
+        case WaitMode::SPIN_PARK: {
+            uint64_t now = now_ns();
+            if (idle_since_ns_ == 0) idle_since_ns_ = now;
+            if (now - idle_since_ns_ < static_cast<uint64_t>(config_.spin_us) * 1000) {
+                cpu_relax();
+            } else {
+                // Park in growing steps so a quiet thread settles at sleep_us
+                uint64_t park = std::min<uint64_t>(park_us_, config_.sleep_us);
+                std::this_thread::sleep_for(std::chrono::microseconds(park));
+                park_us_ = std::min<uint64_t>(park_us_ * 2, config_.sleep_us);
+            }
+            break;
+        }
+        case WaitMode::SLEEP:
+            std::this_thread::sleep_for(std::chrono::microseconds(config_.sleep_us));
+            break;
+    }
+}
+
+void PollLoop::sample_cpu(uint64_t now) {
+    stats_.cpu_ns.store(thread_cpu_ns(), std::memory_order_relaxed);
+    stats_.sampled_ns.store(now, std::memory_order_relaxed);
+    stats_.cpu.store(sched_getcpu(), std::memory_order_relaxed);
+    next_sample_ns_ = now + CPU_SAMPLE_INTERVAL_NS;
+}
+
+} // namespace OrderBookNS
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "latency_histogram.hpp"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <sched.h>
+
+namespace OrderBookNS {
+
+// Threads the engine runs, each placed and paced by its own config entry
+enum class ThreadRole : uint8_t {
+    MATCHING = 0,   // Drives the book: quotes, simulated flow, expiries, commands, RL actions
+    FEED = 1,       // Market data polling / streaming
+    UI = 2,         // Terminal input and rendering
+    RECORDER = 3,   // Tick recorder writer
+    LOGGER = 4,     // Async logger writer
+    METRICS = 5,    // Prometheus metrics endpoint
+    COUNT = 6
+};
+
+constexpr size_t THREAD_ROLE_COUNT = static_cast<size_t>(ThreadRole::COUNT);
+
+const char* role_name(ThreadRole role);
+bool parse_role(const std::string& name, ThreadRole& role);
+
+// What a loop does when an iteration found no work
+//   BUSY_POLL  spin with a pause instruction; lowest latency, burns a core
+//   SPIN_PARK  spin for spin_us, then sleep in growing steps up to sleep_us
+//   SLEEP      sleep sleep_us every time
+enum class WaitMode : uint8_t {
+    SLEEP = 0,
+    SPIN_PARK = 1,
+    BUSY_POLL = 2
+};
+
+const char* wait_mode_name(WaitMode mode);
+bool parse_wait_mode(const std::string& name, WaitMode& mode);
+
+// Placement and pacing of one role; -1 leaves the choice to the OS
+struct ThreadRoleConfig {
+    int cpu = -1;              // Core to pin to
+    int numa_node = -1;        // Node to allocate on (and run on, if cpu is -1)
+    int fifo_priority = 0;     // SCHED_FIFO priority 1-99; 0 keeps the normal scheduler
+    WaitMode wait = WaitMode::SLEEP;
+    uint32_t spin_us = 50;
+    uint32_t sleep_us = 1000;
+    
+    // Defaults per role: the UI polls keys at 100 Hz, everything else polls at 1 kHz
+    static ThreadRoleConfig defaults(ThreadRole role);
+};
+
+// CPUs of a NUMA node from sysfs; false if the node does not exist
+bool numa_node_cpus(int node, cpu_set_t& cpus);
+
+// Counters of one role's thread, written by that thread only and readable
+// from any thread without locks
+struct ThreadStats {
+    std::atomic<bool> active{false};
+    std::atomic<bool> pinned{false};
+    std::atomic<bool> realtime{false};
+    std::atomic<int> cpu{-1};               // Core it last ran on
+    std::atomic<uint64_t> started_ns{0};    // steady_clock at enter()
+    std::atomic<uint64_t> cpu_start_ns{0};  // Thread CPU time at enter()
+    std::atomic<uint64_t> cpu_ns{0};        // Thread CPU time, sampled every ~10 ms
+    std::atomic<uint64_t> sampled_ns{0};    // steady_clock of that sample
+    std::atomic<uint64_t> loops{0};
+    orderbook::LatencyHistogram work;       // Duration of iterations that found work
+};
+
+struct ThreadStatsSnapshot {
+    ThreadRole role;
+    bool active;
+    bool pinned;
+    bool realtime;
+    int cpu;
+    uint64_t loops;
+    uint64_t work_loops;
+    double cpu_utilization;   // Thread CPU time / wall time since enter()
+    double avg_work_ns;
+    uint64_t p50_work_ns;     // Bucket upper bounds
+    uint64_t p99_work_ns;
+    uint64_t max_work_ns;
+};
+
+// Process-wide registry of role placement and per-role counters
+// main() configures the roles from ConfigLoader before starting threads;
+// each thread then calls enter() (directly or through PollLoop) as it starts.
+class ThreadTopology {
+public:
+    static ThreadTopology& global();
+    
+    void configure(ThreadRole role, const ThreadRoleConfig& config);
+    const ThreadRoleConfig& config(ThreadRole role) const;
+    
+    // Apply the role's placement to the calling thread: name it, pin it to
+    // its core (or its NUMA node's cores), prefer its node for allocations
+    // and switch to SCHED_FIFO if configured. A step that fails (e.g. no
+    // permission for SCHED_FIFO) is skipped and false is returned; the thread
+    // keeps running either way.
+    bool enter(ThreadRole role);
+    
+    ThreadStats& stats(ThreadRole role) { return stats_[static_cast<size_t>(role)]; }
+    ThreadStatsSnapshot snapshot(ThreadRole role) const;
+    
+private:
+    ThreadTopology();
+    
+    ThreadRoleConfig configs_[THREAD_ROLE_COUNT];
+    ThreadStats stats_[THREAD_ROLE_COUNT];
+};
+
+// Loop pacing for one role's thread
+// Each iteration is bracketed by begin()/end(); end() records how long the
+// iteration's work took and, if it found nothing to do, waits according to
+// the role's WaitMode.
+//
+//   PollLoop loop(ThreadRole::MATCHING);
+//   loop.run([&] { return running.load(); }, [&] { return poll_once(); });
+class PollLoop {
+public:
+    explicit PollLoop(ThreadRole role);
+    
+    static uint64_t now_ns() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+    
+    uint64_t begin() const { return now_ns(); }
+    void end(uint64_t begin_ns, bool worked);
+    
+    // Count an iteration without waiting, for loops that block on their own
+    // (a condition variable, a socket)
+    void record(uint64_t begin_ns, bool worked);
+    
+    // Wait once as if an iteration found no work
+    void idle();
+    
+    // poll() returns true when it did work
+    template<typename Running, typename Poll>
+    void run(Running&& keep_running, Poll&& poll) {
+        while (keep_running()) {
+            uint64_t start = begin();
+            end(start, poll());
+        }
+    }
+    
+    ThreadRole role() const { return role_; }
+    
+private:
+    ThreadRole role_;
+    ThreadRoleConfig config_;
+    ThreadStats& stats_;
+    uint64_t idle_since_ns_;     // 0 while work keeps coming
+    uint64_t park_us_;
+    uint64_t next_sample_ns_;
+    
+    void sample_cpu(uint64_t now);
+};
+
+} // namespace OrderBookNS
@@ -0,0 +1,327 @@
+#include "tick_recorder.hpp"
+#include "columnar.hpp"
+#include "thread_topology.hpp"
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <system_error>
+
+namespace OrderBookNS {
+
+namespace {
+
+constexpr uint32_t BLOCK_ROWS = 4096;
+constexpr auto FLUSH_INTERVAL = std::chrono::seconds(1);
+
+// A column of a stream: file name suffix, encoding, and how to get and put
+// its value in a TickEvent
+struct Field {
+    const char* name;
+    columnar::Encoding encoding;
+    int64_t (*get)(const TickEvent&);
+    void (*set)(TickEvent&, int64_t);
+};
+
+using columnar::Encoding;
+
+const Field TIME{"time", Encoding::DELTA,
+    [](const TickEvent& e) { return static_cast<int64_t>(e.time_ns); },
+    [](TickEvent& e, int64_t v) { e.time_ns = static_cast<uint64_t>(v); }};
+const Field SYMBOL{"symbol", Encoding::VARINT,
+    [](const TickEvent& e) { return static_cast<int64_t>(e.symbol); },
+    [](TickEvent& e, int64_t v) { e.symbol = static_cast<SymbolId>(v); }};
+const Field SOURCE{"source", Encoding::DELTA,
+    [](const TickEvent& e) { return static_cast<int64_t>(e.source_ns); },
+    [](TickEvent& e, int64_t v) { e.source_ns = static_cast<uint64_t>(v); }};
+const Field PRICE{"price", Encoding::DELTA,
+    [](const TickEvent& e) { return e.price; },
+    [](TickEvent& e, int64_t v) { e.price = v; }};
+const Field PRICE2{"price2", Encoding::DELTA,
+    [](const TickEvent& e) { return e.price2; },
+    [](TickEvent& e, int64_t v) { e.price2 = v; }};
+const Field QUANTITY{"quantity", Encoding::VARINT,
+    [](const TickEvent& e) { return static_cast<int64_t>(e.quantity); },
+    [](TickEvent& e, int64_t v) { e.quantity = static_cast<uint64_t>(v); }};
+const Field QUANTITY2{"quantity2", Encoding::VARINT,
+    [](const TickEvent& e) { return static_cast<int64_t>(e.quantity2); },
+    [](TickEvent& e, int64_t v) { e.quantity2 = static_cast<uint64_t>(v); }};
+const Field ID{"id", Encoding::DELTA,
+    [](const TickEvent& e) { return static_cast<int64_t>(e.id); },
+    [](TickEvent& e, int64_t v) { e.id = static_cast<uint64_t>(v); }};
+const Field ID2{"id2", Encoding::DELTA,
+    [](const TickEvent& e) { return static_cast<int64_t>(e.id2); },
+    [](TickEvent& e, int64_t v) { e.id2 = static_cast<uint64_t>(v); }};
+const Field FLAGS{"flags", Encoding::VARINT,
+    [](const TickEvent& e) { return static_cast<int64_t>(e.side | e.order_type << 2 | e.status << 5); },
+    [](TickEvent& e, int64_t v) {
+        e.side = static_cast<uint8_t>(v & 0x3);
+        e.order_type = static_cast<uint8_t>((v >> 2) & 0x7);
+        e.status = static_cast<uint8_t>((v >> 5) & 0x7);
+    }};
+
+struct StreamLayout {
+    TickEvent::Type type;
+    const char* name;
+    std::vector<const Field*> fields;
+};
+
+const StreamLayout STREAMS[] = {
+    {TickEvent::Type::QUOTE, "quotes", {&TIME, &SYMBOL, &SOURCE, &PRICE, &PRICE2, &QUANTITY, &QUANTITY2}},
+    {TickEvent::Type::TRADE, "trades", {&TIME, &SYMBOL, &SOURCE, &PRICE, &QUANTITY, &ID, &ID2}},
+    {TickEvent::Type::ORDER, "orders", {&TIME, &SYMBOL, &SOURCE, &ID, &PRICE, &QUANTITY, &QUANTITY2, &FLAGS}},
+};
+
+std::string column_path(const std::string& dir, const StreamLayout& stream, const Field& field) {
+    return dir + "/" + stream.name + "." + field.name + ".col";
+}
+
+uint64_t wall_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+// Column writers of one stream, filled row by row
+struct StreamWriter {
+    const StreamLayout* layout;
+    std::vector<std::unique_ptr<columnar::ColumnWriter>> columns;
+    
+    StreamWriter(const StreamLayout& stream, const std::string& dir) : layout(&stream) {
+        for (const Field* field : stream.fields) {
+            columns.push_back(std::make_unique<columnar::ColumnWriter>(
+                column_path(dir, stream, *field), field->encoding));
+        }
+    }
+    
+    void push(const TickEvent& event) {
+        for (size_t i = 0; i < columns.size(); ++i) {
+            columns[i]->push(layout->fields[i]->get(event));
+        }
+    }
+    
+    uint32_t rows() const { return columns.front()->rows(); }
+    
+    void flush() {
+        for (auto& column : columns) {
+            column->flush();
+        }
+    }
+};
+
+} // namespace
+
+TickRecorder::TickRecorder(std::string root, size_t queue_capacity)
+    : root_(std::move(root)), queue_(queue_capacity), running_(false), pushing_(0),
+      recorded_(0), dropped_(0), written_(0) {
+}
+
+TickRecorder::~TickRecorder() {
+    stop();
+}
+
+bool TickRecorder::start() {
+    if (running_.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    
+    std::time_t now = std::time(nullptr);
+    std::tm local{};
+    localtime_r(&now, &local);
+    char name[32];
+    std::strftime(name, sizeof(name), "%Y%m%d-%H%M%S", &local);
+    session_dir_ = root_ + "/" + name;
+    
+    std::error_code error;
+    std::filesystem::create_directories(session_dir_, error);
+    if (error) {
+        return false;
+    }
+    
+    running_.store(true, std::memory_order_release);
+    writer_ = std::thread(&TickRecorder::write_loop, this);
+    return true;
+}
+
+void TickRecorder::stop() {
+    running_.store(false);
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+}
+
+bool TickRecorder::push(const TickEvent& event) {
+    // Announce the push before checking running_ (both seq_cst): a producer
+    // that still sees the recorder running is visible to stop()'s final drain
+    pushing_.fetch_add(1);
+    bool pushed = running_.load() && queue_.try_push(event);
+    if (pushed) {
+        recorded_.fetch_add(1, std::memory_order_relaxed);
+    }
+    pushing_.fetch_sub(1, std::memory_order_release);
+    if (!pushed) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return pushed;
+}
+
+bool TickRecorder::record(SymbolId symbol, const Quote& quote) {
+    TickEvent event;
+    event.type = TickEvent::Type::QUOTE;
+    event.symbol = symbol;
+    event.time_ns = wall_ns();
+    event.source_ns = quote.timestamp;
+    event.price = quote.bid_price;
+    event.price2 = quote.ask_price;
+    event.quantity = quote.bid_size;
+    event.quantity2 = quote.ask_size;
+    return push(event);
+}
+
+bool TickRecorder::record(SymbolId symbol, const orderbook::Trade& trade) {
+    TickEvent event;
+    event.type = TickEvent::Type::TRADE;
+    event.symbol = symbol;
+    event.time_ns = wall_ns();
+    event.source_ns = static_cast<uint64_t>(trade.timestamp.count());
+    event.price = trade.price;
+    event.quantity = trade.quantity;
+    event.id = trade.buy_order_id;
+    event.id2 = trade.sell_order_id;
+    return push(event);
+}
+
+bool TickRecorder::record(SymbolId symbol, const orderbook::Order& order) {
+    TickEvent event;
+    event.type = TickEvent::Type::ORDER;
+    event.symbol = symbol;
+    event.time_ns = wall_ns();
+    event.source_ns = static_cast<uint64_t>(order.timestamp.count());
+    event.price = order.price;
+    event.quantity = order.quantity;
+    event.quantity2 = order.filled_quantity;
+    event.id = order.id;
+    event.side = static_cast<uint8_t>(order.side);
+    event.order_type = static_cast<uint8_t>(order.type);
+    event.status = static_cast<uint8_t>(order.status);
+    return push(event);
+}
+
+void TickRecorder::attach(orderbook::OrderBook& book, const std::string& symbol) {
+    SymbolId id = SymbolTable::global().intern(symbol);
+    book.register_trade_callback([this, id](const orderbook::Trade& trade) { record(id, trade); });
+    book.register_order_callback([this, id](const orderbook::Order& order) { record(id, order); });
+}
+
+void TickRecorder::write_loop() {
+    std::vector<StreamWriter> streams;
+    for (const auto& layout : STREAMS) {
+        streams.emplace_back(layout, session_dir_);
+    }
+    size_t symbols_written = 0;
+    
+    auto flush_all = [&]() {
+        for (auto& stream : streams) {
+            stream.flush();
+        }
+        // Names for every id a recorded event may carry
+        const SymbolTable& table = SymbolTable::global();
+        size_t count = table.size();
+        if (count != symbols_written) {
+            std::string tmp = session_dir_ + "/symbols.txt.tmp";
+            {
+                std::ofstream out(tmp, std::ios::trunc);
+                for (size_t id = 0; id < count; ++id) {
+                    out << table.name(static_cast<SymbolId>(id)) << '\n';
+                }
+            }
+            std::error_code error;
+            std::filesystem::rename(tmp, session_dir_ + "/symbols.txt", error);
+            if (!error) symbols_written = count;
+        }
+    };
+    
+    auto last_flush = std::chrono::steady_clock::now();
+    TickEvent event;
+    auto drain = [&]() {
+        size_t drained = 0;
+        while (queue_.try_pop(event)) {
+            StreamWriter& stream = streams[static_cast<size_t>(event.type)];
+            stream.push(event);
+            if (stream.rows() >= BLOCK_ROWS) {
+                stream.flush();
+            }
+            ++drained;
+        }
+        written_.fetch_add(drained, std::memory_order_relaxed);
+        return drained;
+    };
+    
+    PollLoop loop(ThreadRole::RECORDER);
+    loop.run([this] { return running_.load(std::memory_order_acquire); }, [&]() {
+        size_t drained = drain();
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_flush >= FLUSH_INTERVAL) {
+            flush_all();
+            last_flush = now;
+            return true;
+        }
+        return drained > 0;
+    });
+    
+    // Producers that passed the running_ check before stop() finish their
+    // enqueue first, so the final drain misses nothing that was counted
+    while (pushing_.load() != 0) {
+        std::this_thread::yield();
+    }
+    drain();
+    flush_all();
+}
+
+size_t TickReader::load_stream(const std::string& session_dir, TickEvent::Type type,
+                               std::vector<TickEvent>& events) {
+    const StreamLayout& layout = STREAMS[static_cast<size_t>(type)];
+    std::vector<std::vector<int64_t>> columns(layout.fields.size());
+    size_t rows = SIZE_MAX;
+    for (size_t i = 0; i < layout.fields.size(); ++i) {
+        if (!columnar::read_column(column_path(session_dir, layout, *layout.fields[i]), columns[i])) {
+            return 0;
+        }
+        rows = std::min(rows, columns[i].size());
+    }
+    
+    size_t base = events.size();
+    events.resize(base + rows);
+    for (size_t r = 0; r < rows; ++r) {
+        events[base + r].type = type;
+    }
+    for (size_t i = 0; i < layout.fields.size(); ++i) {
+        for (size_t r = 0; r < rows; ++r) {
+            layout.fields[i]->set(events[base + r], columns[i][r]);
+        }
+    }
+    return rows;
+}
+
+bool TickReader::load(const std::string& session_dir, std::vector<TickEvent>& events,
+                      std::vector<std::string>& symbol_names) {
+    symbol_names.clear();
+    std::ifstream symbols(session_dir + "/symbols.txt");
+    for (std::string line; std::getline(symbols, line);) {
+        symbol_names.push_back(line);
+    }
+    
+    size_t base = events.size();
+    bool found = false;
+    for (const auto& layout : STREAMS) {
+        found |= std::filesystem::exists(column_path(session_dir, layout, TIME));
+        load_stream(session_dir, layout.type, events);
+    }
+    std::stable_sort(events.begin() + base, events.end(), [](const TickEvent& a, const TickEvent& b) {
+        return a.time_ns < b.time_ns;
+    });
+    return found;
+}
+
+} // namespace OrderBookNS
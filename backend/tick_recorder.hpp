@@ -0,0 +1,121 @@
+#pragma once
+
+#include "market_data.hpp"
+#include "mpsc_queue.hpp"
+#include "orderbook.hpp"
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+
+namespace OrderBookNS {
+
+// One recorded event; which fields are used depends on the type
+//   QUOTE  price/price2 = bid/ask, quantity/quantity2 = bid/ask size
+//   TRADE  price, quantity, id/id2 = buy/sell order id
+//   ORDER  price, quantity, quantity2 = filled, id, side/order_type/status
+struct TickEvent {
+    enum class Type : uint8_t {
+        QUOTE = 0,
+        TRADE = 1,
+        ORDER = 2
+    };
+    
+    Type type = Type::QUOTE;
+    uint8_t side = 0;
+    uint8_t order_type = 0;
+    uint8_t status = 0;
+    SymbolId symbol = INVALID_SYMBOL;
+    uint64_t time_ns = 0;    // Wall clock when recorded
+    uint64_t source_ns = 0;  // The event's own timestamp (ns; providers normalize to it)
+    int64_t price = 0;
+    int64_t price2 = 0;
+    uint64_t quantity = 0;
+    uint64_t quantity2 = 0;
+    uint64_t id = 0;
+    uint64_t id2 = 0;
+};
+
+// Session recorder for quotes, book trades and order updates
+// record() stamps the event and pushes it onto a lock-free queue; it never
+// blocks or allocates, and drops the event (counted in dropped()) when the
+// queue is full. A writer thread drains the queue into one directory per
+// session:
+//
+//   <root>/<YYYYMMDD-HHMMSS>/quotes.<column>.col, trades.*, orders.*, symbols.txt
+//
+// Every field is its own column file (columnar::ColumnWriter): times, ids and
+// prices delta-encoded, sizes as plain varints. A block is written per 4096
+// rows of a stream and at least once a second, so a crash loses at most the
+// last second. symbols.txt lists SymbolTable names, one per line, by id.
+// TickReader loads a session back for backtests, calibration and training.
+class TickRecorder {
+public:
+    explicit TickRecorder(std::string root = "data/ticks", size_t queue_capacity = 1 << 16);
+    ~TickRecorder();
+    
+    TickRecorder(const TickRecorder&) = delete;
+    TickRecorder& operator=(const TickRecorder&) = delete;
+    
+    // Create the session directory and start the writer; false if the
+    // directory cannot be created
+    bool start();
+    
+    // Drain what is queued, flush every column and join the writer
+    void stop();
+    
+    bool is_running() const { return running_.load(std::memory_order_relaxed); }
+    const std::string& session_dir() const { return session_dir_; }
+    
+    // Any thread; false if the event was dropped
+    bool record(SymbolId symbol, const Quote& quote);
+    bool record(SymbolId symbol, const orderbook::Trade& trade);
+    bool record(SymbolId symbol, const orderbook::Order& order);
+    
+    // Record every trade and order update of a book under `symbol`. The
+    // callbacks stay registered, so the recorder must outlive the book's
+    // activity.
+    void attach(orderbook::OrderBook& book, const std::string& symbol);
+    
+    uint64_t recorded() const { return recorded_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    uint64_t written() const { return written_.load(std::memory_order_relaxed); }
+    // Events queued but not yet written, and how many the queue holds
+    uint64_t backlog() const {
+        uint64_t written = written_.load(std::memory_order_relaxed);
+        uint64_t recorded = recorded_.load(std::memory_order_relaxed);
+        return recorded > written ? recorded - written : 0;
+    }
+    size_t queue_capacity() const { return queue_.capacity(); }
+    
+private:
+    std::string root_;
+    std::string session_dir_;
+    MPSCQueue<TickEvent> queue_;
+    std::atomic<bool> running_;
+    std::atomic<uint32_t> pushing_;  // Producers between the running_ check and the enqueue
+    std::thread writer_;
+    std::atomic<uint64_t> recorded_;
+    std::atomic<uint64_t> dropped_;
+    std::atomic<uint64_t> written_;
+    
+    bool push(const TickEvent& event);
+    void write_loop();
+};
+
+// Reads a recorded session directory back
+class TickReader {
+public:
+    // Events of every stream merged by recording time; streams whose column
+    // files disagree in length (a crash mid-flush) are cut to the shortest.
+    // False if the directory holds no recording.
+    static bool load(const std::string& session_dir, std::vector<TickEvent>& events,
+                     std::vector<std::string>& symbol_names);
+    
+    // One stream only, in recording order
+    static size_t load_stream(const std::string& session_dir, TickEvent::Type type,
+                              std::vector<TickEvent>& events);
+};
+
+} // namespace OrderBookNS
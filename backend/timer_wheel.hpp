@@ -0,0 +1,239 @@
+#pragma once
+
+#include "memory_pool.hpp"
+#include <cstdint>
+#include <cstddef>
+
+namespace orderbook {
+
+// Hierarchical timer wheel
+// 11 levels x 64 slots cover the full 64-bit tick range. A timer lives on the
+// level of the highest 6-bit digit in which its deadline differs from the
+// current time, so lower levels always expire before higher ones. Finding the
+// next expiry is one ctz per level via the occupancy bitmaps; timers further
+// out are cascaded down as time reaches their slot.
+//
+// schedule/cancel are O(1) (intrusive list + pool), timers sharing a tick fire
+// in a deterministic order, and ticks are whatever unit the owner chooses
+// (ns for the event scheduler and order expiry).
+template<typename T>
+class TimerWheel {
+public:
+    struct Timer {
+        T value;
+        uint64_t deadline;
+        Timer* prev;
+        Timer* next;
+        uint8_t level;
+        uint8_t slot;
+        
+        Timer(const T& v, uint64_t d)
+            : value(v), deadline(d), prev(nullptr), next(nullptr), level(0), slot(0) {}
+    };
+    
+    using Handle = Timer*;
+
+private:
+    static constexpr unsigned SLOT_BITS = 6;
+    static constexpr unsigned SLOTS = 1u << SLOT_BITS;
+    static constexpr unsigned LEVELS = 11;
+    
+    struct Slot {
+        Timer* head = nullptr;
+        Timer* tail = nullptr;
+    };
+    
+    Slot slots_[LEVELS][SLOTS];
+    uint64_t occupied_[LEVELS];
+    uint64_t now_;
+    size_t size_;
+    MemoryPool<Timer> pool_;
+    
+    [[gnu::always_inline]]
+    static inline unsigned level_for(uint64_t now, uint64_t deadline) noexcept {
+        uint64_t diff = (now ^ deadline) | 1;
+        return (63 - __builtin_clzll(diff)) / SLOT_BITS;
+    }
+    
+    [[gnu::always_inline]]
+    inline void link(Timer* t) noexcept {
+        unsigned level = level_for(now_, t->deadline);
+        unsigned slot = (t->deadline >> (level * SLOT_BITS)) & (SLOTS - 1);
+        t->level = static_cast<uint8_t>(level);
+        t->slot = static_cast<uint8_t>(slot);
+        
+        Slot& s = slots_[level][slot];
+        t->next = nullptr;
+        t->prev = s.tail;
+        if (s.tail) {
+            s.tail->next = t;
+        } else {
+            s.head = t;
+            occupied_[level] |= (1ULL << slot);
+        }
+        s.tail = t;
+    }
+    
+    [[gnu::always_inline]]
+    inline void unlink(Timer* t) noexcept {
+        Slot& s = slots_[t->level][t->slot];
+        if (t->prev) {
+            t->prev->next = t->next;
+        } else {
+            s.head = t->next;
+        }
+        if (t->next) {
+            t->next->prev = t->prev;
+        } else {
+            s.tail = t->prev;
+        }
+        if (!s.head) {
+            occupied_[t->level] &= ~(1ULL << t->slot);
+        }
+        t->prev = t->next = nullptr;
+    }
+    
+    // Earliest non-empty slot: level, slot index and the tick its range starts at
+    bool find_next(unsigned& level, unsigned& slot, uint64_t& when) const noexcept {
+        for (unsigned k = 0; k < LEVELS; ++k) {
+            uint64_t occ = occupied_[k];
+            if (!occ) continue;
+            
+            unsigned shift = k * SLOT_BITS;
+            unsigned digit = (now_ >> shift) & (SLOTS - 1);
+            uint64_t ahead = occ & (~0ULL << digit);
+            unsigned s = __builtin_ctzll(ahead ? ahead : occ);
+            
+            unsigned high_shift = shift + SLOT_BITS;
+            uint64_t base = high_shift >= 64 ? 0 : (now_ >> high_shift) << high_shift;
+            when = base | (static_cast<uint64_t>(s) << shift);
+            if (when < now_) when = now_;
+            
+            level = k;
+            slot = s;
+            return true;
+        }
+        return false;
+    }
+    
+    // Re-file a higher-level slot relative to the (advanced) current time
+    void cascade(unsigned level, unsigned slot) noexcept {
+        Slot& s = slots_[level][slot];
+        while (Timer* t = s.head) {
+            unlink(t);
+            link(t);
+        }
+    }
+    
+    // Fire every timer in the level-0 slot for the current tick. Timers are
+    // unlinked and released before the callback, so the callback may freely
+    // schedule or cancel other timers (including ones due this same tick).
+    template<typename Fn>
+    size_t fire_slot(unsigned slot, Fn& fn) {
+        Slot& s = slots_[0][slot];
+        size_t fired = 0;
+        while (Timer* t = s.head) {
+            unlink(t);
+            T value = t->value;
+            uint64_t deadline = t->deadline;
+            pool_.deallocate(t);
+            --size_;
+            ++fired;
+            fn(value, deadline);
+        }
+        return fired;
+    }
+
+public:
+    explicit TimerWheel(uint64_t start_tick = 0, size_t initial_blocks = 1)
+        : now_(start_tick), size_(0), pool_(initial_blocks) {
+        for (unsigned k = 0; k < LEVELS; ++k) {
+            occupied_[k] = 0;
+        }
+    }
+    
+    ~TimerWheel() {
+        clear();
+    }
+    
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+    
+    // Schedule a timer; deadlines in the past fire on the next advance
+    Handle schedule(uint64_t deadline, const T& value) {
+        if (deadline < now_) deadline = now_;
+        Timer* t = pool_.allocate(value, deadline);
+        link(t);
+        ++size_;
+        return t;
+    }
+    
+    // Cancel a pending timer (the handle must not have fired yet)
+    void cancel(Handle t) noexcept {
+        if (!t) return;
+        unlink(t);
+        pool_.deallocate(t);
+        --size_;
+    }
+    
+    // Fire every timer with deadline <= target, in deadline order, then move
+    // the wheel's clock to target. fn(T& value, uint64_t deadline)
+    template<typename Fn>
+    size_t advance(uint64_t target, Fn&& fn) {
+        size_t fired = 0;
+        unsigned level, slot;
+        uint64_t when;
+        while (size_ && find_next(level, slot, when) && when <= target) {
+            now_ = when;
+            if (level == 0) {
+                fired += fire_slot(slot, fn);
+            } else {
+                cascade(level, slot);
+            }
+        }
+        if (target > now_) now_ = target;
+        return fired;
+    }
+    
+    // Jump to the next pending tick and fire everything due on it
+    // Returns the number of timers fired (0 when the wheel is empty)
+    template<typename Fn>
+    size_t run_next(Fn&& fn) {
+        unsigned level, slot;
+        uint64_t when;
+        while (size_ && find_next(level, slot, when)) {
+            now_ = when;
+            if (level == 0) {
+                return fire_slot(slot, fn);
+            }
+            cascade(level, slot);
+        }
+        return 0;
+    }
+    
+    // Lower bound on the next deadline (exact when it is within 64 ticks)
+    bool next_deadline_hint(uint64_t& when) const noexcept {
+        unsigned level, slot;
+        return size_ && find_next(level, slot, when);
+    }
+    
+    void clear() noexcept {
+        for (unsigned k = 0; k < LEVELS; ++k) {
+            while (occupied_[k]) {
+                unsigned slot = __builtin_ctzll(occupied_[k]);
+                Slot& s = slots_[k][slot];
+                while (Timer* t = s.head) {
+                    unlink(t);
+                    pool_.deallocate(t);
+                }
+            }
+        }
+        size_ = 0;
+    }
+    
+    uint64_t now() const noexcept { return now_; }
+    size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+};
+
+} // namespace orderbook
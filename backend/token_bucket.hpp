@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <algorithm>
+
+namespace OrderBookNS {
+
+// Token bucket rate limiter
+// Holds up to `burst` tokens and refills at `rate` tokens per second. Callers
+// never wait: try_acquire fails immediately and time_until_available tells a
+// scheduler when to come back.
+class TokenBucket {
+public:
+    using Clock = std::chrono::steady_clock;
+    
+    TokenBucket(double rate_per_second, double burst)
+        : rate_(rate_per_second), burst_(burst), tokens_(burst), last_(Clock::now()) {}
+    
+    bool try_acquire(double tokens = 1.0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refill(Clock::now());
+        if (tokens_ < tokens) {
+            return false;
+        }
+        tokens_ -= tokens;
+        return true;
+    }
+    
+    // Zero when a token is available now
+    Clock::duration time_until_available(double tokens = 1.0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refill(Clock::now());
+        if (tokens_ >= tokens) {
+            return Clock::duration::zero();
+        }
+        if (rate_ <= 0.0) {
+            return std::chrono::hours(1);  // Never refills; check back rarely
+        }
+        return std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>((tokens - tokens_) / rate_));
+    }
+    
+    double available() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refill(Clock::now());
+        return tokens_;
+    }
+    
+    double rate() const { return rate_; }
+    double burst() const { return burst_; }
+
+private:
+    std::mutex mutex_;
+    double rate_;
+    double burst_;
+    double tokens_;
+    Clock::time_point last_;
+    
+    void refill(Clock::time_point now) {
+        double elapsed = std::chrono::duration<double>(now - last_).count();
+        tokens_ = std::min(burst_, tokens_ + elapsed * rate_);
+        last_ = now;
+    }
+};
+
+} // namespace OrderBookNS
@@ -0,0 +1,195 @@
+#include "trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <thread>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+namespace OrderBookNS {
+
+namespace {
+
+constexpr uint64_t MIN_CALIBRATION_NS = 10000000;  // 10 ms
+
+uint64_t steady_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+size_t round_up(size_t n) {
+    size_t size = 2;
+    while (size < n) size <<= 1;
+    return size;
+}
+
+void write_json_string(std::FILE* file, const char* text) {
+    std::fputc('"', file);
+    for (const char* p = text; *p; ++p) {
+        if (*p == '"' || *p == '\\') {
+            std::fputc('\\', file);
+            std::fputc(*p, file);
+        } else if (static_cast<unsigned char>(*p) < 0x20) {
+            std::fprintf(file, "\\u%04x", static_cast<unsigned>(*p));
+        } else {
+            std::fputc(*p, file);
+        }
+    }
+    std::fputc('"', file);
+}
+
+} // namespace
+
+thread_local TraceRing* Tracer::thread_ring_ = nullptr;
+
+TraceRing::TraceRing(size_t capacity, pthread_t thread, int thread_id)
+    : events_(new TraceEvent[round_up(capacity)]()), mask_(round_up(capacity) - 1),
+      thread_(thread), thread_id_(thread_id) {}
+
+void TraceRing::copy(std::vector<TraceEvent>& out) const {
+    const uint64_t size = mask_ + 1;
+    uint64_t head = head_.load(std::memory_order_acquire);
+    uint64_t first = head > size ? head - size : 0;
+    size_t start = out.size();
+    for (uint64_t i = first; i < head; ++i) {
+        out.push_back(events_[i & mask_]);
+    }
+    
+    // The owner kept pushing during the copy: drop the slots it has reused
+    // (or may be writing now)
+    uint64_t now = head_.load(std::memory_order_acquire);
+    uint64_t intact = now + 1 > size ? now + 1 - size : 0;
+    if (intact > first) {
+        size_t stale = static_cast<size_t>(std::min(intact - first, head - first));
+        out.erase(out.begin() + static_cast<std::ptrdiff_t>(start),
+                  out.begin() + static_cast<std::ptrdiff_t>(start + stale));
+    }
+}
+
+Tracer& Tracer::global() {
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::Tracer() : origin_tsc_(now_tsc()), origin_ns_(steady_ns()) {}
+
+TraceRing& Tracer::register_thread() {
+    // Runs as the thread exits; until it has, dump() may still read the name
+    struct Exit {
+        TraceRing* ring = nullptr;
+        ~Exit() {
+            if (!ring) return;
+            char name[16] = {};
+            pthread_getname_np(pthread_self(), name, sizeof(name));
+            Tracer& tracer = Tracer::global();
+            std::lock_guard<std::mutex> lock(tracer.rings_mutex_);
+            ring->exit_name_ = name;
+            ring->exited_ = true;
+        }
+    };
+    static thread_local Exit exit;
+    
+    int tid = static_cast<int>(::syscall(SYS_gettid));
+    auto ring = std::make_shared<TraceRing>(RING_EVENTS, pthread_self(), tid);
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    rings_.push_back(ring);
+    thread_ring_ = ring.get();
+    exit.ring = thread_ring_;
+    return *thread_ring_;
+}
+
+std::string Tracer::thread_name(const TraceRing& ring) const {
+    if (ring.exited_) {
+        return ring.exit_name_;
+    }
+    char name[16] = {};
+    pthread_getname_np(ring.thread_, name, sizeof(name));
+    return name;
+}
+
+uint64_t Tracer::recorded() const {
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    uint64_t total = 0;
+    for (const auto& ring : rings_) {
+        total += ring->recorded();
+    }
+    return total;
+}
+
+std::string Tracer::dump_path(const std::string& program, const std::string& dir) {
+    std::time_t now = std::time(nullptr);
+    std::tm local{};
+    localtime_r(&now, &local);
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &local);
+    return dir + "/" + program + "-" + stamp + ".json";
+}
+
+double Tracer::ticks_per_us() {
+    uint64_t elapsed_ns = steady_ns() - origin_ns_;
+    if (elapsed_ns < MIN_CALIBRATION_NS) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(MIN_CALIBRATION_NS - elapsed_ns));
+    }
+    uint64_t tsc = now_tsc();
+    elapsed_ns = steady_ns() - origin_ns_;
+    return static_cast<double>(tsc - origin_tsc_) * 1000.0 / static_cast<double>(elapsed_ns);
+}
+
+bool Tracer::dump(const std::string& path) {
+    std::vector<std::shared_ptr<TraceRing>> rings;
+    std::vector<std::string> names;
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        rings = rings_;
+        for (const auto& ring : rings) {
+            names.push_back(thread_name(*ring));
+        }
+    }
+    const double per_us = ticks_per_us();
+    
+    std::error_code error;
+    std::filesystem::path target(path);
+    if (target.has_parent_path()) {
+        std::filesystem::create_directories(target.parent_path(), error);
+    }
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        return false;
+    }
+    
+    // Chrome trace event format: one complete ("X") event per span, in
+    // microseconds since the tracer started, plus each thread's name
+    const int pid = static_cast<int>(::getpid());
+    std::fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    std::fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"orderbook\"}}", pid);
+    
+    std::vector<TraceEvent> events;
+    events.reserve(RING_EVENTS);
+    for (size_t r = 0; r < rings.size(); ++r) {
+        const auto& ring = rings[r];
+        std::fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":",
+                     pid, ring->thread_id());
+        write_json_string(file, names[r].c_str());
+        std::fprintf(file, "}}");
+        
+        events.clear();
+        ring->copy(events);
+        for (const TraceEvent& event : events) {
+            // A span can start before the tracer's first use
+            uint64_t start = event.start_tsc > origin_tsc_ ? event.start_tsc - origin_tsc_ : 0;
+            uint64_t length = event.end_tsc > event.start_tsc ? event.end_tsc - event.start_tsc : 0;
+            std::fprintf(file, ",\n{\"name\":");
+            write_json_string(file, event.name);
+            std::fprintf(file, ",\"cat\":\"orderbook\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                         pid, ring->thread_id(), static_cast<double>(start) / per_us,
+                         static_cast<double>(length) / per_us);
+        }
+    }
+    std::fprintf(file, "\n]}\n");
+    return std::fclose(file) == 0;
+}
+
+} // namespace OrderBookNS
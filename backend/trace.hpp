@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+namespace OrderBookNS {
+
+// One finished span; name is a string literal
+struct TraceEvent {
+    const char* name;
+    uint64_t start_tsc;
+    uint64_t end_tsc;
+};
+
+// Spans of one thread, newest kept: once full, each span overwrites the
+// oldest. Only the owning thread writes; dump() reads while it runs and
+// discards slots that may have been overwritten during the copy.
+class TraceRing {
+public:
+    TraceRing(size_t capacity, pthread_t thread, int thread_id);
+    
+    void push(const char* name, uint64_t start_tsc, uint64_t end_tsc) noexcept {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        events_[head & mask_] = {name, start_tsc, end_tsc};
+        head_.store(head + 1, std::memory_order_release);
+    }
+    
+    // The spans still in the ring, oldest first
+    void copy(std::vector<TraceEvent>& out) const;
+    
+    uint64_t recorded() const { return head_.load(std::memory_order_relaxed); }
+    size_t capacity() const { return static_cast<size_t>(mask_ + 1); }
+    int thread_id() const { return thread_id_; }
+    
+private:
+    friend class Tracer;
+    
+    std::unique_ptr<TraceEvent[]> events_;
+    const uint64_t mask_;
+    const pthread_t thread_;
+    const int thread_id_;
+    std::atomic<uint64_t> head_{0};   // Spans ever pushed
+    
+    // Threads are named when they enter a role, often after their first
+    // span, so the name is read at dump time and kept once the thread exits
+    // (both under Tracer::rings_mutex_)
+    std::string exit_name_;
+    bool exited_ = false;
+};
+
+// Span tracing for offline profiling
+// OB_TRACE_SCOPE("feed.fetch") records the time from that line to the end of
+// the scope: two TSC reads and a store into the calling thread's ring, no
+// locks. dump() writes every thread's spans as Chrome trace JSON, which
+// chrome://tracing and ui.perfetto.dev open directly.
+//
+// The macro is compiled out unless the build defines OB_TRACE
+// (`make TRACE=1`); the Tracer itself is always there, so dump() calls need
+// no #ifdef and write an empty trace in normal builds.
+class Tracer {
+public:
+#ifdef OB_TRACE
+    static constexpr bool ENABLED = true;
+#else
+    static constexpr bool ENABLED = false;
+#endif
+    static constexpr size_t RING_EVENTS = 1 << 14;   // Per thread
+    
+    static Tracer& global();
+    
+    static uint64_t now_tsc() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+    
+    void record(const char* name, uint64_t start_tsc, uint64_t end_tsc) noexcept {
+        thread_ring().push(name, start_tsc, end_tsc);
+    }
+    
+    // Write every thread's spans to path (creating its directory); false if
+    // the file cannot be written. Safe to call while threads keep tracing.
+    bool dump(const std::string& path);
+    
+    // Spans recorded so far, across threads (including overwritten ones)
+    uint64_t recorded() const;
+    
+    // "<dir>/<program>-YYYYmmdd-HHMMSS.json" for the current local time
+    static std::string dump_path(const std::string& program, const std::string& dir = "data/traces");
+    
+private:
+    Tracer();
+    
+    TraceRing& thread_ring() {
+        TraceRing* ring = thread_ring_;
+        return ring ? *ring : register_thread();
+    }
+    TraceRing& register_thread();
+    std::string thread_name(const TraceRing& ring) const;
+    
+    // TSC ticks per microsecond, measured against steady_clock since start
+    double ticks_per_us();
+    
+    static thread_local TraceRing* thread_ring_;
+    
+    // Rings outlive their threads so a dump at exit still sees them
+    mutable std::mutex rings_mutex_;
+    std::vector<std::shared_ptr<TraceRing>> rings_;
+    uint64_t origin_tsc_;
+    uint64_t origin_ns_;
+};
+
+// Records the enclosing scope as one span
+class TraceScope {
+public:
+    explicit TraceScope(const char* name) noexcept : name_(name), start_tsc_(Tracer::now_tsc()) {}
+    ~TraceScope() { Tracer::global().record(name_, start_tsc_, Tracer::now_tsc()); }
+    
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+    
+private:
+    const char* name_;
+    uint64_t start_tsc_;
+};
+
+} // namespace OrderBookNS
+
+#define OB_TRACE_CONCAT_(a, b) a##b
+#define OB_TRACE_CONCAT(a, b) OB_TRACE_CONCAT_(a, b)
+
+#ifdef OB_TRACE
+#define OB_TRACE_SCOPE(name) ::OrderBookNS::TraceScope OB_TRACE_CONCAT(ob_trace_scope_, __LINE__)(name)
+#else
+#define OB_TRACE_SCOPE(name) static_cast<void>(0)
+#endif
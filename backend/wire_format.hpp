@@ -0,0 +1,346 @@
+#pragma once
+
+#include "market_data.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+namespace OrderBookNS {
+namespace wire {
+
+// Compact binary encoding for quotes, trades and bars
+// Offered by the local quote server as an alternative to JSON, chosen by
+// content negotiation (Accept / Content-Type). A body or stream starts with a
+// 4-byte magic, then frames. Every frame has a 16-byte little-endian header:
+//
+//   uint16 length     whole frame, header included
+//   uint8  type       MessageType
+//   uint8  flags      0
+//   uint32 symbol     sender's symbol id (defined by a SYMBOL frame)
+//   uint64 sequence   per body/stream, +1 per frame; a jump is a gap
+//
+// followed by a fixed payload (prices in ticks, as in the order book;
+// timestamps in nanoseconds since the epoch):
+//
+//   SYMBOL     name bytes (at most MAX_SYMBOL_LENGTH)
+//   QUOTE      int64 bid, int64 ask, uint64 bid_size, uint64 ask_size, uint64 timestamp
+//   TRADE      int64 price, uint64 quantity, uint64 timestamp
+//   OHLCV      uint64 timestamp, int64 open, high, low, close, uint64 volume
+//   HEARTBEAT  (empty)
+//
+// Symbol ids are the sender's own; the decoder maps each to a local
+// SymbolId when its SYMBOL frame arrives, so records decode into the
+// existing structs with a few loads and no text parsing.
+
+constexpr const char* CONTENT_TYPE = "application/x-orderbook-wire";
+constexpr char MAGIC[4] = {'O', 'B', 'W', '1'};
+constexpr size_t MAGIC_SIZE = sizeof(MAGIC);
+constexpr size_t HEADER_SIZE = 16;
+constexpr size_t MAX_SYMBOL_LENGTH = 64;
+constexpr size_t MAX_FRAME_SIZE = HEADER_SIZE + 64;
+constexpr uint32_t MAX_SENDER_SYMBOLS = 1 << 20;
+
+enum class MessageType : uint8_t {
+    SYMBOL = 1,
+    QUOTE = 2,
+    TRADE = 3,
+    OHLCV = 4,
+    HEARTBEAT = 5
+};
+
+constexpr size_t QUOTE_PAYLOAD = 40;
+constexpr size_t TRADE_PAYLOAD = 24;
+constexpr size_t OHLCV_PAYLOAD = 48;
+
+inline bool has_magic(std::string_view body) {
+    return body.size() >= MAGIC_SIZE && std::memcmp(body.data(), MAGIC, MAGIC_SIZE) == 0;
+}
+
+// Little-endian loads and stores; plain moves on little-endian hosts
+template<typename T>
+inline T load(const char* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    if constexpr (sizeof(T) == 2) value = static_cast<T>(__builtin_bswap16(static_cast<uint16_t>(value)));
+    if constexpr (sizeof(T) == 4) value = static_cast<T>(__builtin_bswap32(static_cast<uint32_t>(value)));
+    if constexpr (sizeof(T) == 8) value = static_cast<T>(__builtin_bswap64(static_cast<uint64_t>(value)));
+#endif
+    return value;
+}
+
+template<typename T>
+inline void store(std::string& out, T value) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    if constexpr (sizeof(T) == 2) value = static_cast<T>(__builtin_bswap16(static_cast<uint16_t>(value)));
+    if constexpr (sizeof(T) == 4) value = static_cast<T>(__builtin_bswap32(static_cast<uint32_t>(value)));
+    if constexpr (sizeof(T) == 8) value = static_cast<T>(__builtin_bswap64(static_cast<uint64_t>(value)));
+#endif
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+// Writes frames into a string (the server does the same in Python)
+class Encoder {
+public:
+    Encoder() : sequence_(0) {}
+    
+    void begin(std::string& out) {
+        out.append(MAGIC, MAGIC_SIZE);
+        sequence_ = 0;
+        defined_.clear();
+    }
+    
+    void quote(std::string& out, SymbolId symbol, const Quote& quote) {
+        define(out, symbol);
+        header(out, MessageType::QUOTE, symbol, QUOTE_PAYLOAD);
+        store<int64_t>(out, quote.bid_price);
+        store<int64_t>(out, quote.ask_price);
+        store<uint64_t>(out, quote.bid_size);
+        store<uint64_t>(out, quote.ask_size);
+        store<uint64_t>(out, quote.timestamp);
+    }
+    
+    void trade(std::string& out, SymbolId symbol, const Trade& trade) {
+        define(out, symbol);
+        header(out, MessageType::TRADE, symbol, TRADE_PAYLOAD);
+        store<int64_t>(out, trade.price);
+        store<uint64_t>(out, trade.quantity);
+        store<uint64_t>(out, trade.timestamp);
+    }
+    
+    void ohlcv(std::string& out, SymbolId symbol, const OHLCV& bar) {
+        define(out, symbol);
+        header(out, MessageType::OHLCV, symbol, OHLCV_PAYLOAD);
+        store<uint64_t>(out, bar.timestamp);
+        store<int64_t>(out, bar.open);
+        store<int64_t>(out, bar.high);
+        store<int64_t>(out, bar.low);
+        store<int64_t>(out, bar.close);
+        store<uint64_t>(out, bar.volume);
+    }
+    
+private:
+    uint64_t sequence_;
+    std::vector<bool> defined_;  // By SymbolId
+    
+    void header(std::string& out, MessageType type, uint32_t symbol, size_t payload) {
+        store<uint16_t>(out, static_cast<uint16_t>(HEADER_SIZE + payload));
+        store<uint8_t>(out, static_cast<uint8_t>(type));
+        store<uint8_t>(out, 0);
+        store<uint32_t>(out, symbol);
+        store<uint64_t>(out, sequence_++);
+    }
+    
+    void define(std::string& out, SymbolId symbol) {
+        if (symbol < defined_.size() && defined_[symbol]) return;
+        if (symbol >= defined_.size()) defined_.resize(symbol + 1, false);
+        defined_[symbol] = true;
+        
+        const std::string& name = SymbolTable::global().name(symbol);
+        size_t length = std::min(name.size(), MAX_SYMBOL_LENGTH);
+        header(out, MessageType::SYMBOL, symbol, length);
+        out.append(name.data(), length);
+    }
+};
+
+// Incremental decoder
+// feed() accepts bytes in any split (a stream's chunks, or a whole body) and
+// calls the handler for each complete record:
+//   handler.on_quote(const SymbolQuote&)
+//   handler.on_trade(SymbolId, const Trade&)
+//   handler.on_ohlcv(SymbolId, const OHLCV&)
+// The records passed are reused between calls. A frame split across chunks
+// is carried over in a small fixed buffer, so feeding allocates only when a
+// new symbol is defined.
+// By default SYMBOL frames intern their names (a response to our own request
+// names what we asked for). With intern_symbols false only names already in
+// the SymbolTable are mapped; records for any other symbol are skipped, so a
+// stream cannot grow the table.
+class Decoder {
+public:
+    explicit Decoder(bool intern_symbols = true) : intern_symbols_(intern_symbols) { reset(); }
+    
+    // Start of a new body or connection (sender ids and sequence restart)
+    void reset() {
+        magic_seen_ = 0;
+        partial_size_ = 0;
+        expect_sequence_ = false;
+        next_sequence_ = 0;
+        failed_ = false;
+        symbols_.clear();
+    }
+    
+    // False once the input is unusable (bad magic or frame length); the
+    // caller should drop the connection
+    template<typename Handler>
+    bool feed(const char* data, size_t length, Handler& handler) {
+        if (failed_) return false;
+        
+        // Magic, possibly split across chunks
+        while (magic_seen_ < MAGIC_SIZE && length > 0) {
+            if (*data != MAGIC[magic_seen_]) return fail();
+            ++magic_seen_;
+            ++data;
+            --length;
+        }
+        
+        // Finish a frame left over from the previous chunk
+        if (partial_size_ > 0) {
+            size_t need = partial_size_ < 2 ? 2 - partial_size_ : 0;
+            size_t take = std::min(need, length);
+            std::memcpy(partial_ + partial_size_, data, take);
+            partial_size_ += take;
+            data += take;
+            length -= take;
+            if (partial_size_ < 2) return true;
+            
+            size_t frame = load<uint16_t>(partial_);
+            if (frame < HEADER_SIZE || frame > MAX_FRAME_SIZE) return fail();
+            take = std::min(frame - partial_size_, length);
+            std::memcpy(partial_ + partial_size_, data, take);
+            partial_size_ += take;
+            data += take;
+            length -= take;
+            if (partial_size_ < frame) return true;
+            
+            decode(partial_, frame, handler);
+            partial_size_ = 0;
+        }
+        
+        // Whole frames straight from the input
+        while (length >= 2) {
+            size_t frame = load<uint16_t>(data);
+            if (frame < HEADER_SIZE || frame > MAX_FRAME_SIZE) return fail();
+            if (length < frame) break;
+            decode(data, frame, handler);
+            data += frame;
+            length -= frame;
+        }
+        
+        std::memcpy(partial_, data, length);
+        partial_size_ = length;
+        return true;
+    }
+    
+    uint64_t messages() const { return messages_; }
+    uint64_t gaps() const { return gaps_; }          // Frames missing by sequence number
+    uint64_t malformed() const { return malformed_; }
+    
+private:
+    static constexpr SymbolId UNKNOWN_SYMBOL = INVALID_SYMBOL - 1;  // Defined, but not in the table
+    
+    bool intern_symbols_;
+    size_t magic_seen_;
+    char partial_[MAX_FRAME_SIZE];
+    size_t partial_size_;
+    bool expect_sequence_;
+    uint64_t next_sequence_;
+    bool failed_;
+    std::vector<SymbolId> symbols_;  // Sender id -> local id
+    
+    uint64_t messages_ = 0;
+    uint64_t gaps_ = 0;
+    uint64_t malformed_ = 0;
+    
+    SymbolQuote quote_;
+    Trade trade_;
+    OHLCV bar_;
+    
+    bool fail() {
+        failed_ = true;
+        ++malformed_;
+        return false;
+    }
+    
+    SymbolId local(uint32_t sender) const {
+        return sender < symbols_.size() ? symbols_[sender] : INVALID_SYMBOL;
+    }
+    
+    template<typename Handler>
+    void decode(const char* p, size_t frame, Handler& handler) {
+        auto type = static_cast<MessageType>(static_cast<uint8_t>(p[2]));
+        uint32_t sender = load<uint32_t>(p + 4);
+        uint64_t sequence = load<uint64_t>(p + 8);
+        const char* payload = p + HEADER_SIZE;
+        size_t payload_size = frame - HEADER_SIZE;
+        
+        if (expect_sequence_ && sequence != next_sequence_) {
+            gaps_ += sequence > next_sequence_ ? sequence - next_sequence_ : 1;
+        }
+        expect_sequence_ = true;
+        next_sequence_ = sequence + 1;
+        ++messages_;
+        
+        switch (type) {
+            case MessageType::SYMBOL: {
+                if (sender >= MAX_SENDER_SYMBOLS || payload_size == 0 || payload_size > MAX_SYMBOL_LENGTH) {
+                    ++malformed_;
+                    return;
+                }
+                if (sender >= symbols_.size()) symbols_.resize(sender + 1, INVALID_SYMBOL);
+                std::string_view name(payload, payload_size);
+                SymbolId id = intern_symbols_ ? SymbolTable::global().intern(name) : SymbolTable::global().find(name);
+                symbols_[sender] = id == INVALID_SYMBOL ? UNKNOWN_SYMBOL : id;
+                return;
+            }
+            case MessageType::QUOTE: {
+                SymbolId id = local(sender);
+                if (id == INVALID_SYMBOL || payload_size != QUOTE_PAYLOAD) break;
+                if (id == UNKNOWN_SYMBOL) return;
+                Quote& quote = quote_.quote;
+                quote_.symbol = id;
+                quote.symbol = SymbolTable::global().name(id);
+                quote.bid_price = load<int64_t>(payload);
+                quote.ask_price = load<int64_t>(payload + 8);
+                quote.bid_size = load<uint64_t>(payload + 16);
+                quote.ask_size = load<uint64_t>(payload + 24);
+                quote.timestamp = load<uint64_t>(payload + 32);
+                handler.on_quote(quote_);
+                return;
+            }
+            case MessageType::TRADE: {
+                SymbolId id = local(sender);
+                if (id == INVALID_SYMBOL || payload_size != TRADE_PAYLOAD) break;
+                if (id == UNKNOWN_SYMBOL) return;
+                trade_.symbol = SymbolTable::global().name(id);
+                trade_.price = load<int64_t>(payload);
+                trade_.quantity = load<uint64_t>(payload + 8);
+                trade_.timestamp = load<uint64_t>(payload + 16);
+                handler.on_trade(id, trade_);
+                return;
+            }
+            case MessageType::OHLCV: {
+                SymbolId id = local(sender);
+                if (id == INVALID_SYMBOL || payload_size != OHLCV_PAYLOAD) break;
+                if (id == UNKNOWN_SYMBOL) return;
+                bar_.symbol = SymbolTable::global().name(id);
+                bar_.timestamp = load<uint64_t>(payload);
+                bar_.open = load<int64_t>(payload + 8);
+                bar_.high = load<int64_t>(payload + 16);
+                bar_.low = load<int64_t>(payload + 24);
+                bar_.close = load<int64_t>(payload + 32);
+                bar_.volume = load<uint64_t>(payload + 40);
+                handler.on_ohlcv(id, bar_);
+                return;
+            }
+            case MessageType::HEARTBEAT:
+                return;
+        }
+        ++malformed_;  // Unknown type, undefined symbol or wrong payload size
+    }
+};
+
+// Handler base with no-op callbacks; derive and override what you need
+struct Handler {
+    void on_quote(const SymbolQuote&) {}
+    void on_trade(SymbolId, const Trade&) {}
+    void on_ohlcv(SymbolId, const OHLCV&) {}
+};
+
+} // namespace wire
+} // namespace OrderBookNS
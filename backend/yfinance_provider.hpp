@@ -1,64 +1,147 @@
 #pragma once
 
 #include "market_data.hpp"
-#include <iostream>
-#include <sstream>
-#include <json/json.h>
+#include "json_extract.hpp"
+#include "wire_format.hpp"
 
 namespace OrderBookNS {
 
 // YFinance provider that connects to local Python server
+// Asks for the binary wire format (wire_format.hpp) and accepts JSON from
+// servers that don't offer it; bodies identify themselves by their magic.
 class YFinanceProvider : public IMarketDataProvider {
 private:
     HTTPClient client_;
     std::string server_url_;
+    bool wire_format_;
+    
+    // Collects decoded quotes from a wire body
+    struct QuoteCollector : wire::Handler {
+        std::vector<SymbolQuote>& quotes;
+        size_t added = 0;
+        explicit QuoteCollector(std::vector<SymbolQuote>& out) : quotes(out) {}
+        void on_quote(const SymbolQuote& quote) {
+            quotes.push_back(quote);
+            ++added;
+        }
+    };
+    
+    void negotiate(HTTPRequest& request) const {
+        request.headers["Accept"] = wire_format_
+            ? std::string(wire::CONTENT_TYPE) + ", application/json;q=0.5"
+            : std::string("application/json");
+    }
+    
+    static size_t decode_wire(const std::string& body, std::vector<SymbolQuote>& quotes) {
+        wire::Decoder decoder;
+        QuoteCollector collector(quotes);
+        decoder.feed(body.data(), body.size(), collector);
+        return collector.added;
+    }
     
 public:
     YFinanceProvider(const std::string& server_url = "http://localhost:8080")
-        : server_url_(server_url) {
+        : server_url_(server_url), wire_format_(true) {
         client_.set_timeout(5);
     }
     
+    // Request the binary wire format (default) or plain JSON
+    void set_wire_format(bool enabled) { wire_format_ = enabled; }
+    
     std::string get_name() const override {
         return "YFinance (Local Server)";
     }
     
+    std::string endpoint() const override {
+        return server_url_;
+    }
+    
     bool is_available() const override {
         // Simple health check
         return true; // Assume available if constructed
     }
     
     bool get_quote(const std::string& symbol, Quote& quote) override {
-        std::string url = server_url_ + "/quote?symbol=" + symbol;
+        HTTPRequest request;
         std::string response;
         
-        if (!client_.get(url, response)) {
+        if (!build_quote_request(symbol, request) || !client_.get(request.url, response, request.headers)) {
             return false;
         }
         
-        try {
-            Json::Value root;
-            Json::CharReaderBuilder builder;
-            std::istringstream stream(response);
-            std::string errs;
-            
-            if (!Json::parseFromStream(builder, stream, &root, &errs)) {
-                std::cerr << "Failed to parse JSON: " << errs << std::endl;
-                return false;
-            }
-            
-            quote.symbol = root["symbol"].asString();
-            quote.bid_price = root["bid_price"].asInt64();
-            quote.ask_price = root["ask_price"].asInt64();
-            quote.bid_size = root["bid_size"].asUInt64();
-            quote.ask_size = root["ask_size"].asUInt64();
-            quote.timestamp = root["timestamp"].asUInt64();
-            
+        return parse_quote(symbol, response, quote);
+    }
+    
+    bool supports_async_quotes() const override { return true; }
+    
+    bool build_quote_request(const std::string& symbol, HTTPRequest& request) override {
+        request.url = server_url_ + "/quote?symbol=" + symbol;
+        negotiate(request);
+        return true;
+    }
+    
+    bool parse_quote(const std::string&, const std::string& body, Quote& quote) const override {
+        if (wire::has_magic(body)) {
+            std::vector<SymbolQuote> quotes;
+            if (decode_wire(body, quotes) == 0) return false;
+            quote = std::move(quotes.front().quote);
             return true;
-        } catch (const std::exception& e) {
-            std::cerr << "Error parsing quote: " << e.what() << std::endl;
+        }
+        return parse_quote_object(JsonView::parse(body), quote);
+    }
+    
+    // One quote object, as served by /quote and inside /quotes
+    static bool parse_quote_object(JsonView root, Quote& quote) {
+        if (!root["bid_price"].is_number()) {
+            return false;
+        }
+        
+        quote.symbol = std::string(root["symbol"].as_string_view());
+        quote.bid_price = root["bid_price"].as_int64();
+        quote.ask_price = root["ask_price"].as_int64();
+        quote.bid_size = root["bid_size"].as_uint64();
+        quote.ask_size = root["ask_size"].as_uint64();
+        quote.timestamp = root["timestamp"].as_uint64() * 1000000000ULL; // Server sends epoch seconds
+        
+        return true;
+    }
+    
+    // /quotes?symbols=A,B,C answers with an array of /quote objects
+    size_t max_batch_quotes() const override { return 500; }
+    
+    bool build_batch_quote_request(const std::vector<SymbolId>& symbols, HTTPRequest& request) override {
+        if (symbols.empty() || symbols.size() > max_batch_quotes()) {
             return false;
         }
+        request.url = server_url_ + "/quotes?symbols=" + SymbolTable::global().join(symbols);
+        negotiate(request);
+        return true;
+    }
+    
+    size_t parse_batch_quotes(const std::string& body, std::vector<SymbolQuote>& quotes) const override {
+        if (wire::has_magic(body)) {
+            return decode_wire(body, quotes);
+        }
+        
+        const SymbolTable& table = SymbolTable::global();
+        auto elements = JsonView::parse(body).elements();
+        JsonView entry;
+        size_t added = 0;
+        while (elements.next(entry)) {
+            SymbolId id = table.find(entry["symbol"].as_string_view());
+            SymbolQuote result{id, Quote()};
+            if (id != INVALID_SYMBOL && parse_quote_object(entry, result.quote)) {
+                quotes.push_back(std::move(result));
+                ++added;
+            }
+        }
+        return added;
+    }
+    
+    size_t get_quotes(const std::vector<SymbolId>& symbols, std::vector<SymbolQuote>& quotes) override {
+        return get_quotes_batched(symbols, quotes, [this](const HTTPRequest& request, std::string& body) {
+            return client_.get(request.url, body, request.headers);
+        });
     }
     
     bool get_trades(const std::string&, std::vector<Trade>&, int) override {
@@ -1,15 +1,28 @@
 #pragma once
 
+#include "../backend/orderbook.hpp"
+#include "../backend/thread_topology.hpp"
+#include "../backend/async_logger.hpp"
 #include <string>
 #include <map>
+#include <vector>
 #include <fstream>
+#include <cstdint>
+#include <sched.h>
 #include <json/json.h>
 
 namespace OrderBookNS {
 
+// Sizes fixed at startup; everything is preallocated before the first order
+struct CapacityConfig {
+    orderbook::BookCapacity book;
+    size_t ladder_levels = 10;        // Synthetic ladder levels per side (orderbook_ui)
+    size_t record_queue = 1 << 16;    // Tick recorder queue
+};
+
 class ConfigLoader {
 public:
-    ConfigLoader() : loaded_(false) {}
+    ConfigLoader() : loaded_(false), cache_dir_("data/bars"), record_dir_(), metrics_port_(9464) {}
     
     bool load(const std::string& config_file = "config/config.json") {
         std::ifstream file(config_file);
@@ -53,10 +66,73 @@ public:
             timeout_seconds_ = 10;
         }
         
+        // On-disk bar cache; an explicit empty string turns it off
+        if (root["market_data"].isMember("cache_dir")) {
+            cache_dir_ = root["market_data"]["cache_dir"].asString();
+        }
+        
+        // Session tick recording; an explicit empty string turns it off
+        if (root["market_data"].isMember("record_dir")) {
+            record_dir_ = root["market_data"]["record_dir"].asString();
+        }
+        
+        load_capacity(root["capacity"]);
+        load_threads(root["threads"]);
+        load_logging(root["logging"]);
+        load_metrics(root["metrics"]);
+        
         loaded_ = true;
         return true;
     }
     
+    // Check capacities and thread placement against this machine; call once
+    // at startup, before anything is sized from the config. Problems found
+    // while loading (unknown keys, wrong types) are reported here too.
+    bool validate(std::vector<std::string>& errors) const {
+        errors = errors_;
+        CapacityConfig capacity = capacity_;
+        for (const auto& limit : capacity_limits()) {
+            size_t value = limit.field(capacity);
+            if (value < limit.min || value > limit.max) {
+                errors.push_back("capacity." + std::string(limit.name) + " = " + std::to_string(value) +
+                                 " is outside [" + std::to_string(limit.min) + ", " +
+                                 std::to_string(limit.max) + "]");
+            }
+        }
+        
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        bool have_mask = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+        for (const auto& [role, placement] : threads_) {
+            std::string where = std::string("threads.") + role_name(role);
+            if (placement.cpu >= 0 && have_mask &&
+                (placement.cpu >= CPU_SETSIZE || !CPU_ISSET(placement.cpu, &allowed))) {
+                errors.push_back(where + ".cpu = " + std::to_string(placement.cpu) +
+                                 " is not available to this process");
+            }
+            if (placement.numa_node >= 0) {
+                cpu_set_t cpus;
+                if (!numa_node_cpus(placement.numa_node, cpus)) {
+                    errors.push_back(where + ".numa_node = " + std::to_string(placement.numa_node) +
+                                     " does not exist");
+                } else if (placement.cpu >= 0 &&
+                           (placement.cpu >= CPU_SETSIZE || !CPU_ISSET(placement.cpu, &cpus))) {
+                    errors.push_back(where + ".cpu = " + std::to_string(placement.cpu) +
+                                     " is not on NUMA node " + std::to_string(placement.numa_node));
+                }
+            }
+            if (placement.fifo_priority > 0 && placement.fifo_priority > sched_get_priority_max(SCHED_FIFO)) {
+                errors.push_back(where + ".fifo_priority = " + std::to_string(placement.fifo_priority) +
+                                 " is above the SCHED_FIFO maximum " +
+                                 std::to_string(sched_get_priority_max(SCHED_FIFO)));
+            }
+            if (placement.wait == WaitMode::SPIN_PARK && placement.sleep_us == 0) {
+                errors.push_back(where + ".sleep_us must be positive with wait = spin_park");
+            }
+        }
+        return errors.empty();
+    }
+    
     bool is_loaded() const { return loaded_; }
     
     const std::string& get_alpha_vantage_key() const { return alpha_vantage_key_; }
@@ -65,8 +141,190 @@ public:
     const std::string& get_default_symbol() const { return default_symbol_; }
     int get_update_interval_ms() const { return update_interval_ms_; }
     int get_timeout_seconds() const { return timeout_seconds_; }
+    const std::string& get_cache_dir() const { return cache_dir_; }
+    const std::string& get_record_dir() const { return record_dir_; }
+    const CapacityConfig& get_capacity() const { return capacity_; }
+    // Async log settings; an empty file turns logging off
+    const LogConfig& get_logging() const { return logging_; }
+    // Port of the Prometheus endpoint on 127.0.0.1; 0 turns it off
+    uint16_t get_metrics_port() const { return metrics_port_; }
+    
+    // Placement of a role; roles not in the config run unpinned with the
+    // role's default pacing
+    ThreadRoleConfig get_thread(ThreadRole role) const {
+        auto it = threads_.find(role);
+        return it == threads_.end() ? ThreadRoleConfig::defaults(role) : it->second;
+    }
+    
+    // Hand every role's placement to the topology; call after validate()
+    // and before any thread starts
+    void configure_threads(ThreadTopology& topology) const {
+        for (size_t i = 0; i < THREAD_ROLE_COUNT; ++i) {
+            ThreadRole role = static_cast<ThreadRole>(i);
+            topology.configure(role, get_thread(role));
+        }
+    }
     
 private:
+    // A "capacity" key, the field it sets and its accepted range
+    struct CapacityLimit {
+        const char* name;
+        size_t& (*field)(CapacityConfig&);
+        size_t min;
+        size_t max;
+    };
+    
+    static const std::vector<CapacityLimit>& capacity_limits() {
+        static const std::vector<CapacityLimit> limits{
+            {"orders", [](CapacityConfig& c) -> size_t& { return c.book.orders; }, 1, size_t(1) << 30},
+            {"price_levels", [](CapacityConfig& c) -> size_t& { return c.book.price_levels; }, 1, size_t(1) << 30},
+            {"expiries", [](CapacityConfig& c) -> size_t& { return c.book.expiries; }, 0, size_t(1) << 30},
+            {"recent_trades", [](CapacityConfig& c) -> size_t& { return c.book.recent_trades; }, 1, size_t(1) << 20},
+            {"depth_levels", [](CapacityConfig& c) -> size_t& { return c.book.depth_levels; }, 1, 1000},
+            {"ladder_levels", [](CapacityConfig& c) -> size_t& { return c.ladder_levels; }, 1, 1000},
+            {"record_queue", [](CapacityConfig& c) -> size_t& { return c.record_queue; }, 2, size_t(1) << 26},
+        };
+        return limits;
+    }
+    
+    // Unsigned integer member, or an error if it is anything else
+    bool read_size(const Json::Value& value, const std::string& key, size_t& out) {
+        if (!value.isIntegral() || (value.isInt64() && value.asInt64() < 0)) {
+            errors_.push_back(key + " must be a non-negative integer");
+            return false;
+        }
+        out = static_cast<size_t>(value.asUInt64());
+        return true;
+    }
+    
+    void load_capacity(const Json::Value& section) {
+        if (section.isNull()) return;
+        if (!section.isObject()) {
+            errors_.push_back("capacity must be an object");
+            return;
+        }
+        for (const auto& key : section.getMemberNames()) {
+            std::string where = "capacity." + key;
+            bool known = false;
+            for (const auto& limit : capacity_limits()) {
+                if (key == limit.name) {
+                    read_size(section[key], where, limit.field(capacity_));
+                    known = true;
+                }
+            }
+            if (!known) {
+                errors_.push_back("unknown setting " + where);
+            }
+        }
+    }
+    
+    void load_threads(const Json::Value& section) {
+        if (section.isNull()) return;
+        if (!section.isObject()) {
+            errors_.push_back("threads must be an object");
+            return;
+        }
+        for (const auto& name : section.getMemberNames()) {
+            std::string where = "threads." + name;
+            ThreadRole role;
+            bool known = parse_role(name, role);
+            const Json::Value& entry = section[name];
+            if (!known || !entry.isObject()) {
+                errors_.push_back(known ? where + " must be an object" : "unknown thread role " + where);
+                continue;
+            }
+            
+            ThreadRoleConfig placement = ThreadRoleConfig::defaults(role);
+            for (const auto& key : entry.getMemberNames()) {
+                const Json::Value& value = entry[key];
+                std::string setting = where + "." + key;
+                if (key == "cpu" || key == "numa_node") {
+                    int& field = key == "cpu" ? placement.cpu : placement.numa_node;
+                    if (!value.isInt() || value.asInt() < -1) {
+                        errors_.push_back(setting + " must be an integer >= -1");
+                    } else {
+                        field = value.asInt();
+                    }
+                } else if (key == "fifo_priority") {
+                    if (!value.isInt() || value.asInt() < 0 || value.asInt() > 99) {
+                        errors_.push_back(setting + " must be an integer in [0, 99]");
+                    } else {
+                        placement.fifo_priority = value.asInt();
+                    }
+                } else if (key == "spin_us" || key == "sleep_us") {
+                    uint32_t& field = key == "spin_us" ? placement.spin_us : placement.sleep_us;
+                    if (!value.isUInt() || value.asUInt() > 10000000) {
+                        errors_.push_back(setting + " must be an integer in [0, 10000000]");
+                    } else {
+                        field = value.asUInt();
+                    }
+                } else if (key == "wait") {
+                    if (!value.isString() || !parse_wait_mode(value.asString(), placement.wait)) {
+                        errors_.push_back(setting + " must be one of sleep, spin_park, busy_poll");
+                    }
+                } else {
+                    errors_.push_back("unknown setting " + setting);
+                }
+            }
+            threads_[role] = placement;
+        }
+    }
+    
+    void load_logging(const Json::Value& section) {
+        if (section.isNull()) return;
+        if (!section.isObject()) {
+            errors_.push_back("logging must be an object");
+            return;
+        }
+        for (const auto& key : section.getMemberNames()) {
+            const Json::Value& value = section[key];
+            std::string setting = "logging." + key;
+            if (key == "file") {
+                if (!value.isString()) {
+                    errors_.push_back(setting + " must be a string");
+                } else {
+                    logging_.file = value.asString();
+                }
+            } else if (key == "level") {
+                if (!value.isString() || !parse_log_level(value.asString(), logging_.level)) {
+                    errors_.push_back(setting + " must be one of debug, info, warn, error, off");
+                }
+            } else if (key == "max_bytes" || key == "max_files" || key == "ring_records") {
+                size_t& field = key == "max_bytes" ? logging_.max_bytes
+                              : key == "max_files" ? logging_.max_files : logging_.ring_records;
+                size_t min = key == "max_bytes" ? 4096 : key == "max_files" ? 0 : 2;
+                size_t max = key == "max_files" ? 100 : size_t(1) << 30;
+                if (read_size(value, setting, field) && (field < min || field > max)) {
+                    errors_.push_back(setting + " = " + std::to_string(field) + " is outside [" +
+                                      std::to_string(min) + ", " + std::to_string(max) + "]");
+                }
+            } else {
+                errors_.push_back("unknown setting " + setting);
+            }
+        }
+    }
+    
+    void load_metrics(const Json::Value& section) {
+        if (section.isNull()) return;
+        if (!section.isObject()) {
+            errors_.push_back("metrics must be an object");
+            return;
+        }
+        for (const auto& key : section.getMemberNames()) {
+            const Json::Value& value = section[key];
+            std::string setting = "metrics." + key;
+            if (key == "port") {
+                if (!value.isUInt() || value.asUInt() > 65535) {
+                    errors_.push_back(setting + " must be an integer in [0, 65535]");
+                } else {
+                    metrics_port_ = static_cast<uint16_t>(value.asUInt());
+                }
+            } else {
+                errors_.push_back("unknown setting " + setting);
+            }
+        }
+    }
+    
     bool loaded_;
     std::string alpha_vantage_key_;
     std::string fmp_key_;
@@ -74,6 +332,13 @@ private:
     std::string default_symbol_;
     int update_interval_ms_;
     int timeout_seconds_;
+    std::string cache_dir_;
+    std::string record_dir_;
+    CapacityConfig capacity_;
+    std::map<ThreadRole, ThreadRoleConfig> threads_;
+    LogConfig logging_;
+    uint16_t metrics_port_;
+    std::vector<std::string> errors_;
 };
 
 } // namespace OrderBookNS
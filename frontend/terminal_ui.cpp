@@ -1,16 +1,55 @@
 #include "terminal_ui.hpp"
+#include "../backend/thread_topology.hpp"
+#include "../backend/market_data.hpp"
+#include "../backend/tick_recorder.hpp"
+#include "../backend/async_logger.hpp"
+#include "../backend/metrics_server.hpp"
+#include "../backend/trace.hpp"
 #include <chrono>
 #include <ctime>
+#include <cstdio>
 #include <algorithm>
 
 namespace orderbook {
 
+namespace {
+
+// "850ns", "12.3us", "4.1ms", "2.0s"
+std::string format_ns(uint64_t ns) {
+    char text[16];
+    if (ns < 1000) {
+        std::snprintf(text, sizeof(text), "%lluns", static_cast<unsigned long long>(ns));
+    } else if (ns < 1000000) {
+        std::snprintf(text, sizeof(text), "%.1fus", ns / 1e3);
+    } else if (ns < 1000000000) {
+        std::snprintf(text, sizeof(text), "%.1fms", ns / 1e6);
+    } else {
+        std::snprintf(text, sizeof(text), "%.1fs", ns / 1e9);
+    }
+    return text;
+}
+
+} // namespace
+
 TerminalUI::TerminalUI(OrderBook& book, RLAgent* agent, size_t max_trades, size_t max_depth)
-    : orderbook_(book), rl_agent_(agent), automated_mode_(false),
-      max_trades_display_(max_trades), max_depth_(max_depth),
+    : orderbook_(book), rl_agent_(agent), feed_(nullptr), recorder_(nullptr),
+      automated_mode_(false), running_(false),
+      max_trades_display_(std::max<size_t>(max_trades, 1)), max_depth_(max_depth),
+      frame_interval_ns_(50000000),
+      trades_(max_trades_display_), trade_seq_(0),
+      view_fresh_(false), agent_version_(0), perf_seq_(0), perf_open_(false),
+      input_dirty_(true), help_open_(false), force_redraw_(true), beep_pending_(false),
       header_win_(nullptr), book_win_(nullptr), trades_win_(nullptr),
-      stats_win_(nullptr), input_win_(nullptr),
+      stats_win_(nullptr), input_win_(nullptr), perf_win_(nullptr), help_win_(nullptr),
+      initialized_(false),
       term_height_(0), term_width_(0) {
+          
+    // Views are refilled in place, so size them once
+    for (BookView* view : {&staging_, &shared_, &front_}) {
+        view->bids.reserve(max_depth_);
+        view->asks.reserve(max_depth_);
+        view->trades.reserve(max_trades_display_);
+    }
     
     // Register trade callback
     orderbook_.register_trade_callback([this](const Trade& trade) {
@@ -42,9 +81,11 @@ void TerminalUI::init() {
     
     // Create windows
     create_windows();
+    initialized_ = true;
     
     // Initial draw
-    update();
+    capture_view(front_);
+    render_frame();
 }
 
 void TerminalUI::init_colors() {
@@ -75,6 +116,9 @@ void TerminalUI::create_windows() {
     // Trades window (right, middle)
     trades_win_ = newwin(book_trades_height, trades_width, header_height, book_width);
     
+    // Performance panel, over the book and trades windows while open
+    perf_win_ = newwin(book_trades_height, term_width_, header_height, 0);
+    
     // Stats window (bottom-ish)
     stats_win_ = newwin(stats_height, term_width_, header_height + book_trades_height, 0);
     
@@ -86,13 +130,15 @@ void TerminalUI::create_windows() {
 }
 
 void TerminalUI::cleanup() {
-    if (header_win_) delwin(header_win_);
-    if (book_win_) delwin(book_win_);
-    if (trades_win_) delwin(trades_win_);
-    if (stats_win_) delwin(stats_win_);
-    if (input_win_) delwin(input_win_);
+    // Called explicitly and again from the destructor
+    if (!initialized_) return;
+    for (WINDOW** win : {&header_win_, &book_win_, &trades_win_, &stats_win_, &input_win_, &perf_win_, &help_win_}) {
+        if (*win) delwin(*win);
+        *win = nullptr;
+    }
     
     endwin();
+    initialized_ = false;
 }
 
 void TerminalUI::draw_header() {
@@ -104,7 +150,7 @@ void TerminalUI::draw_header() {
     wattroff(header_win_, COLOR_PAIR(HEADER_PAIR) | A_BOLD);
     
     // Show mode status
-    if (automated_mode_ && rl_agent_) {
+    if (front_.automated && rl_agent_) {
         wattron(header_win_, COLOR_PAIR(HIGHLIGHT_PAIR) | A_BOLD);
         mvwprintw(header_win_, 1, 30, "[AUTO MODE - RL AGENT]");
         wattroff(header_win_, COLOR_PAIR(HIGHLIGHT_PAIR) | A_BOLD);
@@ -122,7 +168,7 @@ void TerminalUI::draw_header() {
     
     mvwprintw(header_win_, 1, term_width_ - time_str.length() - 2, "%s", time_str.c_str());
     
-    wrefresh(header_win_);
+    wnoutrefresh(header_win_);
 }
 
 void TerminalUI::draw_order_book() {
@@ -138,90 +184,134 @@ void TerminalUI::draw_order_book() {
     
     int mid_line = height / 2;
     
-    // Draw asks (top half, reversed order)
-    auto best_ask = orderbook_.get_best_ask();
-    if (best_ask) {
-        std::vector<std::pair<Price, Quantity>> asks;
+    // One row per real level: label, price, size and a volume bar
+    auto draw_level = [&](int line, const char* label, int pair, Price price, Quantity qty) {
+        wattron(book_win_, COLOR_PAIR(pair));
+        mvwprintw(book_win_, line, 2, "%s", label);
+        wattroff(book_win_, COLOR_PAIR(pair));
         
-        // Collect ask levels (this is a simplified approach - ideally expose this in OrderBook)
-        // For now, we'll estimate based on what we know
-        Price current_price = *best_ask;
-        for (size_t i = 0; i < max_depth_ && i < mid_line - 2; ++i) {
-            Quantity vol = orderbook_.get_volume_at_price(current_price, Side::SELL);
-            if (vol > 0) {
-                asks.emplace_back(current_price, vol);
-            }
-            current_price += 1; // Move up in price
-        }
+        mvwprintw(book_win_, line, 8, "%10.2f", price / 100.0);
+        mvwprintw(book_win_, line, 22, "%12llu", static_cast<unsigned long long>(qty));
         
-        // Draw asks from bottom to top (reverse order)
-        std::reverse(asks.begin(), asks.end());
-        int line = mid_line - 1;
-        for (const auto& [price, qty] : asks) {
-            if (line <= 1) break;
-            
-            wattron(book_win_, COLOR_PAIR(ASK_PAIR));
-            mvwprintw(book_win_, line, 2, "ASK");
-            wattroff(book_win_, COLOR_PAIR(ASK_PAIR));
-            
-            mvwprintw(book_win_, line, 8, "%10.2f", price / 100.0);
-            mvwprintw(book_win_, line, 22, "%12llu", qty);
-            
-            // Draw volume bar
-            int bar_width = std::min(20, (int)(qty / 1000));
-            wattron(book_win_, COLOR_PAIR(ASK_PAIR));
-            for (int i = 0; i < bar_width && 38 + i < width - 2; ++i) {
-                mvwaddch(book_win_, line, 38 + i, ACS_CKBOARD);
-            }
-            wattroff(book_win_, COLOR_PAIR(ASK_PAIR));
-            
-            --line;
+        // Draw volume bar
+        int bar_width = std::min(20, (int)(qty / 1000));
+        wattron(book_win_, COLOR_PAIR(pair));
+        for (int i = 0; i < bar_width && 38 + i < width - 2; ++i) {
+            mvwaddch(book_win_, line, 38 + i, ACS_CKBOARD);
         }
+        wattroff(book_win_, COLOR_PAIR(pair));
+    };
+    
+    // Asks fill the top half upward from the spread, best ask nearest it
+    size_t ask_rows = std::min<size_t>(front_.asks.size(), std::max(mid_line - 2, 0));
+    int line = mid_line - 1;
+    for (size_t i = 0; i < ask_rows; ++i) {
+        draw_level(line--, "ASK", ASK_PAIR, front_.asks[i].first, front_.asks[i].second);
     }
     
     // Draw spread line
     wattron(book_win_, COLOR_PAIR(HIGHLIGHT_PAIR) | A_BOLD);
     mvwhline(book_win_, mid_line, 1, ACS_HLINE, width - 2);
     
-    auto spread = orderbook_.get_spread();
-    auto mid = orderbook_.get_mid_price();
-    if (spread && mid) {
+    if (!front_.bids.empty() && !front_.asks.empty()) {
         mvwprintw(book_win_, mid_line, width / 2 - 15, " SPREAD: %.2f | MID: %.2f ", 
-                  *spread / 100.0, *mid / 100.0);
+                  front_.state.spread / 100.0, front_.state.mid_price / 100.0);
     }
     wattroff(book_win_, COLOR_PAIR(HIGHLIGHT_PAIR) | A_BOLD);
     
-    // Draw bids (bottom half)
-    auto best_bid = orderbook_.get_best_bid();
-    if (best_bid) {
-        Price current_price = *best_bid;
-        int line = mid_line + 1;
-        
-        for (size_t i = 0; i < max_depth_ && line < height - 1; ++i) {
-            Quantity vol = orderbook_.get_volume_at_price(current_price, Side::BUY);
-            if (vol > 0) {
-                wattron(book_win_, COLOR_PAIR(BID_PAIR));
-                mvwprintw(book_win_, line, 2, "BID");
-                wattroff(book_win_, COLOR_PAIR(BID_PAIR));
-                
-                mvwprintw(book_win_, line, 8, "%10.2f", current_price / 100.0);
-                mvwprintw(book_win_, line, 22, "%12llu", vol);
-                
-                // Draw volume bar
-                int bar_width = std::min(20, (int)(vol / 1000));
-                wattron(book_win_, COLOR_PAIR(BID_PAIR));
-                for (int i = 0; i < bar_width && 38 + i < width - 2; ++i) {
-                    mvwaddch(book_win_, line, 38 + i, ACS_CKBOARD);
-                }
-                wattroff(book_win_, COLOR_PAIR(BID_PAIR));
-                
-                ++line;
-            }
-            current_price -= 1; // Move down in price
+    // Bids fill the bottom half downward from the spread
+    size_t bid_rows = std::min<size_t>(front_.bids.size(), std::max(height - mid_line - 2, 0));
+    line = mid_line + 1;
+    for (size_t i = 0; i < bid_rows; ++i) {
+        draw_level(line++, "BID", BID_PAIR, front_.bids[i].first, front_.bids[i].second);
+    }
+    
+    wnoutrefresh(book_win_);
+}
+
+void TerminalUI::draw_perf() {
+    werase(perf_win_);
+    box(perf_win_, 0, 0);
+    
+    wattron(perf_win_, COLOR_PAIR(HEADER_PAIR) | A_BOLD);
+    mvwprintw(perf_win_, 0, 2, " PERFORMANCE ");
+    wattroff(perf_win_, COLOR_PAIR(HEADER_PAIR) | A_BOLD);
+    
+    int height, width;
+    getmaxyx(perf_win_, height, width);
+    const PerfView& perf = front_.perf;
+    
+    // Sections flow down and then into the next column; what does not fit is cut
+    const int column_width = 54;
+    int column = 2;
+    int line = 1;
+    auto section = [&](int rows, const char* title) {
+        if (line > 1 && line + rows > height - 1 && column + 2 * column_width <= width) {
+            column += column_width;
+            line = 1;
+        } else if (line > 1) {
+            ++line;
         }
+        if (line < height - 1) {
+            wattron(perf_win_, A_BOLD);
+            mvwprintw(perf_win_, line, column, "%s", title);
+            wattroff(perf_win_, A_BOLD);
+        }
+        ++line;
+    };
+    auto row = [&](const char* fmt, auto... args) {
+        if (line < height - 1) {
+            mvwprintw(perf_win_, line, column, fmt, args...);
+        }
+        ++line;
+    };
+    
+    // Percentiles are log2 bucket upper bounds
+    section(rl_agent_ ? 4 : 3, "Latency      count     p50     p99   p99.9     max");
+    auto latency = [&](const char* name, const LatencySnapshot& snap) {
+        row("%-9s %8llu %7s %7s %7s %7s", name, static_cast<unsigned long long>(snap.count),
+            format_ns(snap.p50_ns).c_str(), format_ns(snap.p99_ns).c_str(),
+            format_ns(snap.p999_ns).c_str(), format_ns(snap.max_ns).c_str());
+    };
+    latency("add", perf.book.add_latency);
+    latency("cancel", perf.book.cancel_latency);
+    latency("modify", perf.book.modify_latency);
+    if (rl_agent_) {
+        latency("agent", perf.agent_decision);
+    }
+    
+    section(4, "Pools       in use    high  capacity");
+    row("%-9s %8zu %7zu %9zu", "orders", perf.book.orders_in_use, perf.book.orders_high_water,
+        perf.book.orders_capacity);
+    row("%-9s %8zu %7zu %9zu", "levels", perf.book.levels_in_use, perf.book.levels_high_water,
+        perf.book.levels_capacity);
+    row("Levels    %zu bid / %zu ask", perf.book.bid_levels, perf.book.ask_levels);
+    row("Index     %zu buckets, load %.2f", perf.book.index_buckets, perf.book.index_load_factor);
+    
+    section(perf.has_recorder ? 2 : 1, "Rings      backlog  capacity  dropped");
+    if (perf.has_recorder) {
+        row("%-9s %8llu %9llu %8llu", "recorder", static_cast<unsigned long long>(perf.recorder_backlog),
+            static_cast<unsigned long long>(perf.recorder_capacity),
+            static_cast<unsigned long long>(perf.recorder_dropped));
+    }
+    row("%-9s %8zu %9s %8s", "commands", perf.commands_pending, "-", "-");
+    
+    section(1, "Feed");
+    if (!perf.has_feed) {
+        row("none (simulated flow only)");
+    } else if (!perf.feed_quote) {
+        row("%s, no quote yet", perf.feed_running ? "running" : "stopped");
+    } else {
+        // Several poll intervals without a quote usually means a stuck provider
+        bool stale = perf.feed_age_ms > 10000.0;
+        if (stale) wattron(perf_win_, COLOR_PAIR(ASK_PAIR) | A_BOLD);
+        row("last quote %s ago, %llu updates%s",
+            format_ns(static_cast<uint64_t>(perf.feed_age_ms * 1e6)).c_str(),
+            static_cast<unsigned long long>(perf.feed_updates), perf.feed_running ? "" : " (stopped)");
+        if (stale) wattroff(perf_win_, COLOR_PAIR(ASK_PAIR) | A_BOLD);
     }
     
-    wrefresh(book_win_);
+    wnoutrefresh(perf_win_);
 }
 
 void TerminalUI::draw_trades() {
@@ -239,10 +329,14 @@ void TerminalUI::draw_trades() {
     mvwprintw(trades_win_, 2, 2, "SIDE");
     mvwprintw(trades_win_, 2, 8, "PRICE");
     mvwprintw(trades_win_, 2, 17, "QTY");
+    bool show_time = 25 + 8 < width - 1;
+    if (show_time) {
+        mvwprintw(trades_win_, 2, 25, "TIME");
+    }
     
-    // Draw recent trades
+    // Draw recent trades, newest first
     int line = 3;
-    for (auto it = recent_trades_.rbegin(); it != recent_trades_.rend() && line < height - 1; ++it) {
+    for (auto it = front_.trades.rbegin(); it != front_.trades.rend() && line < height - 1; ++it) {
         int color = (it->side == Side::BUY) ? BID_PAIR : ASK_PAIR;
         const char* side_str = (it->side == Side::BUY) ? "BUY" : "SELL";
         
@@ -251,12 +345,21 @@ void TerminalUI::draw_trades() {
         wattroff(trades_win_, COLOR_PAIR(color));
         
         mvwprintw(trades_win_, line, 8, "%7.2f", it->price / 100.0);
-        mvwprintw(trades_win_, line, 17, "%6llu", it->quantity);
+        mvwprintw(trades_win_, line, 17, "%6llu", static_cast<unsigned long long>(it->quantity));
+        
+        // Only visible rows are formatted
+        if (show_time) {
+            std::tm local{};
+            localtime_r(&it->time, &local);
+            char time_str[9];
+            std::strftime(time_str, sizeof(time_str), "%H:%M:%S", &local);
+            mvwprintw(trades_win_, line, 25, "%s", time_str);
+        }
         
         ++line;
     }
     
-    wrefresh(trades_win_);
+    wnoutrefresh(trades_win_);
 }
 
 void TerminalUI::draw_stats() {
@@ -267,7 +370,7 @@ void TerminalUI::draw_stats() {
     mvwprintw(stats_win_, 0, 2, " MARKET STATISTICS ");
     wattroff(stats_win_, COLOR_PAIR(HEADER_PAIR) | A_BOLD);
     
-    auto state = orderbook_.get_market_state();
+    const MarketState& state = front_.state;
     
     // Left column
     mvwprintw(stats_win_, 1, 2, "Best Bid:");
@@ -290,13 +393,13 @@ void TerminalUI::draw_stats() {
     int mid_col = term_width_ / 2;
     
     mvwprintw(stats_win_, 1, mid_col, "Total Orders:");
-    mvwprintw(stats_win_, 1, mid_col + 20, "%zu", orderbook_.get_order_count());
+    mvwprintw(stats_win_, 1, mid_col + 20, "%zu", front_.order_count);
     
     mvwprintw(stats_win_, 2, mid_col, "Bid Levels:");
-    mvwprintw(stats_win_, 2, mid_col + 20, "%zu", orderbook_.get_bid_level_count());
+    mvwprintw(stats_win_, 2, mid_col + 20, "%zu", front_.bid_level_count);
     
     mvwprintw(stats_win_, 3, mid_col, "Ask Levels:");
-    mvwprintw(stats_win_, 3, mid_col + 20, "%zu", orderbook_.get_ask_level_count());
+    mvwprintw(stats_win_, 3, mid_col + 20, "%zu", front_.ask_level_count);
     
     mvwprintw(stats_win_, 4, mid_col, "VWAP:");
     mvwprintw(stats_win_, 4, mid_col + 20, "$%.2f", state.vwap);
@@ -312,32 +415,30 @@ void TerminalUI::draw_stats() {
     // RL Agent stats (if available)
     if (rl_agent_) {
         mvwprintw(stats_win_, 5, mid_col, "RL Position:");
-        auto position = rl_agent_->get_position();
-        int pos_color = (position.quantity > 0) ? BID_PAIR : (position.quantity < 0) ? ASK_PAIR : DEFAULT_PAIR;
+        int pos_color = (front_.position > 0) ? BID_PAIR : (front_.position < 0) ? ASK_PAIR : DEFAULT_PAIR;
         wattron(stats_win_, COLOR_PAIR(pos_color) | A_BOLD);
-        mvwprintw(stats_win_, 5, mid_col + 20, "%lld", position.quantity);
+        mvwprintw(stats_win_, 5, mid_col + 20, "%lld", static_cast<long long>(front_.position));
         wattroff(stats_win_, COLOR_PAIR(pos_color) | A_BOLD);
         
         mvwprintw(stats_win_, 6, mid_col, "RL PnL:");
-        double total_pnl = position.realized_pnl + position.unrealized_pnl;
+        double total_pnl = front_.pnl;
         int pnl_color = (total_pnl > 0) ? BID_PAIR : ASK_PAIR;
         wattron(stats_win_, COLOR_PAIR(pnl_color) | A_BOLD);
         mvwprintw(stats_win_, 6, mid_col + 20, "$%.2f", total_pnl);
         wattroff(stats_win_, COLOR_PAIR(pnl_color) | A_BOLD);
         
         // Show mode and active orders
-        if (automated_mode_) {
+        if (front_.automated) {
             wattron(stats_win_, COLOR_PAIR(HIGHLIGHT_PAIR) | A_BOLD);
             mvwprintw(stats_win_, 7, 2, "AUTO TRADING ACTIVE");
             wattroff(stats_win_, COLOR_PAIR(HIGHLIGHT_PAIR) | A_BOLD);
         }
         
-        auto obs = rl_agent_->get_observation();
         mvwprintw(stats_win_, 7, mid_col, "Active Orders:");
-        mvwprintw(stats_win_, 7, mid_col + 20, "%zu", obs.active_orders.size());
+        mvwprintw(stats_win_, 7, mid_col + 20, "%zu", front_.active_orders);
     }
     
-    wrefresh(stats_win_);
+    wnoutrefresh(stats_win_);
 }
 
 void TerminalUI::draw_input() {
@@ -353,43 +454,36 @@ void TerminalUI::draw_input() {
     // Show help hint with auto mode info
     wattron(input_win_, A_DIM);
     if (rl_agent_) {
-        mvwprintw(input_win_, 1, term_width_ - 40, "[h]elp [a]uto [q]uit [TAB]macro");
+        mvwprintw(input_win_, 1, term_width_ - 45, "[h]elp [a]uto [q]uit [TAB]macro [F2]perf");
     } else {
-        mvwprintw(input_win_, 1, term_width_ - 30, "[h]elp [q]uit [TAB]macro");
+        mvwprintw(input_win_, 1, term_width_ - 35, "[h]elp [q]uit [TAB]macro [F2]perf");
     }
     wattroff(input_win_, A_DIM);
     
-    wrefresh(input_win_);
+    // Leave the cursor after the prompt
+    wmove(input_win_, 1, 4 + static_cast<int>(current_command_.size()));
+    wnoutrefresh(input_win_);
 }
 
-void TerminalUI::refresh_all() {
-    draw_header();
-    draw_order_book();
-    draw_trades();
-    draw_stats();
-    draw_input();
+void TerminalUI::update() {
+    force_redraw_.store(true, std::memory_order_relaxed);
 }
 
-void TerminalUI::update() {
-    refresh_all();
+void TerminalUI::set_frame_rate(double frames_per_second) {
+    frame_interval_ns_ = static_cast<uint64_t>(1e9 / std::max(frames_per_second, 0.1));
 }
 
 void TerminalUI::on_trade(const Trade& trade) {
+    // Raw fields only; the time is formatted when (and if) the row is drawn
     TradeInfo info;
     info.price = trade.price;
     info.quantity = trade.quantity;
     info.side = (trade.buy_order_id < trade.sell_order_id) ? Side::BUY : Side::SELL;
+    info.time = std::time(nullptr);
     
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    std::string time_str = std::ctime(&time_t);
-    time_str = time_str.substr(11, 8); // Extract HH:MM:SS
-    info.timestamp = time_str;
-    
-    recent_trades_.push_back(info);
-    if (recent_trades_.size() > max_trades_display_) {
-        recent_trades_.pop_front();
-    }
+    std::lock_guard<std::mutex> lock(trades_mutex_);
+    trades_[trade_seq_ % trades_.size()] = info;
+    ++trade_seq_;
 }
 
 TerminalUI::OrderCommand TerminalUI::parse_command(const std::string& cmd) {
@@ -455,16 +549,11 @@ void TerminalUI::execute_command(const std::string& cmd) {
         return; // Will be handled in run()
     }
     
-    if (cmd == "h" || cmd == "help") {
-        show_help();
-        return;
-    }
-    
     // Parse and execute order command
     auto order_cmd = parse_command(cmd);
     if (!order_cmd.valid) {
-        // Show error (could add error window)
-        beep();
+        // Show error (could add error window); the render thread beeps
+        beep_pending_.store(true, std::memory_order_relaxed);
         return;
     }
     
@@ -476,8 +565,8 @@ void TerminalUI::execute_command(const std::string& cmd) {
     command_history_.push_back(cmd);
 }
 
-void TerminalUI::show_help() {
-    WINDOW* help_win = newwin(18, 70, (term_height_ - 18) / 2, (term_width_ - 70) / 2);
+void TerminalUI::draw_help() {
+    WINDOW* help_win = help_win_;
     box(help_win, 0, 0);
     
     wattron(help_win, COLOR_PAIR(HEADER_PAIR) | A_BOLD);
@@ -502,50 +591,233 @@ void TerminalUI::show_help() {
     mvwprintw(help_win, 13, 4, "TAB - Generate random market activity");
     
     mvwprintw(help_win, 15, 2, "Other Commands:");
-    mvwprintw(help_win, 16, 4, "h/help - Show this help   q/quit - Exit");
+    mvwprintw(help_win, 16, 4, "h/help - Help   perf/F2 - Performance panel   q/quit - Exit");
+    mvwprintw(help_win, 17, 4, "trace - Write trace spans to data/traces (TRACE=1 builds)");
     
-    mvwprintw(help_win, 17, 20, "Press any key to close");
-    
-    wrefresh(help_win);
-    nodelay(stdscr, FALSE);
-    getch();
-    nodelay(stdscr, TRUE);
-    delwin(help_win);
+    mvwprintw(help_win, 18, 20, "Press any key to close");
     
-    update();
+    wnoutrefresh(help_win);
 }
 
 void TerminalUI::run() {
-    bool running = true;
+    running_.store(true, std::memory_order_release);
+    render_thread_ = std::thread(&TerminalUI::render_loop, this);
+    
+    // Entered after the render thread started so it does not inherit this
+    // placement. This thread drives the book, so it takes the matching role.
+    OrderBookNS::PollLoop loop(OrderBookNS::ThreadRole::MATCHING);
     auto last_rl_action = std::chrono::steady_clock::now();
     const auto rl_action_interval = std::chrono::milliseconds(500); // Execute RL action every 500ms
-    
-    while (running) {
-        int ch = getch();
+    uint64_t next_publish_ns = 0;
+    uint64_t next_perf_ns = 0;
+    
+    while (running_.load(std::memory_order_acquire)) {
+        uint64_t start = loop.begin();
+        bool worked = book_task_ && book_task_();
+        if (run_commands()) {
+            worked = true;
+        }
         
         // Execute RL actions periodically in automated mode
-        if (automated_mode_ && rl_agent_) {
+        if (automated_mode_.load(std::memory_order_relaxed) && rl_agent_) {
             auto now = std::chrono::steady_clock::now();
             if (now - last_rl_action >= rl_action_interval) {
-                execute_rl_action();
+                {
+                    ScopedLatency timer(agent_latency_);
+                    OB_TRACE_SCOPE("agent.decision");
+                    execute_rl_action();
+                }
                 last_rl_action = now;
+                ++agent_version_;
+                worked = true;
             }
         }
         
-        if (ch == ERR) {
-            // No input, update display
-            update();
-            napms(100); // Sleep for 100ms
+        // No point copying the book faster than frames are drawn; the perf
+        // panel is refreshed on its own clock even when the book is quiet
+        bool refresh_perf = perf_open_.load(std::memory_order_relaxed) && start >= next_perf_ns;
+        if (start >= next_publish_ns && publish_view(refresh_perf)) {
+            next_publish_ns = start + frame_interval_ns_;
+            if (refresh_perf) {
+                next_perf_ns = start + PERF_REFRESH_NS;
+            }
+            worked = true;
+        }
+        
+        loop.end(start, worked);
+    }
+    
+    render_thread_.join();
+}
+
+bool TerminalUI::run_commands() {
+    {
+        std::lock_guard<std::mutex> lock(command_mutex_);
+        if (commands_.empty()) return false;
+        command_batch_.swap(commands_);
+    }
+    
+    for (const PendingCommand& command : command_batch_) {
+        switch (command.kind) {
+            case PendingCommand::Kind::ORDER:
+                execute_command(command.text);
+                break;
+            case PendingCommand::Kind::MACRO: {
+                // TAB macro - generate random orders
+                MarketSimulator sim(orderbook_, 10000, 0.005, 50.0);
+                sim.simulate_step(100);
+                break;
+            }
+            case PendingCommand::Kind::TOGGLE_AUTO:
+                toggle_automated_mode();
+                break;
+        }
+    }
+    command_batch_.clear();
+    ++agent_version_;
+    return true;
+}
+
+bool TerminalUI::publish_view(bool refresh_perf) {
+    OB_TRACE_SCOPE("ui.publish");
+    uint64_t book_version = orderbook_.get_version();
+    uint64_t trade_seq;
+    {
+        std::lock_guard<std::mutex> lock(trades_mutex_);
+        trade_seq = trade_seq_;
+    }
+    bool automated = automated_mode_.load(std::memory_order_relaxed);
+    if (!refresh_perf && book_version == published_.book && trade_seq == published_.trades &&
+        agent_version_ == published_.agent && automated == published_.automated) {
+        return false;
+    }
+    
+    capture_view(staging_);
+    published_.book = staging_.book_version;
+    published_.trades = staging_.trade_seq;
+    published_.agent = staging_.agent_version;
+    published_.automated = staging_.automated;
+    
+    std::lock_guard<std::mutex> lock(view_mutex_);
+    std::swap(staging_, shared_);
+    view_fresh_ = true;
+    return true;
+}
+
+void TerminalUI::capture_view(BookView& view) {
+    view.book_version = orderbook_.get_version();
+    view.agent_version = agent_version_;
+    view.automated = automated_mode_.load(std::memory_order_relaxed);
+    
+    view.state = orderbook_.get_market_state();
+    view.order_count = orderbook_.get_order_count();
+    view.bid_level_count = orderbook_.get_bid_level_count();
+    view.ask_level_count = orderbook_.get_ask_level_count();
+    view.bids.clear();
+    view.asks.clear();
+    orderbook_.for_each_level(Side::BUY, max_depth_, [&view](const PriceLevel& level) {
+        view.bids.emplace_back(level.price, level.total_quantity);
+    });
+    orderbook_.for_each_level(Side::SELL, max_depth_, [&view](const PriceLevel& level) {
+        view.asks.emplace_back(level.price, level.total_quantity);
+    });
+    
+    {
+        std::lock_guard<std::mutex> lock(trades_mutex_);
+        view.trade_seq = trade_seq_;
+        view.trades.clear();
+        uint64_t count = std::min<uint64_t>(trade_seq_, trades_.size());
+        for (uint64_t seq = trade_seq_ - count; seq < trade_seq_; ++seq) {
+            view.trades.push_back(trades_[seq % trades_.size()]);
+        }
+    }
+    
+    if (rl_agent_) {
+        auto position = rl_agent_->get_position();
+        view.position = position.quantity;
+        view.pnl = position.realized_pnl + position.unrealized_pnl;
+        view.active_orders = rl_agent_->get_observation().active_orders.size();
+    }
+    
+    if (perf_open_.load(std::memory_order_relaxed)) {
+        view.perf_seq = ++perf_seq_;
+        PerfView& perf = view.perf;
+        perf.book = orderbook_.get_diagnostics();
+        perf.agent_decision = agent_latency_.snapshot();
+        {
+            std::lock_guard<std::mutex> lock(command_mutex_);
+            perf.commands_pending = commands_.size();
+        }
+        
+        perf.has_recorder = recorder_ != nullptr;
+        if (recorder_) {
+            perf.recorder_backlog = recorder_->backlog();
+            perf.recorder_capacity = recorder_->queue_capacity();
+            perf.recorder_dropped = recorder_->dropped();
+        }
+        
+        perf.has_feed = feed_ != nullptr;
+        if (feed_) {
+            OrderBookNS::Quote quote;
+            std::chrono::nanoseconds age{0};
+            perf.feed_running = feed_->is_running();
+            perf.feed_quote = feed_->get_latest_quote(quote, age);
+            perf.feed_age_ms = age.count() / 1e6;
+            perf.feed_updates = feed_->updates();
+        }
+    }
+}
+
+void TerminalUI::render_loop() {
+    OrderBookNS::PollLoop loop(OrderBookNS::ThreadRole::UI);
+    uint64_t next_frame_ns = 0;
+    
+    while (running_.load(std::memory_order_acquire)) {
+        uint64_t start = loop.begin();
+        bool worked = handle_input();
+        
+        // Frame-rate cap: at most one frame per interval, keys or not
+        if (start >= next_frame_ns) {
+            worked |= render_frame();
+            next_frame_ns = start + frame_interval_ns_;
+        }
+        
+        loop.end(start, worked);
+    }
+}
+
+bool TerminalUI::handle_input() {
+    bool any = false;
+    int ch;
+    while ((ch = getch()) != ERR) {
+        any = true;
+        
+        // Any key closes the help window
+        if (help_open_) {
+            help_open_ = false;
+            delwin(help_win_);
+            help_win_ = nullptr;
+            force_redraw_.store(true, std::memory_order_relaxed);
             continue;
         }
         
+        PendingCommand command{PendingCommand::Kind::ORDER, std::string()};
+        bool send = false;
+        bool toggle_perf = ch == KEY_F(2);
         if (ch == '\n' || ch == KEY_ENTER) {
             // Execute command
             if (current_command_ == "q" || current_command_ == "quit" || 
                 current_command_ == "exit") {
-                running = false;
-            } else {
-                execute_command(current_command_);
+                running_.store(false, std::memory_order_release);
+            } else if (current_command_ == "h" || current_command_ == "help") {
+                help_open_ = true;
+            } else if (current_command_ == "perf") {
+                toggle_perf = true;
+            } else if (current_command_ == "trace") {
+                dump_trace();
+            } else if (!current_command_.empty()) {
+                command.text = current_command_;
+                send = true;
             }
             current_command_.clear();
         } else if (ch == KEY_BACKSPACE || ch == 127 || ch == '\b') {
@@ -555,24 +827,111 @@ void TerminalUI::run() {
             }
         } else if (ch == '\t') {
             // TAB macro - generate random orders
-            MarketSimulator sim(orderbook_, 10000, 0.005, 50.0);
-            sim.simulate_step(100);
+            command.kind = PendingCommand::Kind::MACRO;
+            send = true;
             current_command_.clear();
         } else if ((ch == 'a' || ch == 'A') && current_command_.empty()) {
             // Toggle automated mode (only when no command is being typed)
-            toggle_automated_mode();
+            command.kind = PendingCommand::Kind::TOGGLE_AUTO;
+            send = true;
         } else if (ch >= 32 && ch <= 126) {
             // Printable character
             current_command_ += static_cast<char>(ch);
         }
+        input_dirty_ = true;
         
-        update();
+        if (toggle_perf) {
+            perf_open_.store(!perf_open_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            force_redraw_.store(true, std::memory_order_relaxed);
+        }
+        if (send) {
+            std::lock_guard<std::mutex> lock(command_mutex_);
+            commands_.push_back(std::move(command));
+        }
     }
+    return any;
+}
+
+bool TerminalUI::render_frame() {
+    OB_TRACE_SCOPE("ui.render");
+    {
+        std::lock_guard<std::mutex> lock(view_mutex_);
+        if (view_fresh_) {
+            std::swap(shared_, front_);
+            view_fresh_ = false;
+        }
+    }
+    if (beep_pending_.exchange(false, std::memory_order_relaxed)) {
+        beep();
+    }
+    
+    // The help window stays on top until a key closes it
+    if (help_open_) {
+        if (help_win_) return false;
+        help_win_ = newwin(19, 70, (term_height_ - 19) / 2, (term_width_ - 70) / 2);
+        draw_help();
+        doupdate();
+        return true;
+    }
+    
+    bool all = force_redraw_.exchange(false, std::memory_order_relaxed);
+    bool drew = false;
+    
+    // Each panel is redrawn only when what it shows changed
+    std::time_t now = std::time(nullptr);
+    if (all || now != drawn_.clock || front_.automated != drawn_.automated) {
+        draw_header();
+        drawn_.clock = now;
+        drawn_.automated = front_.automated;
+        drew = true;
+    }
+    // The perf panel covers the book and trades panels while it is open
+    bool perf_open = perf_open_.load(std::memory_order_relaxed);
+    if (perf_open && (all || front_.perf_seq != drawn_.perf)) {
+        draw_perf();
+        drawn_.perf = front_.perf_seq;
+        drew = true;
+    }
+    if (!perf_open && (all || front_.book_version != drawn_.book)) {
+        draw_order_book();
+        drawn_.book = front_.book_version;
+        drew = true;
+    }
+    if (!perf_open && (all || front_.trade_seq != drawn_.trades)) {
+        draw_trades();
+        drawn_.trades = front_.trade_seq;
+        drew = true;
+    }
+    if (all || front_.book_version != drawn_.stats_book || front_.agent_version != drawn_.stats_agent) {
+        draw_stats();
+        drawn_.stats_book = front_.book_version;
+        drawn_.stats_agent = front_.agent_version;
+        drew = true;
+    }
+    if (all || input_dirty_ || drew) {
+        // Last, so the cursor ends up on the prompt
+        draw_input();
+        input_dirty_ = false;
+        drew = true;
+    }
+    
+    if (drew) {
+        doupdate();
+    }
+    return drew;
 }
 
 void TerminalUI::toggle_automated_mode() {
     if (rl_agent_) {
-        automated_mode_ = !automated_mode_;
+        automated_mode_.store(!automated_mode_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+void TerminalUI::dump_trace() {
+    // Beeps when the build has no spans (make TRACE=1) or the file fails
+    std::string path = OrderBookNS::Tracer::dump_path("orderbook_ui");
+    if (!OrderBookNS::Tracer::ENABLED || !OrderBookNS::Tracer::global().dump(path)) {
+        beep_pending_.store(true, std::memory_order_relaxed);
     }
 }
 
@@ -780,22 +1139,18 @@ double TerminalUI::calculate_order_book_imbalance() noexcept {
         return cached_imbalance_;
     }
     
-    // Get market state which includes top levels
-    auto market_state = orderbook_.get_market_state();
-    
     Quantity bid_volume = 0;
     Quantity ask_volume = 0;
     
-    // Sum up top 5 levels (or all available if less than 5)
-    const size_t depth = std::min(size_t(5), std::min(market_state.bid_levels.size(), market_state.ask_levels.size()));
-    
-    for (size_t i = 0; i < depth && i < market_state.bid_levels.size(); ++i) [[likely]] {
-        bid_volume += market_state.bid_levels[i].second;
-    }
-    
-    for (size_t i = 0; i < depth && i < market_state.ask_levels.size(); ++i) [[likely]] {
-        ask_volume += market_state.ask_levels[i].second;
-    }
+    // Sum up top 5 levels (or as many as both sides have, if fewer)
+    const size_t depth = std::min(size_t(5), std::min(orderbook_.get_bid_level_count(),
+                                                      orderbook_.get_ask_level_count()));
+    orderbook_.for_each_level(Side::BUY, depth, [&bid_volume](const PriceLevel& level) {
+        bid_volume += level.total_quantity;
+    });
+    orderbook_.for_each_level(Side::SELL, depth, [&ask_volume](const PriceLevel& level) {
+        ask_volume += level.total_quantity;
+    });
     
     Quantity total_volume = bid_volume + ask_volume;
     if (total_volume == 0) [[unlikely]] {
@@ -833,12 +1188,31 @@ void TerminalUI::handle_error(ErrorFlags flags) {
 }
 
 void TerminalUI::log_error(const std::string& message) {
-    // Slow path - logging is expensive
-    // In production, this would write to a log file
-    // For now, we just mark the error state
+    // Queued for the logger thread; nothing is formatted here
+    OB_LOG_ERROR("ui: %s", message.c_str());
     error_state_ = static_cast<ErrorFlags>(error_state_ | ORDER_REJECT);
 }
 
+void TerminalUI::collect_metrics(OrderBookNS::MetricsWriter& out) const {
+    out.gauge("orderbook_agent_automated", "1 while the RL agent trades on its own",
+              automated_mode_.load(std::memory_order_relaxed) ? 1.0 : 0.0);
+    if (rl_agent_) {
+        const RLAgent::Gauges& agent = rl_agent_->get_gauges();
+        out.gauge("orderbook_agent_position", "Agent position in lots (negative is short)",
+                  static_cast<double>(agent.position.load(std::memory_order_relaxed)));
+        out.gauge("orderbook_agent_realized_pnl", "Agent realized PnL in dollars",
+                  agent.realized_pnl.load(std::memory_order_relaxed));
+        out.gauge("orderbook_agent_portfolio_value", "Agent cash plus position at mid, in dollars",
+                  agent.portfolio_value.load(std::memory_order_relaxed));
+        out.counter("orderbook_agent_fills_total", "Trades involving the agent's orders",
+                    agent.fills.load(std::memory_order_relaxed));
+        out.counter("orderbook_agent_actions_total", "Actions the agent has executed",
+                    agent.actions.load(std::memory_order_relaxed));
+    }
+    out.family("orderbook_agent_decision_latency_seconds", "histogram", "Time to choose and execute one RL action");
+    out.histogram("orderbook_agent_decision_latency_seconds", agent_latency_);
+}
+
 // Cache warming: Pre-load hot data into L1 cache
 void TerminalUI::warm_cache() noexcept {
     // Warm up the price buffer
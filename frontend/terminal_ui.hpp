@@ -5,11 +5,21 @@
 #include <ncurses.h>
 #include <string>
 #include <vector>
-#include <deque>
 #include <array>
 #include <sstream>
 #include <iomanip>
 #include <cmath>
+#include <ctime>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <functional>
+
+namespace OrderBookNS {
+class MarketDataFeed;
+class TickRecorder;
+class MetricsWriter;
+}
 
 namespace orderbook {
 
@@ -96,19 +106,130 @@ struct TradeInfo {
     Price price;
     Quantity quantity;
     Side side;
-    std::string timestamp;
+    std::time_t time;  // Formatted only when the row is drawn
 };
 
+// Engine internals for the performance panel, captured only while it is open
+struct PerfView {
+    BookDiagnostics book{};
+    LatencySnapshot agent_decision;   // One RL action, start to finish
+    size_t commands_pending = 0;      // Typed, not yet run by the control loop
+    
+    bool has_recorder = false;
+    uint64_t recorder_backlog = 0;
+    uint64_t recorder_capacity = 0;
+    uint64_t recorder_dropped = 0;
+    
+    bool has_feed = false;
+    bool feed_running = false;
+    bool feed_quote = false;          // A quote has arrived
+    double feed_age_ms = 0.0;         // Since the latest quote arrived
+    uint64_t feed_updates = 0;
+};
+
+// Everything the render thread draws, copied from the book and the agent by
+// the control thread and tagged with the versions it was taken at
+struct BookView {
+    uint64_t book_version = 0;    // OrderBook::get_version()
+    uint64_t trade_seq = 0;       // Trades seen by on_trade()
+    uint64_t agent_version = 0;   // Agent actions, commands, mode changes
+    bool automated = false;
+    
+    MarketState state{};
+    size_t order_count = 0;
+    size_t bid_level_count = 0;
+    size_t ask_level_count = 0;
+    std::vector<std::pair<Price, Quantity>> bids;   // Best first
+    std::vector<std::pair<Price, Quantity>> asks;
+    std::vector<TradeInfo> trades;                  // Oldest first
+    
+    int64_t position = 0;
+    double pnl = 0.0;
+    size_t active_orders = 0;
+    
+    uint64_t perf_seq = 0;        // Bumped on every capture with the panel open
+    PerfView perf;
+};
+
+// Two threads share the UI:
+//   control (the thread that calls run()): the book's only driver. It runs
+//     the book task (market flow), typed commands and RL actions and, at most
+//     once per frame, copies the book into a BookView
+//   render (started by run()): owns ncurses, reads keys, and redraws only
+//     the panels whose source version changed, at most frame_rate times a second
+// F2 (or "perf") swaps the book and trades panels for live engine internals: operation
+// and agent latencies, pool usage, index load, ring backlogs, feed staleness.
+// The render thread never touches the book, so a busy book costs it nothing
+// and drawing never delays the agent.
 class TerminalUI {
 private:
     OrderBook& orderbook_;
     RLAgent* rl_agent_;
-    bool automated_mode_;
-    std::deque<TradeInfo> recent_trades_;
+    OrderBookNS::MarketDataFeed* feed_;
+    OrderBookNS::TickRecorder* recorder_;
+    std::atomic<bool> automated_mode_;
+    std::atomic<bool> running_;
     std::vector<std::string> command_history_;
-    std::string current_command_;
+    std::string current_command_;       // Render thread
     size_t max_trades_display_;
     size_t max_depth_;
+    uint64_t frame_interval_ns_;
+    
+    // Recent trades ring, written from book callbacks on whichever thread
+    // drives the book
+    std::mutex trades_mutex_;
+    std::vector<TradeInfo> trades_;
+    uint64_t trade_seq_;
+    
+    // Commands typed on the render thread, run on the control thread
+    struct PendingCommand {
+        enum class Kind { ORDER, MACRO, TOGGLE_AUTO } kind;
+        std::string text;
+    };
+    std::mutex command_mutex_;
+    std::vector<PendingCommand> commands_;
+    std::vector<PendingCommand> command_batch_;   // Control thread
+    std::function<bool()> book_task_;             // Control thread
+    
+    // Triple buffer: control fills staging_ and swaps it with shared_; render
+    // swaps shared_ with front_ when it is fresh
+    std::mutex view_mutex_;
+    BookView staging_;
+    BookView shared_;
+    BookView front_;
+    bool view_fresh_;
+    
+    // Control thread: versions of the last published view
+    struct PublishedVersions {
+        uint64_t book = UINT64_MAX;
+        uint64_t trades = UINT64_MAX;
+        uint64_t agent = UINT64_MAX;
+        bool automated = false;
+    } published_;
+    uint64_t agent_version_;
+    uint64_t perf_seq_;
+    LatencyHistogram agent_latency_;
+    
+    // Performance panel: toggled by the render thread, refreshed by the
+    // control thread every PERF_REFRESH_NS while open
+    static constexpr uint64_t PERF_REFRESH_NS = 250000000;
+    std::atomic<bool> perf_open_;
+    
+    // Render thread: versions each panel was last drawn at
+    struct DrawnVersions {
+        std::time_t clock = 0;
+        bool automated = false;
+        uint64_t book = UINT64_MAX;
+        uint64_t trades = UINT64_MAX;
+        uint64_t stats_book = UINT64_MAX;
+        uint64_t stats_agent = UINT64_MAX;
+        uint64_t perf = UINT64_MAX;
+    } drawn_;
+    bool input_dirty_;
+    bool help_open_;
+    std::atomic<bool> force_redraw_;
+    std::atomic<bool> beep_pending_;
+    std::thread render_thread_;
     
     // Window pointers
     WINDOW* header_win_;
@@ -116,6 +237,9 @@ private:
     WINDOW* trades_win_;
     WINDOW* stats_win_;
     WINDOW* input_win_;
+    WINDOW* perf_win_;
+    WINDOW* help_win_;
+    bool initialized_;
     
     // Dimensions
     int term_height_;
@@ -139,7 +263,18 @@ private:
     void draw_trades();
     void draw_stats();
     void draw_input();
-    void refresh_all();
+    void draw_help();
+    void draw_perf();
+    
+    // Control thread
+    bool run_commands();
+    bool publish_view(bool refresh_perf);
+    void capture_view(BookView& view);
+    
+    // Render thread
+    void render_loop();
+    bool handle_input();
+    bool render_frame();
     
     // Command processing
     struct OrderCommand {
@@ -153,7 +288,9 @@ private:
     
     OrderCommand parse_command(const std::string& cmd);
     void execute_command(const std::string& cmd);
-    void show_help();
+    
+    // "trace" command: write the spans so far under data/traces (render thread)
+    void dump_trace();
     
     // Automated trading
     void execute_rl_action();
@@ -200,12 +337,32 @@ public:
     
     void init();
     void cleanup();
+    // Runs the control loop on the calling thread and rendering on its own
+    // thread; returns when the user quits
     void run();
+    
+    // Book work (market simulation, quote reconciliation) for the control
+    // loop to run every iteration; returns true if it did anything. Anything
+    // else that drives the book must go through here, since the control
+    // thread reads it without a lock. Set before run().
+    void set_book_task(std::function<bool()> task) { book_task_ = std::move(task); }
+    // Redraw every panel on the next frame
     void update();
     
+    // Redraws per second (default 20); set before run()
+    void set_frame_rate(double frames_per_second);
+    
+    // Sources for the performance panel (F2 or "perf"); optional, set before run()
+    void set_feed(OrderBookNS::MarketDataFeed* feed) { feed_ = feed; }
+    void set_recorder(OrderBookNS::TickRecorder* recorder) { recorder_ = recorder; }
+    
+    // Agent position, PnL and decision latency for the metrics endpoint;
+    // reads only atomics, so any thread may call it
+    void collect_metrics(OrderBookNS::MetricsWriter& out) const;
+    
     // Mode control
     void toggle_automated_mode();
-    bool is_automated() const { return automated_mode_; }
+    bool is_automated() const { return automated_mode_.load(std::memory_order_relaxed); }
     
     // Callback for trade notifications
     void on_trade(const Trade& trade);
@@ -0,0 +1,325 @@
+#include "backend/market_data.hpp"
+#include "backend/json_extract.hpp"
+#include <json/json.h>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <tuple>
+#include <cstdio>
+#include <ctime>
+
+using namespace OrderBookNS;
+
+// Microbenchmark: provider response parsing, jsoncpp DOM vs JsonView
+//
+// Responses are synthesized in the shape of the real APIs (a full trading day
+// of 1-minute candles for Yahoo and FMP, 100 bars for Alpha Vantage). Pass a
+// captured Yahoo chart response as the first argument to use it instead.
+
+// ----------------------------------------------------------------------------
+// Response generators
+// ----------------------------------------------------------------------------
+
+static std::string yahoo_chart(int candles, std::mt19937_64& rng) {
+    std::normal_distribution<double> step(0.0, 0.05);
+    std::uniform_int_distribution<int> vol(1000, 90000);
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(6);
+    
+    uint64_t start = 1718026200;
+    out << "{\"chart\":{\"result\":[{\"meta\":{\"currency\":\"USD\",\"symbol\":\"AAPL\","
+        << "\"exchangeName\":\"NMS\",\"fullExchangeName\":\"NasdaqGS\",\"instrumentType\":\"EQUITY\","
+        << "\"firstTradeDate\":345479400,\"regularMarketTime\":" << start + candles * 60 << ","
+        << "\"hasPrePostMarketData\":true,\"gmtoffset\":-14400,\"timezone\":\"EDT\","
+        << "\"exchangeTimezoneName\":\"America/New_York\",\"regularMarketPrice\":193.12,"
+        << "\"fiftyTwoWeekHigh\":199.62,\"fiftyTwoWeekLow\":164.08,\"regularMarketDayHigh\":193.59,"
+        << "\"regularMarketDayLow\":190.3,\"regularMarketVolume\":97010582,\"longName\":\"Apple Inc.\","
+        << "\"shortName\":\"Apple Inc.\",\"chartPreviousClose\":196.89,\"previousClose\":196.89,"
+        << "\"scale\":3,\"priceHint\":2,\"currentTradingPeriod\":{"
+        << "\"pre\":{\"timezone\":\"EDT\",\"start\":1718006400,\"end\":1718026200,\"gmtoffset\":-14400},"
+        << "\"regular\":{\"timezone\":\"EDT\",\"start\":1718026200,\"end\":1718049600,\"gmtoffset\":-14400},"
+        << "\"post\":{\"timezone\":\"EDT\",\"start\":1718049600,\"end\":1718064000,\"gmtoffset\":-14400}},"
+        << "\"dataGranularity\":\"1m\",\"range\":\"1d\",\"validRanges\":[\"1d\",\"5d\",\"1mo\",\"3mo\","
+        << "\"6mo\",\"1y\",\"2y\",\"5y\",\"10y\",\"ytd\",\"max\"]},\"timestamp\":[";
+    for (int i = 0; i < candles; ++i) {
+        out << (i ? "," : "") << start + i * 60;
+    }
+    
+    std::vector<double> open(candles), high(candles), low(candles), close(candles);
+    double price = 193.0;
+    for (int i = 0; i < candles; ++i) {
+        open[i] = price;
+        price += step(rng);
+        close[i] = price;
+        high[i] = std::max(open[i], close[i]) + std::abs(step(rng));
+        low[i] = std::min(open[i], close[i]) - std::abs(step(rng));
+    }
+    auto column = [&](const char* name, const std::vector<double>& values) {
+        out << "\"" << name << "\":[";
+        for (int i = 0; i < candles; ++i) {
+            out << (i ? "," : "");
+            if (i % 97 == 13) {
+                out << "null";  // Yahoo leaves gaps as null
+            } else {
+                out << values[i];
+            }
+        }
+        out << "]";
+    };
+    out << "],\"indicators\":{\"quote\":[{";
+    column("low", low);
+    out << ",";
+    column("open", open);
+    out << ",\"volume\":[";
+    for (int i = 0; i < candles; ++i) {
+        out << (i ? "," : "") << vol(rng);
+    }
+    out << "],";
+    column("high", high);
+    out << ",";
+    column("close", close);
+    out << "}]}}],\"error\":null}}";
+    return out.str();
+}
+
+static std::string fmp_chart(int bars, std::mt19937_64& rng) {
+    std::normal_distribution<double> step(0.0, 0.05);
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2) << "[";
+    double price = 193.0;
+    for (int i = 0; i < bars; ++i) {
+        double next = price + step(rng);
+        out << (i ? "," : "") << "{\"date\":\"2024-06-10 " << std::setw(2) << std::setfill('0') << 9 + i / 60
+            << ":" << std::setw(2) << i % 60 << ":00\",\"open\":" << price
+            << ",\"low\":" << std::min(price, next) - 0.02 << ",\"high\":" << std::max(price, next) + 0.02
+            << ",\"close\":" << next << ",\"volume\":" << 1000 + i * 37 << "}";
+        price = next;
+    }
+    out << "]";
+    return out.str();
+}
+
+static std::string alpha_vantage_series(int bars, std::mt19937_64& rng) {
+    std::normal_distribution<double> step(0.0, 0.05);
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(4);
+    out << "{\"Meta Data\":{\"1. Information\":\"Intraday (1min) open, high, low, close prices and volume\","
+        << "\"2. Symbol\":\"AAPL\",\"3. Last Refreshed\":\"2024-06-10 19:59:00\",\"4. Interval\":\"1min\","
+        << "\"5. Output Size\":\"Compact\",\"6. Time Zone\":\"US/Eastern\"},\"Time Series (1min)\":{";
+    double price = 193.0;
+    for (int i = 0; i < bars; ++i) {
+        double next = price + step(rng);
+        int minute = 20 * 60 - 1 - i;  // Newest first, like the real API
+        out << (i ? "," : "") << "\"2024-06-10 " << std::setw(2) << std::setfill('0') << minute / 60
+            << ":" << std::setw(2) << minute % 60 << ":00\":{\"1. open\":\"" << price << "\",\"2. high\":\"" << std::max(price, next) + 0.01
+            << "\",\"3. low\":\"" << std::min(price, next) - 0.01 << "\",\"4. close\":\"" << next
+            << "\",\"5. volume\":\"" << 100 + i << "\"}";
+        price = next;
+    }
+    out << "}}";
+    return out.str();
+}
+
+// ----------------------------------------------------------------------------
+// jsoncpp baselines (the provider parsers as they were before JsonView)
+// ----------------------------------------------------------------------------
+
+static bool jsoncpp_yahoo_ohlcv(const std::string& body, int limit, std::vector<OHLCV>& data) {
+    Json::Value root;
+    Json::Reader reader;
+    if (!reader.parse(body, root)) return false;
+    auto chart = root["chart"]["result"][0];
+    auto timestamps = chart["timestamp"];
+    auto indicators = chart["indicators"]["quote"][0];
+    data.clear();
+    int count = std::min(limit, static_cast<int>(timestamps.size()));
+    for (int i = timestamps.size() - count; i < static_cast<int>(timestamps.size()); ++i) {
+        OHLCV bar;
+        bar.symbol = "AAPL";
+        bar.timestamp = timestamps[i].asUInt64() * 1000000000ULL;
+        bar.open = static_cast<Price>(indicators["open"][i].asDouble() * 100);
+        bar.high = static_cast<Price>(indicators["high"][i].asDouble() * 100);
+        bar.low = static_cast<Price>(indicators["low"][i].asDouble() * 100);
+        bar.close = static_cast<Price>(indicators["close"][i].asDouble() * 100);
+        bar.volume = indicators["volume"][i].asUInt64();
+        data.push_back(bar);
+    }
+    return !data.empty();
+}
+
+static bool jsoncpp_yahoo_quote(const std::string& body, Price& price) {
+    Json::Value root;
+    Json::Reader reader;
+    if (!reader.parse(body, root)) return false;
+    auto meta = root["chart"]["result"][0]["meta"];
+    if (!meta.isMember("regularMarketPrice")) return false;
+    price = static_cast<Price>(meta["regularMarketPrice"].asDouble() * 100);
+    return true;
+}
+
+// "YYYY-MM-DD HH:MM:SS" US Eastern to Unix nanoseconds. The synthetic FMP and
+// Alpha Vantage series are all dated in June, so Eastern is UTC-4 (EDT).
+static uint64_t eastern_summer_ns(const std::string& text) {
+    std::tm local{};
+    if (std::sscanf(text.c_str(), "%d-%d-%d %d:%d:%d", &local.tm_year, &local.tm_mon, &local.tm_mday,
+                    &local.tm_hour, &local.tm_min, &local.tm_sec) != 6) {
+        return 0;
+    }
+    local.tm_year -= 1900;
+    local.tm_mon -= 1;
+    return (static_cast<uint64_t>(timegm(&local)) + 4 * 3600) * 1000000000ULL;
+}
+
+static bool jsoncpp_fmp_ohlcv(const std::string& body, int limit, std::vector<OHLCV>& data) {
+    Json::Value root;
+    Json::Reader reader;
+    if (!reader.parse(body, root)) return false;
+    data.clear();
+    int count = std::min(limit, static_cast<int>(root.size()));
+    for (int i = 0; i < count; ++i) {
+        auto bar_data = root[i];
+        OHLCV bar;
+        bar.symbol = "AAPL";
+        bar.timestamp = eastern_summer_ns(bar_data["date"].asString());
+        bar.open = static_cast<Price>(bar_data["open"].asDouble() * 100);
+        bar.high = static_cast<Price>(bar_data["high"].asDouble() * 100);
+        bar.low = static_cast<Price>(bar_data["low"].asDouble() * 100);
+        bar.close = static_cast<Price>(bar_data["close"].asDouble() * 100);
+        bar.volume = bar_data["volume"].asUInt64();
+        data.push_back(bar);
+    }
+    return !data.empty();
+}
+
+static bool jsoncpp_alpha_vantage_ohlcv(const std::string& body, int limit, std::vector<OHLCV>& data) {
+    Json::Value root;
+    Json::Reader reader;
+    if (!reader.parse(body, root)) return false;
+    auto time_series = root["Time Series (1min)"];
+    if (time_series.isNull()) return false;
+    data.clear();
+    int count = 0;
+    for (auto it = time_series.begin(); it != time_series.end() && count < limit; ++it, ++count) {
+        OHLCV bar;
+        bar.symbol = "AAPL";
+        bar.timestamp = eastern_summer_ns(it.key().asString());
+        bar.open = static_cast<Price>(std::stod((*it)["1. open"].asString()) * 100);
+        bar.high = static_cast<Price>(std::stod((*it)["2. high"].asString()) * 100);
+        bar.low = static_cast<Price>(std::stod((*it)["3. low"].asString()) * 100);
+        bar.close = static_cast<Price>(std::stod((*it)["4. close"].asString()) * 100);
+        bar.volume = std::stoull((*it)["5. volume"].asString());
+        data.push_back(bar);
+    }
+    return !data.empty();
+}
+
+// ----------------------------------------------------------------------------
+// Harness
+// ----------------------------------------------------------------------------
+
+static double time_us(int iterations, const std::function<void()>& fn) {
+    fn();  // Warm up
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+}
+
+static bool same_bars(const std::vector<OHLCV>& a, const std::vector<OHLCV>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].timestamp != b[i].timestamp || a[i].open != b[i].open || a[i].high != b[i].high ||
+            a[i].low != b[i].low || a[i].close != b[i].close || a[i].volume != b[i].volume) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// jsoncpp walks object members in key order, JsonView in document order
+// (newest first for Alpha Vantage), so compare those results as sets
+static bool same_bars_unordered(std::vector<OHLCV> a, std::vector<OHLCV> b) {
+    auto key = [](const OHLCV& bar) { return std::make_tuple(bar.open, bar.high, bar.low, bar.close, bar.volume); };
+    auto by_key = [&](const OHLCV& x, const OHLCV& y) { return key(x) < key(y); };
+    std::sort(a.begin(), a.end(), by_key);
+    std::sort(b.begin(), b.end(), by_key);
+    return same_bars(a, b);
+}
+
+static void report(const std::string& name, size_t bytes, double baseline_us, double view_us, bool match) {
+    std::cout << std::left << std::setw(30) << name << std::right
+              << std::setw(9) << bytes / 1024 << " KB"
+              << std::setw(12) << std::fixed << std::setprecision(2) << baseline_us << " us"
+              << std::setw(12) << view_us << " us"
+              << std::setw(9) << std::setprecision(1) << baseline_us / view_us << "x"
+              << (match ? "" : "   MISMATCH") << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::mt19937_64 rng(42);
+    std::string yahoo = yahoo_chart(390, rng);
+    if (argc > 1) {
+        std::ifstream file(argv[1]);
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        yahoo = buffer.str();
+        std::cout << "Yahoo chart response: " << argv[1] << std::endl;
+    }
+    std::string fmp = fmp_chart(390, rng);
+    std::string alpha = alpha_vantage_series(100, rng);
+    
+    YahooFinanceProvider yahoo_provider;
+    FinancialModelingPrepProvider fmp_provider("bench");
+    AlphaVantageProvider alpha_provider("bench");
+    const int iterations = 2000;
+    
+    std::cout << "\nProvider response parsing (" << iterations << " iterations each)" << std::endl;
+    std::cout << std::left << std::setw(30) << "Response" << std::right << std::setw(12) << "Size"
+              << std::setw(15) << "jsoncpp" << std::setw(15) << "JsonView" << std::setw(10) << "Speedup" << std::endl;
+    std::cout << std::string(82, '-') << std::endl;
+    
+    std::vector<OHLCV> expected, actual;
+    
+    // Quote: one field out of the whole chart document
+    Price jsoncpp_price = 0;
+    Quote quote;
+    jsoncpp_yahoo_quote(yahoo, jsoncpp_price);
+    yahoo_provider.parse_quote("AAPL", yahoo, quote);
+    report("Yahoo chart -> quote", yahoo.size(),
+           time_us(iterations, [&]() { jsoncpp_yahoo_quote(yahoo, jsoncpp_price); }),
+           time_us(iterations, [&]() { yahoo_provider.parse_quote("AAPL", yahoo, quote); }),
+           jsoncpp_price + 1 == quote.ask_price);
+    
+    // Last 5 bars and the whole day
+    for (int limit : {5, 390}) {
+        jsoncpp_yahoo_ohlcv(yahoo, limit, expected);
+        yahoo_provider.parse_ohlcv("AAPL", limit, yahoo, actual);
+        report("Yahoo chart -> " + std::to_string(limit) + " bars", yahoo.size(),
+               time_us(iterations, [&]() { jsoncpp_yahoo_ohlcv(yahoo, limit, expected); }),
+               time_us(iterations, [&]() { yahoo_provider.parse_ohlcv("AAPL", limit, yahoo, actual); }),
+               same_bars(expected, actual));
+    }
+    
+    jsoncpp_fmp_ohlcv(fmp, 100, expected);
+    fmp_provider.parse_ohlcv("AAPL", 100, fmp, actual);
+    report("FMP chart -> 100 bars", fmp.size(),
+           time_us(iterations, [&]() { jsoncpp_fmp_ohlcv(fmp, 100, expected); }),
+           time_us(iterations, [&]() { fmp_provider.parse_ohlcv("AAPL", 100, fmp, actual); }),
+           same_bars(expected, actual));
+    
+    jsoncpp_alpha_vantage_ohlcv(alpha, 100, expected);
+    alpha_provider.parse_ohlcv("AAPL", 100, alpha, actual);
+    report("Alpha Vantage -> 100 bars", alpha.size(),
+           time_us(iterations, [&]() { jsoncpp_alpha_vantage_ohlcv(alpha, 100, expected); }),
+           time_us(iterations, [&]() { alpha_provider.parse_ohlcv("AAPL", 100, alpha, actual); }),
+           same_bars_unordered(expected, actual));
+    
+    return 0;
+}
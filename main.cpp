@@ -1,5 +1,10 @@
 #include "backend/orderbook.hpp"
 #include "agent/rl_agent.hpp"
+#include "agent/sweep_runner.hpp"
+#include "agent/event_simulation.hpp"
+#include "agent/queue_position.hpp"
+#include "backend/async_logger.hpp"
+#include "backend/trace.hpp"
 #include <iostream>
 #include <iomanip>
 #include <thread>
@@ -12,12 +17,14 @@ class MarketMaker {
 private:
     RLAgent& agent_;
     Quantity quote_size_;
-    Price spread_ticks_;
+    Price spread_ticks_;      // Narrowest spread worth quoting into
     int64_t max_position_;
+    bool buy_next_;
     
 public:
-    MarketMaker(RLAgent& agent, Quantity size = 1000, Price spread = 2, int64_t max_pos = 10000)
-        : agent_(agent), quote_size_(size), spread_ticks_(spread), max_position_(max_pos) {}
+    MarketMaker(RLAgent& agent, Quantity size = 1000, Price spread = 1, int64_t max_pos = 10000)
+        : agent_(agent), quote_size_(size), spread_ticks_(spread), max_position_(max_pos),
+          buy_next_(true) {}
     
     RLAgent::Action operator()(const RLAgent::Observation& obs) {
         const auto& pos = obs.position;
@@ -38,13 +45,13 @@ public:
             return RLAgent::Action::BUY_LIMIT_AT_BID;
         }
         
-        // Otherwise, provide quotes on both sides
-        if (obs.active_orders.size() < 2 && market.best_bid > 0 && market.best_ask > 0) {
+        // Otherwise, provide quotes on both sides while the spread pays for it
+        if (obs.active_orders.size() < 2 && market.best_bid > 0 && market.best_ask > 0 &&
+            market.best_ask - market.best_bid >= spread_ticks_) {
             // Alternate between buy and sell
-            static bool buy_next = true;
-            buy_next = !buy_next;
-            return buy_next ? RLAgent::Action::BUY_LIMIT_AT_BID : 
-                             RLAgent::Action::SELL_LIMIT_AT_ASK;
+            buy_next_ = !buy_next_;
+            return buy_next_ ? RLAgent::Action::BUY_LIMIT_AT_BID : 
+                              RLAgent::Action::SELL_LIMIT_AT_ASK;
         }
         
         return RLAgent::Action::HOLD;
@@ -55,16 +62,24 @@ int main() {
     std::cout << "=== High-Performance Order Book for Nanosecond Trading ===" << std::endl;
     std::cout << "Optimized for ultra-low latency with RL integration\n" << std::endl;
     
+    // Trades go to the async log instead of stdout
+    // The benchmarks below trade in bursts, so give the ring room for them
+    OrderBookNS::AsyncLogger& logger = OrderBookNS::AsyncLogger::global();
+    OrderBookNS::LogConfig logging;
+    logging.ring_records = 1 << 16;
+    if (logger.start(logging)) {
+        std::cout << "Logging trades to " << logger.path() << std::endl;
+    }
+    
     // Create order book
     OrderBook book;
     
     // Register callbacks for monitoring
     book.register_trade_callback([](const Trade& trade) {
-        std::cout << "TRADE: "
-                  << "Price=" << trade.price / 100.0
-                  << ", Qty=" << trade.quantity
-                  << ", Buy #" << trade.buy_order_id
-                  << ", Sell #" << trade.sell_order_id << std::endl;
+        OB_LOG_INFO("TRADE: Price=%.2f, Qty=%llu, Buy #%llu, Sell #%llu", trade.price / 100.0,
+                    static_cast<unsigned long long>(trade.quantity),
+                    static_cast<unsigned long long>(trade.buy_order_id),
+                    static_cast<unsigned long long>(trade.sell_order_id));
     });
     
     std::cout << "\n=== Demo 1: Basic Order Book Operations ===" << std::endl;
@@ -139,6 +154,8 @@ int main() {
             std::cout << "  Portfolio Value: $" << obs.portfolio_value << std::endl;
             std::cout << "  Reward: " << reward.total << std::endl;
             std::cout << "  Active Orders: " << obs.active_orders.size() << std::endl;
+            std::cout << "  Queue Ahead (bid/ask): " << obs.bid_queue_ahead << " / "
+                      << obs.ask_queue_ahead << std::endl;
         }
     }
     
@@ -158,6 +175,181 @@ int main() {
     std::cout << "  Return: " 
               << ((final_obs.portfolio_value - 1000000.0) / 1000000.0 * 100) << "%" << std::endl;
     
+    std::cout << "\n=== Demo 4: Strategy Parameter Sweep ===" << std::endl;
+    
+    // Grid over the market maker's quoting parameters, evaluated on two regimes
+    ParamSpace space;
+    space.add_grid("quote_size", {100, 500, 1000})
+         .add_grid("spread_ticks", {1, 5, 20})
+         .add_grid("max_position", {200, 1000, 10000});
+    std::vector<ParamSet> configs = space.grid();
+    
+    std::vector<SweepDataset> datasets(2);
+    datasets[0].name = "calm";
+    datasets[0].volatility = 0.002;
+    datasets[1].name = "volatile";
+    datasets[1].volatility = 0.01;
+    datasets[1].arrival_rate = 100.0;
+    for (auto& d : datasets) d.num_steps = 500;
+    
+    StrategyFactory market_maker_factory = [](const ParamSet& params, RLAgent& agent) -> SweepStrategy {
+        auto mm = std::make_shared<MarketMaker>(
+            agent,
+            static_cast<Quantity>(params.get("quote_size", 1000)),
+            static_cast<Price>(params.get("spread_ticks", 2)),
+            static_cast<int64_t>(params.get("max_position", 10000)));
+        return [mm](const RLAgent::Observation& obs) { return (*mm)(obs); };
+    };
+    
+    SweepRunner runner;
+    runner.set_output("sweep_results.tsv");
+    
+    auto sweep_start = std::chrono::steady_clock::now();
+    runner.run_backtests(configs, {1, 2, 3}, datasets, market_maker_factory);
+    double sweep_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - sweep_start).count();
+    
+    std::cout << "Ran " << runner.completed() << " jobs on " << runner.thread_count()
+              << " threads in " << std::setprecision(1) << sweep_ms << " ms ("
+              << runner.steal_count() << " steals), results in sweep_results.tsv" << std::endl;
+    if (runner.failed() > 0) {
+        std::cout << runner.failed() << " jobs failed (see the error column)" << std::endl;
+    }
+    
+    auto ranking = runner.rank(configs);
+    std::cout << "Top configurations by mean Sharpe:" << std::endl;
+    for (size_t i = 0; i < std::min<size_t>(5, ranking.size()); ++i) {
+        std::cout << "  " << (i + 1) << ". " << ranking[i].params.to_string()
+                  << " | sharpe=" << std::setprecision(3) << ranking[i].mean_score
+                  << " | worst=" << ranking[i].worst_score
+                  << " | return=" << std::setprecision(4) << (ranking[i].mean_return * 100) << "%"
+                  << std::endl;
+    }
+    
+    std::cout << "\n=== Demo 5: Discrete-Event Simulation with Latency ===" << std::endl;
+    
+    {
+        OrderBook des_book;
+        MarketSimulator des_sim(des_book, base_price, 0.005, 5.0);  // 5 orders/us
+        des_sim.seed(7);
+        des_sim.set_order_lifetime(std::chrono::milliseconds(20));  // Noise orders rest ~20ms
+        des_sim.simulate_step(200);
+        RLAgent des_agent(des_book, 1000000.0);
+        MarketMaker des_strategy(des_agent);
+        
+        // 20us order entry, 15us market data, decisions every 50us
+        EventDrivenSimulation des(des_book, des_sim, des_agent, LatencyModel(20000, 15000, 2000), 50000);
+        des.set_order_size(500);
+        
+        auto des_start = std::chrono::steady_clock::now();
+        const auto& stats = des.run(100000000, des_strategy);  // 100ms simulated
+        double des_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - des_start).count();
+        
+        std::cout << "Simulated 100 ms in " << std::setprecision(1) << des_ms << " ms wall: "
+                  << stats.events << " events (" << stats.market_orders << " market orders, "
+                  << stats.market_data_updates << " md updates, " << stats.decisions
+                  << " decisions, " << stats.agent_orders << " agent orders, "
+                  << stats.expired_orders << " expired)" << std::endl;
+        std::cout << "Agent fills: " << des_agent.get_total_trades()
+                  << " | Position: " << des_agent.get_position().quantity << std::endl;
+        
+        // Raw scheduler throughput: self-rescheduling timers, no book work
+        EventScheduler scheduler;
+        for (uint64_t i = 0; i < 1024; ++i) {
+            SimEvent ev;
+            ev.tag = i;
+            scheduler.schedule_at(i * 97, ev);
+        }
+        const uint64_t target_events = 10000000;
+        auto sched_start = std::chrono::steady_clock::now();
+        while (scheduler.processed() < target_events) {
+            scheduler.step([&scheduler](const SimEvent& ev, SimTime now) {
+                scheduler.schedule_at(now + 1 + (ev.tag * 2654435761ULL) % 100000, ev);
+            });
+        }
+        double sched_s = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - sched_start).count();
+        std::cout << "Scheduler throughput: " << std::setprecision(1)
+                  << (scheduler.processed() / sched_s / 1e6) << "M events/s" << std::endl;
+    }
+    
+    std::cout << "\n=== Demo 6: Queue Position (L3 exact vs L2 estimate) ===" << std::endl;
+    
+    {
+        // A one-tick market: bids queue at base-1, asks at base+1
+        OrderBook q_book;
+        const Price bid = base_price - 1, ask = base_price + 1;
+        std::mt19937 flow_rng(11);
+        auto lot = [&flow_rng]() { return static_cast<Quantity>(100 * (1 + flow_rng() % 10)); };
+        std::vector<OrderId> flow;
+        for (int i = 0; i < 30; ++i) {
+            flow.push_back(q_book.add_order(bid, lot(), Side::BUY));
+            flow.push_back(q_book.add_order(ask, lot(), Side::SELL));
+        }
+        
+        // Join the bid; the agent tracks its place exactly from order ids
+        RLAgent q_agent(q_book);
+        q_agent.execute_action(RLAgent::Action::BUY_LIMIT_AT_BID, 500);
+        const OrderId ours = q_agent.get_observation().active_orders.back();
+        const auto& exact = q_agent.get_queue_tracker();
+        const Quantity joined_ahead = exact.queue_ahead(ours).value_or(0);
+        
+        // The same order as an L2 replay sees it: level sizes and trade prints only
+        QueuePositionTracker l2_prop(CancelAttribution::PROPORTIONAL);
+        QueuePositionTracker l2_rand(CancelAttribution::RANDOM, 11);
+        size_t step = 0, exact_fill = 0, l2_prop_fill = 0, l2_rand_fill = 0;
+        l2_prop.set_fill_callback([&](OrderId, Side, Price, Quantity) { if (!l2_prop_fill) l2_prop_fill = step; });
+        l2_rand.set_fill_callback([&](OrderId, Side, Price, Quantity) { if (!l2_rand_fill) l2_rand_fill = step; });
+        l2_prop.track(ours, Side::BUY, bid, 500, joined_ahead);
+        l2_rand.track(ours, Side::BUY, bid, 500, joined_ahead);
+        q_book.register_trade_callback([&](const Trade& trade) {
+            if (trade.buy_order_id < trade.sell_order_id) {  // Resting bid was hit
+                l2_prop.on_level_trade(Side::BUY, trade.price, trade.quantity);
+                l2_rand.on_level_trade(Side::BUY, trade.price, trade.quantity);
+            }
+        });
+        
+        auto show = [](std::optional<Quantity> q) {
+            return q ? std::to_string(*q) : std::string("filled");
+        };
+        std::cout << "Joined bid at $" << std::setprecision(2) << bid / 100.0
+                  << " with " << joined_ahead << " ahead" << std::endl;
+        std::cout << "  step     exact   L2 prop   L2 rand" << std::endl;
+        
+        for (step = 1; step <= 2000 && !(exact_fill && l2_prop_fill && l2_rand_fill); ++step) {
+            // Background flow: joins, cancels anywhere in the queues, and sells hitting the bid
+            unsigned r = flow_rng() % 100;
+            if (r < 35) {
+                flow.push_back(q_book.add_order(bid, lot(), Side::BUY));
+            } else if (r < 65 && !flow.empty()) {
+                size_t pick = flow_rng() % flow.size();
+                q_book.cancel_order(flow[pick]);
+                flow[pick] = flow.back();
+                flow.pop_back();
+            } else if (r < 80) {
+                q_book.add_order(bid, lot(), Side::SELL, OrderType::MARKET);
+            } else {
+                flow.push_back(q_book.add_order(ask, lot(), Side::SELL));
+            }
+            
+            auto own = q_book.get_order(ours);
+            Quantity own_resting = own && own->status != OrderStatus::FILLED ? own->remaining_quantity() : 0;
+            Quantity displayed = q_book.get_volume_at_price(bid, Side::BUY) - own_resting;
+            l2_prop.on_level_update(Side::BUY, bid, displayed);
+            l2_rand.on_level_update(Side::BUY, bid, displayed);
+            if (!exact_fill && q_agent.get_total_trades() > 0) exact_fill = step;
+            
+            if (step % 25 == 0) {
+                std::cout << std::setw(6) << step << std::setw(10) << show(exact.queue_ahead(ours))
+                          << std::setw(10) << show(l2_prop.queue_ahead(ours))
+                          << std::setw(10) << show(l2_rand.queue_ahead(ours)) << std::endl;
+            }
+        }
+        std::cout << "First fill at step: exact " << exact_fill << ", L2 proportional " << l2_prop_fill
+                  << ", L2 random " << l2_rand_fill << std::endl;
+    }
+    
     std::cout << "\n=== Performance Characteristics ===" << std::endl;
     std::cout << "Order Book Features:" << std::endl;
     std::cout << "  ✓ O(1) order insertion" << std::endl;
@@ -176,5 +368,13 @@ int main() {
     std::cout << "  ✓ Backtesting framework" << std::endl;
     std::cout << "  ✓ Market simulation for training" << std::endl;
     
+    logger.stop();
+    std::cout << "\nLogged " << logger.written() << " lines (" << logger.dropped() << " dropped)" << std::endl;
+    if (OrderBookNS::Tracer::ENABLED) {
+        std::string trace_path = OrderBookNS::Tracer::dump_path("orderbook");
+        if (OrderBookNS::Tracer::global().dump(trace_path)) {
+            std::cout << "Traced " << OrderBookNS::Tracer::global().recorded() << " spans to " << trace_path << std::endl;
+        }
+    }
     return 0;
 }
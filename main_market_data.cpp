@@ -1,10 +1,19 @@
 #include "backend/orderbook.hpp"
 #include "backend/market_data.hpp"
+#include "backend/request_scheduler.hpp"
+#include "backend/bar_cache.hpp"
+#include "backend/tick_recorder.hpp"
+#include "backend/quote_reconciler.hpp"
+#include "backend/thread_topology.hpp"
+#include "backend/async_logger.hpp"
+#include "backend/metrics_server.hpp"
+#include "backend/trace.hpp"
 #include "config/config_loader.hpp"
 #include <iostream>
 #include <iomanip>
 #include <thread>
 #include <chrono>
+#include <future>
 #include <signal.h>
 
 using namespace OrderBookNS;
@@ -16,6 +25,21 @@ void signal_handler(int) {
     running = false;
 }
 
+volatile bool trace_requested = false;
+
+void trace_signal_handler(int) {
+    trace_requested = true;
+}
+
+void dump_trace() {
+    std::string path = Tracer::dump_path("orderbook_market");
+    if (Tracer::global().dump(path)) {
+        std::cout << "Traced " << Tracer::global().recorded() << " spans to " << path << std::endl;
+    } else {
+        std::cout << "Could not write trace to " << path << std::endl;
+    }
+}
+
 void print_quote(const Quote& quote) {
     std::cout << "\n" << std::string(60, '=') << std::endl;
     std::cout << "Symbol: " << quote.symbol << std::endl;
@@ -60,8 +84,28 @@ void print_order_book(orderbook::OrderBook& book, const std::string& symbol) {
     std::cout << std::string(60, '=') << std::endl;
 }
 
+void print_threads() {
+    std::cout << "\nThreads:" << std::endl;
+    for (size_t i = 0; i < THREAD_ROLE_COUNT; ++i) {
+        ThreadRole role = static_cast<ThreadRole>(i);
+        ThreadStatsSnapshot stats = ThreadTopology::global().snapshot(role);
+        if (!stats.active) continue;
+        std::cout << "  " << std::left << std::setw(10) << role_name(role) << std::right
+                  << " cpu " << std::setw(3) << stats.cpu << (stats.pinned ? " pinned" : "       ")
+                  << (stats.realtime ? " fifo" : "     ")
+                  << std::setw(8) << std::fixed << std::setprecision(1) << stats.cpu_utilization * 100 << "% cpu"
+                  << std::setw(10) << stats.work_loops << " busy loops"
+                  << "  p50 " << stats.p50_work_ns / 1000.0 << " us  p99 " << stats.p99_work_ns / 1000.0
+                  << " us" << std::endl;
+    }
+}
+
 int main(int argc, char* argv[]) {
     signal(SIGINT, signal_handler);
+    if (Tracer::ENABLED) {
+        // kill -USR1 <pid> writes the spans so far without stopping
+        signal(SIGUSR1, trace_signal_handler);
+    }
     
     std::cout << "=== Real-Time Order Book with Live Market Data ===" << std::endl;
     std::cout << "Loading configuration..." << std::endl;
@@ -73,12 +117,53 @@ int main(int argc, char* argv[]) {
         std::cout << "Note: Yahoo Finance will work without API keys" << std::endl;
     }
     
+    // Capacities and thread placement are fixed from here on
+    std::vector<std::string> config_errors;
+    if (!config.validate(config_errors)) {
+        for (const auto& error : config_errors) {
+            std::cerr << "Config error: " << error << std::endl;
+        }
+        return 1;
+    }
+    const CapacityConfig& capacity = config.get_capacity();
+    config.configure_threads(ThreadTopology::global());
+    
+    // Warnings and errors go to the async log from here on
+    AsyncLogger& logger = AsyncLogger::global();
+    const LogConfig& logging = config.get_logging();
+    if (!logging.file.empty() && !logger.start(logging)) {
+        std::cerr << "Warning: could not open log file " << logging.file << std::endl;
+    }
+    
+    // --stream[=URL] subscribes to the local quote server's push stream
+    std::string stream_url;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--stream") {
+            stream_url = "http://localhost:8080";
+        } else if (arg.rfind("--stream=", 0) == 0) {
+            stream_url = arg.substr(9);
+        } else {
+            args.push_back(arg);
+        }
+    }
+    
     std::string symbol = config.get_default_symbol();
-    if (argc > 1) {
-        symbol = argv[1];
+    if (!args.empty()) {
+        symbol = args[0];
+    }
+    
+    // Further arguments form a watch list, fetched in one batch per update
+    std::vector<std::string> watchlist{symbol};
+    for (size_t i = 1; i < args.size(); ++i) {
+        watchlist.push_back(args[i]);
     }
     
     std::cout << "Tracking symbol: " << symbol << std::endl;
+    if (watchlist.size() > 1) {
+        std::cout << "Watching " << watchlist.size() - 1 << " more symbol(s)" << std::endl;
+    }
     
     // Initialize market data providers
     MarketDataAggregator aggregator;
@@ -117,47 +202,112 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    // Keep fetched bars on disk; later bar requests only fetch what is new
+    if (!config.get_cache_dir().empty()) {
+        aggregator.set_bar_cache(std::make_shared<BarCache>(config.get_cache_dir()));
+        std::cout << "Caching bars under " << config.get_cache_dir() << "/" << std::endl;
+    }
+    
+    // Connect to the providers while the order book is being set up
+    aggregator.warm_up();
+    
+    // Record quotes and book events for later replay
+    TickRecorder recorder(config.get_record_dir(), capacity.record_queue);
+    bool recording = !config.get_record_dir().empty() && recorder.start();
+    
     // Initialize order book
-    orderbook::OrderBook book;
+    orderbook::OrderBook book(capacity.book);
+    if (recording) {
+        recorder.attach(book, symbol);
+        std::cout << "Recording session to " << recorder.session_dir() << "/" << std::endl;
+    }
+    
+    LadderConfig ladder_config;
+    ladder_config.quote_sized = true;
+    QuoteReconciler ladder(book, ladder_config);
     
     // Start market data feed
     MarketDataFeed feed(aggregator);
     feed.set_update_interval(config.get_update_interval_ms());
-    feed.start(symbol);
+    if (recording) {
+        feed.set_recorder(&recorder);
+    }
+    if (!stream_url.empty()) {
+        feed.start_stream(stream_url, watchlist);
+        std::cout << "\nStreaming live market data from " << stream_url << "..." << std::endl;
+    } else {
+        feed.start(watchlist);
+        std::cout << "\nFetching live market data every " << config.get_update_interval_ms() / 1000 
+                  << " seconds..." << std::endl;
+    }
     
-    std::cout << "\nFetching live market data every " << config.get_update_interval_ms() / 1000 
-              << " seconds..." << std::endl;
+    // Prometheus endpoint; collectors read only atomics
+    MetricsServer metrics_server(config.get_metrics_port());
+    if (config.get_metrics_port() != 0) {
+        book.set_latency_tracking(true);
+        auto trackers = aggregator.get_provider_trackers();
+        metrics_server.add_collector([&book](MetricsWriter& out) { collect_book_metrics(out, book); });
+        metrics_server.add_collector([trackers](MetricsWriter& out) { collect_provider_metrics(out, trackers); });
+        if (metrics_server.start()) {
+            std::cout << "Metrics at http://" << metrics_server.address() << ":" << metrics_server.port() << "/metrics" << std::endl;
+        } else {
+            std::cerr << "Warning: metrics endpoint not started (" << metrics_server.error() << ")" << std::endl;
+        }
+    }
     std::cout << "Press Ctrl+C to exit\n" << std::endl;
     
+    std::future<std::optional<std::vector<OHLCV>>> pending_bars;
     int iteration = 0;
+    uint64_t seen = 0;
+    // Entered after the feed started so its thread does not inherit this placement
+    PollLoop loop(ThreadRole::MATCHING);
     while (running) {
+        if (trace_requested) {
+            trace_requested = false;
+            dump_trace();
+        }
+        
+        // The feed polls in the background; wait here for its next quote
         Quote quote;
-        if (feed.get_latest_quote(quote)) {
+        if (feed.wait_for_update(seen, std::chrono::milliseconds(2 * config.get_update_interval_ms())) &&
+            feed.get_latest_quote(quote)) {
+            uint64_t start = loop.begin();
+            seen = feed.updates();
             print_quote(quote);
             
-            // Simulate order book updates based on market data
+            if (watchlist.size() > 1) {
+                std::cout << "\nWatch list:" << std::endl;
+                for (const auto& name : feed.symbols()) {
+                    Quote watched;
+                    std::cout << "  " << std::left << std::setw(8) << name << std::right;
+                    if (feed.get_latest_quote(name, watched)) {
+                        std::cout << std::setw(10) << std::fixed << std::setprecision(2) << watched.bid_price / 100.0
+                                  << " / " << std::setw(10) << watched.ask_price / 100.0 << std::endl;
+                    } else {
+                        std::cout << std::setw(10) << "-" << std::endl;
+                    }
+                }
+            }
+            
+            // Mirror the quote into the book: one quote-sized level a side,
+            // replacing the previous quote's orders
             // In a real system, you'd get actual order book data
-            book.add_order(
-                quote.bid_price,
-                quote.bid_size,
-                Side::BUY,
-                OrderType::LIMIT
-            );
+            ladder.reconcile(quote);
             
-            book.add_order(
-                quote.ask_price,
-                quote.ask_size,
-                Side::SELL,
-                OrderType::LIMIT
-            );
+            loop.record(start, true);
             
             // Print order book state
             print_order_book(book, symbol);
             
-            // Get and print OHLCV data occasionally
-            if (iteration % 3 == 0) {
-                std::vector<OHLCV> ohlcv_data;
-                if (aggregator.get_ohlcv(symbol, ohlcv_data, "1min", 5)) {
+            // Request OHLCV data occasionally and print it once it arrives; a
+            // rate-limited provider delays the bars, not the quote loop
+            if (iteration % 3 == 0 && !pending_bars.valid()) {
+                pending_bars = aggregator.scheduler().request_ohlcv(symbol, "1min", 5);
+            }
+            if (pending_bars.valid() &&
+                pending_bars.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                if (auto bars = pending_bars.get()) {
+                    const std::vector<OHLCV>& ohlcv_data = *bars;
                     std::cout << "\nRecent 1-minute bars:" << std::endl;
                     std::cout << std::string(60, '-') << std::endl;
                     std::cout << std::setw(12) << "OPEN" << " | "
@@ -192,16 +342,39 @@ int main(int argc, char* argv[]) {
                 std::cout << "Spread: $" << std::fixed << std::setprecision(2) 
                           << ((*best_ask_opt - *best_bid_opt) / 100.0) << std::endl;
             }
+            
+            std::cout << "\nProvider Health:" << std::endl;
+            for (const auto& [name, health] : aggregator.get_provider_health()) {
+                std::cout << "  " << std::left << std::setw(28) << name << std::right
+                          << std::setw(10) << ProviderHealth::state_name(health.state)
+                          << std::setw(10) << std::fixed << std::setprecision(1) << health.latency_ms << " ms"
+                          << std::setw(8) << std::setprecision(0) << (health.error_rate * 100.0) << "% err"
+                          << std::endl;
+            }
         } else {
             std::cout << "Failed to fetch quote for " << symbol << std::endl;
         }
         
         iteration++;
-        std::this_thread::sleep_for(std::chrono::milliseconds(config.get_update_interval_ms()));
     }
     
+    metrics_server.stop();
     feed.stop();
+    recorder.stop();
+    logger.stop();
     std::cout << "\n\nShutting down..." << std::endl;
+    if (recording) {
+        std::cout << "Recorded " << recorder.written() << " events (" << recorder.dropped()
+                  << " dropped) to " << recorder.session_dir() << "/" << std::endl;
+    }
+    if (!logging.file.empty()) {
+        std::cout << "Logged " << logger.written() << " lines (" << logger.dropped()
+                  << " dropped) to " << logger.path() << std::endl;
+    }
+    if (Tracer::ENABLED) {
+        dump_trace();
+    }
+    print_threads();
     
     return 0;
 }
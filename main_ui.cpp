@@ -3,10 +3,17 @@
 #include "frontend/terminal_ui.hpp"
 #include "backend/market_data.hpp"
 #include "backend/yfinance_provider.hpp"
+#include "backend/tick_recorder.hpp"
+#include "backend/quote_reconciler.hpp"
+#include "backend/thread_topology.hpp"
+#include "backend/async_logger.hpp"
+#include "backend/metrics_server.hpp"
+#include "backend/trace.hpp"
 #include "config/config_loader.hpp"
 #include <iostream>
 #include <iomanip>
 #include <thread>
+#include <functional>
 #include <chrono>
 #include <atomic>
 #include <limits>
@@ -14,8 +21,6 @@
 using namespace orderbook;
 using namespace OrderBookNS;
 
-std::atomic<bool> running{true};
-
 int main(int argc, char* argv[]) {
     try {
         // Delete previous session report if it exists
@@ -30,6 +35,24 @@ int main(int argc, char* argv[]) {
             std::cout << "Warning: Could not load config.json, using defaults" << std::endl;
         }
         
+        // Capacities and thread placement are fixed from here on
+        std::vector<std::string> config_errors;
+        if (!config.validate(config_errors)) {
+            for (const auto& error : config_errors) {
+                std::cerr << "Config error: " << error << std::endl;
+            }
+            return 1;
+        }
+        const CapacityConfig& capacity = config.get_capacity();
+        config.configure_threads(ThreadTopology::global());
+        
+        // Warnings and errors go to the async log from here on
+        AsyncLogger& logger = AsyncLogger::global();
+        const LogConfig& logging = config.get_logging();
+        if (!logging.file.empty() && !logger.start(logging)) {
+            std::cerr << "Warning: could not open log file " << logging.file << std::endl;
+        }
+        
         std::string symbol = config.get_default_symbol();
         if (argc > 1) {
             symbol = argv[1];
@@ -37,8 +60,18 @@ int main(int argc, char* argv[]) {
         
         std::cout << "Tracking symbol: " << symbol << std::endl;
         
-        // Create order book
-        OrderBook book;
+        // Record quotes, trades and order updates for later replay; declared
+        // before the book so it outlives the book's callbacks
+        TickRecorder recorder(config.get_record_dir(), capacity.record_queue);
+        bool recording = !config.get_record_dir().empty() && recorder.start();
+        
+        // Create order book, preallocated to the configured capacity
+        OrderBook book(capacity.book);
+        book.set_latency_tracking(true);  // Shown in the perf panel and served as metrics
+        if (recording) {
+            recorder.attach(book, symbol);
+            std::cout << "Recording session to " << recorder.session_dir() << "/" << std::endl;
+        }
         
         // Initialize market data providers
         MarketDataAggregator aggregator;
@@ -78,10 +111,28 @@ int main(int argc, char* argv[]) {
         
         // Start market data feed in background thread
         std::shared_ptr<MarketDataFeed> feed_ptr;
-        std::thread market_thread;
+        
+        // Market activity runs on the UI's control thread, the only thread
+        // that touches the book (see TerminalUI::set_book_task)
+        std::function<bool()> market_task;
+        MarketSimulator sim(book, 25000, 0.005, 50.0);
+        sim.set_order_lifetime(std::chrono::seconds(30));  // Noise orders rest ~30s
+        uint64_t seen_updates = 0;
+        uint64_t next_step_ns = 0;
+        
+        // Synthetic liquidity around the live quote: quote-sized levels on
+        // each side, reconciled on every quote so the book stays bounded
+        LadderConfig ladder_config;
+        ladder_config.levels = capacity.ladder_levels;
+        ladder_config.quote_sized = true;
+        QuoteReconciler ladder(book, ladder_config);
         if (!providers.empty()) {
+            aggregator.warm_up();
             feed_ptr = std::make_shared<MarketDataFeed>(aggregator);
             feed_ptr->set_update_interval(config.get_update_interval_ms());
+            if (recording) {
+                feed_ptr->set_recorder(&recorder);
+            }
             feed_ptr->start(symbol);
             
             std::cout << "Market data feed started (updating every " 
@@ -99,21 +150,7 @@ int main(int argc, char* argv[]) {
                               << " x " << quote.ask_size << std::endl;
                     
                     // Add initial liquidity around the market quote
-                    for (int i = 0; i < 10; ++i) {
-                        book.add_order(
-                            quote.bid_price - i,
-                            quote.bid_size,
-                            Side::BUY,
-                            OrderType::LIMIT
-                        );
-                        
-                        book.add_order(
-                            quote.ask_price + i,
-                            quote.ask_size,
-                            Side::SELL,
-                            OrderType::LIMIT
-                        );
-                    }
+                    ladder.reconcile(quote);
                     got_initial_data = true;
                 } else {
                     std::cout << "Waiting for market data..." << std::endl;
@@ -130,28 +167,34 @@ int main(int argc, char* argv[]) {
                 }
             }
             
-            // Start background thread to continuously update market data and simulate activity
-            market_thread = std::thread([&book, feed_ptr]() {
-                MarketSimulator sim(book, 25000, 0.005, 50.0);
-                int counter = 0;
-                while (running.load()) {
-                    // Generate market activity every 200ms
+            // Continuously follow market data and simulate activity
+            seen_updates = feed_ptr->updates();
+            market_task = [&book, &ladder, &sim, &seen_updates, &next_step_ns, feed_ptr]() {
+                bool worked = false;
+                
+                // The book's clock is the wall clock; stale noise orders expire here
+                book.advance_time(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count()));
+                
+                // Generate market activity every 200ms
+                uint64_t now = PollLoop::now_ns();
+                if (now >= next_step_ns) {
                     sim.simulate_step(5); // Add 5 random orders
-                    
-                    // Update with real market data every 3 seconds
-                    if (++counter >= 15) {
-                        Quote quote;
-                        if (feed_ptr->get_latest_quote(quote)) {
-                            // Add fresh orders at market prices
-                            book.add_order(quote.bid_price, 50, Side::BUY, OrderType::LIMIT);
-                            book.add_order(quote.ask_price, 50, Side::SELL, OrderType::LIMIT);
-                        }
-                        counter = 0;
-                    }
-                    
-                    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                    next_step_ns = now + 200000000;
+                    worked = true;
+                }
+                
+                // The feed polls on its own thread; reading its latest quote
+                // never waits on the network
+                Quote quote;
+                if (feed_ptr->updates() != seen_updates && feed_ptr->get_latest_quote(quote)) {
+                    seen_updates = feed_ptr->updates();
+                    // Move the synthetic ladder to the new market prices
+                    ladder.reconcile(quote);
+                    worked = true;
                 }
-            });
+                return worked;
+            };
         } else {
             std::cout << "No market data providers available - using manual orders only" << std::endl;
             // Add initial liquidity manually
@@ -172,6 +215,27 @@ int main(int argc, char* argv[]) {
         
         // Create terminal UI with RL agent
         TerminalUI ui(book, &agent);
+        ui.set_feed(feed_ptr.get());
+        ui.set_book_task(std::move(market_task));
+        if (recording) {
+            ui.set_recorder(&recorder);
+        }
+        
+        // Prometheus endpoint; collectors read only atomics
+        MetricsServer metrics_server(config.get_metrics_port());
+        bool serving_metrics = false;
+        if (config.get_metrics_port() != 0) {
+            auto trackers = aggregator.get_provider_trackers();
+            metrics_server.add_collector([&book](MetricsWriter& out) { collect_book_metrics(out, book); });
+            metrics_server.add_collector([trackers](MetricsWriter& out) { collect_provider_metrics(out, trackers); });
+            metrics_server.add_collector([&ui](MetricsWriter& out) { ui.collect_metrics(out); });
+            serving_metrics = metrics_server.start();
+            if (serving_metrics) {
+                std::cout << "Metrics at http://" << metrics_server.address() << ":" << metrics_server.port() << "/metrics" << std::endl;
+            } else {
+                std::cerr << "Warning: metrics endpoint not started (" << metrics_server.error() << ")" << std::endl;
+            }
+        }
         ui.init();
         
         std::cout << "UI initialized. Press 'a' to toggle automated trading mode." << std::endl;
@@ -180,13 +244,20 @@ int main(int argc, char* argv[]) {
         ui.run();
         
         // Cleanup
-        running = false;
-        if (market_thread.joinable()) {
-            market_thread.join();
-        }
-        
-        // Cleanup
+        metrics_server.stop();
         ui.cleanup();
+        if (feed_ptr) {
+            feed_ptr->stop();
+        }
+        recorder.stop();
+        logger.stop();
+        std::string trace_path;
+        if (Tracer::ENABLED) {
+            trace_path = Tracer::dump_path("orderbook_ui");
+            if (!Tracer::global().dump(trace_path)) {
+                trace_path.clear();
+            }
+        }
         
         // Generate Session Report Markdown File
         std::ofstream report("SESSION_REPORT.md");
@@ -253,6 +324,16 @@ int main(int argc, char* argv[]) {
             report << "| Average Trade Size | " << (agent.get_total_volume() / agent.get_total_trades()) << " shares |\n";
             report << "| Average P&L per Trade | $" << std::setprecision(2) << (total_pnl / agent.get_total_trades()) << " |\n";
         }
+        
+        auto metrics = agent.get_metrics();
+        report << "| Round Trips | " << metrics.round_trips << " |\n";
+        report << "| Win Rate | " << std::setprecision(2) << (metrics.win_rate * 100) << "% |\n";
+        report << "| Profit Factor | " << metrics.profit_factor << " |\n";
+        report << "| Avg Holding Time | " << metrics.avg_holding_time_s << " s (" 
+               << metrics.avg_trade_duration << " decisions) |\n";
+        report << "| Turnover | " << metrics.turnover << "x |\n";
+        report << "| Sharpe Ratio | " << metrics.sharpe_ratio << " |\n";
+        report << "| Max Drawdown | " << (metrics.max_drawdown * 100) << "% |\n";
         report << "\n";
         
         // Performance & Latency Metrics
@@ -282,7 +363,9 @@ int main(int argc, char* argv[]) {
         report << "## 📖 Order Book Statistics\n\n";
         report << "| Metric | Value |\n";
         report << "|--------|-------|\n";
-        report << "| Total Orders Placed | " << book.get_order_count() << " |\n";
+        report << "| Resting Orders | " << book.get_order_count() << " |\n";
+        report << "| Synthetic Ladder Orders | " << ladder.owned() << " (" << ladder.totals().adds
+               << " adds, " << ladder.totals().amends << " amends, " << ladder.totals().cancels << " cancels) |\n";
         report << "| Active Bid Levels | " << book.get_bid_level_count() << " |\n";
         report << "| Active Ask Levels | " << book.get_ask_level_count() << " |\n";
         if (best_bid && best_ask) {
@@ -323,6 +406,48 @@ int main(int argc, char* argv[]) {
             report << "The RL agent maintained **neutral performance** with no significant profit or loss.\n";
         }
         
+        if (recording) {
+            report << "\n## 🎞️ Tick Recording\n\n";
+            report << "- **Directory:** `" << recorder.session_dir() << "`\n";
+            report << "- **Events Written:** " << recorder.written() << "\n";
+            report << "- **Events Dropped:** " << recorder.dropped() << "\n";
+        }
+        
+        if (!logging.file.empty()) {
+            report << "\n## 📝 Log\n\n";
+            report << "- **File:** `" << logger.path() << "`\n";
+            report << "- **Lines Written:** " << logger.written() << "\n";
+            report << "- **Lines Dropped:** " << logger.dropped() << "\n";
+        }
+        
+        if (serving_metrics) {
+            report << "\n## 📡 Metrics\n\n";
+            report << "- **Endpoint:** `http://" << metrics_server.address() << ":" << metrics_server.port() << "/metrics`\n";
+            report << "- **Scrapes Served:** " << metrics_server.scrapes() << "\n";
+        }
+        
+        if (!trace_path.empty()) {
+            report << "\n## 🔬 Trace\n\n";
+            report << "- **File:** `" << trace_path << "`\n";
+            report << "- **Spans Recorded:** " << Tracer::global().recorded() << "\n";
+        }
+        
+        report << "\n## 🧵 Threads\n\n";
+        report << "| Role | CPU | Pinned | FIFO | Wait | CPU Use | Busy Loops | p50 Work | p99 Work | Max Work |\n";
+        report << "|------|-----|--------|------|------|---------|------------|----------|----------|----------|\n";
+        for (size_t i = 0; i < THREAD_ROLE_COUNT; ++i) {
+            ThreadRole role = static_cast<ThreadRole>(i);
+            ThreadStatsSnapshot stats = ThreadTopology::global().snapshot(role);
+            if (!stats.active) continue;
+            report << "| " << role_name(role) << " | " << stats.cpu << " | " << (stats.pinned ? "yes" : "no")
+                   << " | " << (stats.realtime ? "yes" : "no") << " | "
+                   << wait_mode_name(ThreadTopology::global().config(role).wait) << " | "
+                   << std::setprecision(1) << stats.cpu_utilization * 100 << "% | "
+                   << stats.work_loops << " / " << stats.loops << " | "
+                   << stats.p50_work_ns / 1000.0 << " us | " << stats.p99_work_ns / 1000.0 << " us | "
+                   << stats.max_work_ns / 1000.0 << " us |\n";
+        }
+        
         report << "\n---\n\n";
         report << "*Report generated automatically by Order Book Trading System*  \n";
         report << "*Session ended at " << timestamp << "*\n";
@@ -337,7 +462,7 @@ int main(int argc, char* argv[]) {
         std::cin.clear();
         std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
         std::cin.get();
-        
+    
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+"""
+Stand-in for yfinance_server.py that needs no network access.
+Serves the same endpoints (/quote, /quotes, /stream, /health) with random-walk
+quotes, in JSON or the binary wire format, and pushes stream events at a
+configurable rate so the C++ streaming client can be exercised and timed
+locally.
+
+Usage: quote_simulator.py [port] [events_per_second]
+"""
+
+import gzip
+import json
+import random
+import sys
+import threading
+import time
+from http.server import ThreadingHTTPServer, BaseHTTPRequestHandler
+from urllib.parse import urlparse, parse_qs
+from wire_format import CONTENT_TYPE as WIRE_CONTENT_TYPE, MAGIC as WIRE_MAGIC, WireEncoder, \
+    accepts_wire, encode_quotes
+
+PORT = 8080
+EVENTS_PER_SECOND = 100.0
+HEARTBEAT_INTERVAL = 15  # seconds
+GZIP_MIN_SIZE = 1024     # bytes
+
+prices = {}
+prices_lock = threading.Lock()
+
+def next_quote(symbol):
+    """Step the symbol's mid price and return a quote in the server's format."""
+    with prices_lock:
+        mid = prices.get(symbol, random.uniform(20.0, 500.0))
+        mid = max(1.0, mid + random.gauss(0.0, 0.02))
+        prices[symbol] = mid
+    spread = max(0.01, mid * 0.0002)
+    return {
+        'symbol': symbol,
+        'bid_price': int((mid - spread / 2) * 100),
+        'ask_price': int((mid + spread / 2) * 100),
+        'bid_size': random.randint(1, 50) * 100,
+        'ask_size': random.randint(1, 50) * 100,
+        'last_price': int(mid * 100),
+        'timestamp': int(time.time())
+    }
+
+def parse_symbols(params, name='symbols'):
+    """Comma-separated symbol list from a query parameter, upper-cased, no duplicates."""
+    symbols = []
+    for symbol in params.get(name, [''])[0].upper().split(','):
+        symbol = symbol.strip()
+        if symbol and symbol not in symbols:
+            symbols.append(symbol)
+    return symbols
+
+class SimulatorHandler(BaseHTTPRequestHandler):
+    """Same endpoints as the yfinance server, backed by the random walk."""
+    
+    protocol_version = 'HTTP/1.1'
+    disable_nagle_algorithm = True
+    
+    def log_message(self, format, *args):
+        pass
+    
+    def do_HEAD(self):
+        self.send_response(200)
+        self.send_header('Content-Length', '0')
+        self.end_headers()
+    
+    def send_quotes(self, quotes, json_value):
+        """Reply in the binary wire format if the client accepts it, else JSON (gzipped if large)."""
+        wire = accepts_wire(self.headers.get('Accept'))
+        body = encode_quotes(quotes) if wire else json.dumps(json_value).encode()
+        gzipped = len(body) >= GZIP_MIN_SIZE and 'gzip' in self.headers.get('Accept-Encoding', '')
+        if gzipped:
+            body = gzip.compress(body, compresslevel=1)
+        self.send_response(200)
+        self.send_header('Content-type', WIRE_CONTENT_TYPE if wire else 'application/json')
+        if gzipped:
+            self.send_header('Content-Encoding', 'gzip')
+        self.send_header('Content-Length', str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+    
+    def do_GET(self):
+        parsed = urlparse(self.path)
+        params = parse_qs(parsed.query)
+        
+        if parsed.path == '/quote':
+            symbol = params.get('symbol', [''])[0].upper()
+            if not symbol:
+                self.send_error(400, "Missing symbol parameter")
+                return
+            quote = next_quote(symbol)
+            self.send_quotes([quote], quote)
+        
+        elif parsed.path == '/quotes':
+            symbols = parse_symbols(params)
+            if not symbols:
+                self.send_error(400, "Missing symbols parameter")
+                return
+            quotes = [next_quote(symbol) for symbol in symbols]
+            self.send_quotes(quotes, quotes)
+        
+        elif parsed.path == '/stream':
+            symbols = parse_symbols(params)
+            if not symbols:
+                self.send_error(400, "Missing symbols parameter")
+                return
+            self.stream_quotes(symbols)
+        
+        elif parsed.path == '/health':
+            self.send_response(200)
+            self.send_header('Content-type', 'text/plain')
+            self.send_header('Content-Length', '2')
+            self.end_headers()
+            self.wfile.write(b'OK')
+        
+        else:
+            self.send_error(404, "Endpoint not found")
+    
+    def stream_quotes(self, symbols):
+        """Round-robin over the symbols at EVENTS_PER_SECOND until the client leaves."""
+        wire = accepts_wire(self.headers.get('Accept'))
+        self.send_response(200)
+        self.send_header('Content-type', WIRE_CONTENT_TYPE if wire else 'text/event-stream')
+        self.send_header('Cache-Control', 'no-cache')
+        self.send_header('Connection', 'close')
+        self.end_headers()
+        self.close_connection = True
+        
+        encoder = WireEncoder()
+        if wire:
+            self.wfile.write(WIRE_MAGIC)
+        
+        interval = 1.0 / EVENTS_PER_SECOND
+        next_event = time.time()
+        last_heartbeat = time.time()
+        index = 0
+        try:
+            while True:
+                quote = next_quote(symbols[index % len(symbols)])
+                index += 1
+                if wire:
+                    self.wfile.write(encoder.quote(quote))
+                else:
+                    self.wfile.write(b'data: ' + json.dumps(quote).encode() + b'\n\n')
+                now = time.time()
+                if now - last_heartbeat >= HEARTBEAT_INTERVAL:
+                    self.wfile.write(encoder.heartbeat() if wire else b': keepalive\n\n')
+                    last_heartbeat = now
+                
+                # Flush per event unless we are behind schedule (then batch a little)
+                next_event += interval
+                delay = next_event - time.time()
+                if delay > 0:
+                    self.wfile.flush()
+                    time.sleep(delay)
+        except (BrokenPipeError, ConnectionResetError):
+            pass
+
+if __name__ == '__main__':
+    port = int(sys.argv[1]) if len(sys.argv) > 1 else PORT
+    if len(sys.argv) > 2:
+        EVENTS_PER_SECOND = float(sys.argv[2])
+    
+    httpd = ThreadingHTTPServer(('', port), SimulatorHandler)
+    httpd.daemon_threads = True
+    print(f"Quote simulator on port {port}, streaming {EVENTS_PER_SECOND:g} events/s per connection")
+    print("Press Ctrl+C to stop")
+    try:
+        httpd.serve_forever()
+    except KeyboardInterrupt:
+        httpd.shutdown()
@@ -0,0 +1,75 @@
+"""
+Binary quote encoding shared by the quote servers (see backend/wire_format.hpp).
+
+A body or stream is the 4-byte magic followed by frames. Each frame has a
+16-byte little-endian header (length, type, flags, symbol id, sequence) and a
+fixed payload. Symbol ids are defined per body/stream by SYMBOL frames.
+"""
+
+import struct
+
+CONTENT_TYPE = 'application/x-orderbook-wire'
+MAGIC = b'OBW1'
+
+SYMBOL = 1
+QUOTE = 2
+TRADE = 3
+OHLCV = 4
+HEARTBEAT = 5
+
+HEADER = struct.Struct('<HBBIQ')
+QUOTE_PAYLOAD = struct.Struct('<qqQQQ')
+TRADE_PAYLOAD = struct.Struct('<qQQ')
+OHLCV_PAYLOAD = struct.Struct('<QqqqqQ')
+MAX_SYMBOL_LENGTH = 64
+
+def accepts_wire(accept_header):
+    """True when the client's Accept header lists the wire format."""
+    return CONTENT_TYPE in (accept_header or '')
+
+class WireEncoder:
+    """Frames for one body or stream: symbol ids and sequence numbers restart per encoder."""
+    
+    def __init__(self):
+        self.sequence = 0
+        self.symbols = {}
+    
+    def _frame(self, kind, symbol_id, payload=b''):
+        frame = HEADER.pack(HEADER.size + len(payload), kind, 0, symbol_id, self.sequence) + payload
+        self.sequence += 1
+        return frame
+    
+    def _symbol(self, symbol):
+        """Id for the symbol, plus its SYMBOL frame the first time it is used."""
+        if symbol in self.symbols:
+            return self.symbols[symbol], b''
+        symbol_id = len(self.symbols)
+        self.symbols[symbol] = symbol_id
+        return symbol_id, self._frame(SYMBOL, symbol_id, symbol.encode()[:MAX_SYMBOL_LENGTH])
+    
+    def quote(self, quote):
+        """Frames for a quote dict as produced by the servers (prices already in cents).
+        
+        The dict's timestamp is in epoch seconds; the wire carries nanoseconds.
+        """
+        symbol_id, prefix = self._symbol(quote['symbol'])
+        payload = QUOTE_PAYLOAD.pack(quote['bid_price'], quote['ask_price'], quote['bid_size'],
+                                     quote['ask_size'], quote['timestamp'] * 1_000_000_000)
+        return prefix + self._frame(QUOTE, symbol_id, payload)
+    
+    def trade(self, symbol, price, quantity, timestamp):
+        symbol_id, prefix = self._symbol(symbol)
+        return prefix + self._frame(TRADE, symbol_id, TRADE_PAYLOAD.pack(price, quantity, timestamp))
+    
+    def ohlcv(self, symbol, timestamp, open_, high, low, close, volume):
+        symbol_id, prefix = self._symbol(symbol)
+        payload = OHLCV_PAYLOAD.pack(timestamp, open_, high, low, close, volume)
+        return prefix + self._frame(OHLCV, symbol_id, payload)
+    
+    def heartbeat(self):
+        return self._frame(HEARTBEAT, 0)
+
+def encode_quotes(quotes):
+    """A complete body (magic included) for a list of quote dicts."""
+    encoder = WireEncoder()
+    return MAGIC + b''.join(encoder.quote(quote) for quote in quotes)
@@ -4,18 +4,27 @@ Simple HTTP server that provides real-time stock quotes using yfinance.
 This allows the C++ order book to fetch market data via HTTP requests.
 """
 
+import gzip
 import json
 import yfinance as yf
-from http.server import HTTPServer, BaseHTTPRequestHandler
+from http.server import ThreadingHTTPServer, BaseHTTPRequestHandler
 from urllib.parse import urlparse, parse_qs
 import sys
 import threading
 import time
+from concurrent.futures import ThreadPoolExecutor
+from wire_format import CONTENT_TYPE as WIRE_CONTENT_TYPE, MAGIC as WIRE_MAGIC, WireEncoder, \
+    accepts_wire, encode_quotes
 
 # Cache to store recent quotes
 quote_cache = {}
 cache_lock = threading.Lock()
 CACHE_EXPIRY = 2  # seconds
+MAX_BATCH_SYMBOLS = 500
+STREAM_REFRESH = 0.5       # seconds between upstream refreshes for /stream
+HEARTBEAT_INTERVAL = 15    # seconds; keeps idle streams from looking dead
+GZIP_MIN_SIZE = 1024       # bytes; smaller bodies aren't worth compressing
+fetch_pool = ThreadPoolExecutor(max_workers=16)
 
 def get_stock_quote(symbol):
     """Fetch current stock quote using yfinance."""
@@ -56,30 +65,68 @@ def get_stock_quote(symbol):
     
     return None
 
+def get_cached_quotes(symbols, max_age=CACHE_EXPIRY):
+    """Get quotes from cache, fetching stale or missing ones concurrently.
+    
+    Returns quotes in request order; symbols that could not be fetched are left out.
+    """
+    now = time.time()
+    found = {}
+    stale = []
+    with cache_lock:
+        for symbol in symbols:
+            if symbol in quote_cache:
+                cached_data, cached_time = quote_cache[symbol]
+                if now - cached_time < max_age:
+                    found[symbol] = cached_data
+                    continue
+            stale.append(symbol)
+    
+    # Fetch outside the lock so slow lookups don't serialize other requests
+    if stale:
+        for symbol, quote in zip(stale, fetch_pool.map(get_stock_quote, stale)):
+            if quote:
+                found[symbol] = quote
+        with cache_lock:
+            for symbol in stale:
+                if symbol in found:
+                    quote_cache[symbol] = (found[symbol], now)
+    
+    return [found[symbol] for symbol in symbols if symbol in found]
+
 def get_cached_quote(symbol):
     """Get quote from cache or fetch new one."""
-    with cache_lock:
-        now = time.time()
-        
-        # Check if we have a recent cached quote
-        if symbol in quote_cache:
-            cached_data, cached_time = quote_cache[symbol]
-            if now - cached_time < CACHE_EXPIRY:
-                return cached_data
-        
-        # Fetch new quote
-        quote = get_stock_quote(symbol)
-        if quote:
-            quote_cache[symbol] = (quote, now)
-        return quote
+    quotes = get_cached_quotes([symbol])
+    return quotes[0] if quotes else None
+
+def parse_symbols(params, name='symbols'):
+    """Comma-separated symbol list from a query parameter, upper-cased, no duplicates."""
+    symbols = []
+    for symbol in params.get(name, [''])[0].upper().split(','):
+        symbol = symbol.strip()
+        if symbol and symbol not in symbols:
+            symbols.append(symbol)
+    return symbols
 
 class QuoteHandler(BaseHTTPRequestHandler):
     """HTTP request handler for stock quotes."""
     
+    # Keep-alive, so clients reuse one connection across requests. Headers and
+    # body go out as separate writes; without TCP_NODELAY the body waits on a
+    # delayed ACK (~40 ms) on every reused connection.
+    protocol_version = 'HTTP/1.1'
+    disable_nagle_algorithm = True
+    
     def log_message(self, format, *args):
         """Override to reduce logging."""
         pass  # Silent mode
     
+    def do_HEAD(self):
+        """Empty 200 for any path; clients use HEAD to keep pooled connections warm."""
+        self.send_response(200)
+        self.send_header('Content-Length', '0')
+        self.end_headers()
+    
     def do_GET(self):
         """Handle GET requests for stock quotes."""
         parsed = urlparse(self.path)
@@ -97,29 +144,112 @@ class QuoteHandler(BaseHTTPRequestHandler):
             quote = get_cached_quote(symbol)
             
             if quote:
-                self.send_response(200)
-                self.send_header('Content-type', 'application/json')
-                self.send_header('Access-Control-Allow-Origin', '*')
-                self.end_headers()
-                self.wfile.write(json.dumps(quote).encode())
+                self.send_quotes([quote], json.dumps(quote).encode())
             else:
                 self.send_error(404, f"Could not fetch quote for {symbol}")
         
+        elif parsed.path == '/quotes':
+            # Batch: /quotes?symbols=AAPL,MSFT,... -> JSON array of quote objects
+            symbols = parse_symbols(parse_qs(parsed.query))
+            
+            if not symbols:
+                self.send_error(400, "Missing symbols parameter")
+                return
+            if len(symbols) > MAX_BATCH_SYMBOLS:
+                self.send_error(400, f"At most {MAX_BATCH_SYMBOLS} symbols per request")
+                return
+            
+            quotes = get_cached_quotes(symbols)
+            self.send_quotes(quotes, json.dumps(quotes).encode())
+        
+        elif parsed.path == '/stream':
+            # Server-Sent Events: one "data: {quote}" event per changed quote
+            symbols = parse_symbols(parse_qs(parsed.query))
+            if not symbols or len(symbols) > MAX_BATCH_SYMBOLS:
+                self.send_error(400, f"Give 1 to {MAX_BATCH_SYMBOLS} symbols")
+                return
+            self.stream_quotes(symbols)
+        
         elif parsed.path == '/health':
             self.send_response(200)
             self.send_header('Content-type', 'text/plain')
+            self.send_header('Content-Length', '2')
             self.end_headers()
             self.wfile.write(b'OK')
         
         else:
-            self.send_error(404, "Endpoint not found. Use /quote?symbol=AAPL")
+            self.send_error(404, "Endpoint not found. Use /quote?symbol=AAPL or /quotes?symbols=AAPL,MSFT")
+    
+    def send_quotes(self, quotes, json_body):
+        """Reply in the binary wire format if the client accepts it, else JSON.
+        
+        Large bodies are gzipped when the client accepts that.
+        """
+        wire = accepts_wire(self.headers.get('Accept'))
+        body = encode_quotes(quotes) if wire else json_body
+        gzipped = len(body) >= GZIP_MIN_SIZE and 'gzip' in self.headers.get('Accept-Encoding', '')
+        if gzipped:
+            body = gzip.compress(body, compresslevel=1)
+        self.send_response(200)
+        self.send_header('Content-type', WIRE_CONTENT_TYPE if wire else 'application/json')
+        if gzipped:
+            self.send_header('Content-Encoding', 'gzip')
+        self.send_header('Content-Length', str(len(body)))
+        self.send_header('Access-Control-Allow-Origin', '*')
+        self.end_headers()
+        self.wfile.write(body)
+    
+    def stream_quotes(self, symbols):
+        """Push quotes as they change until the client disconnects.
+        
+        Binary frames if the client accepts the wire format, else Server-Sent Events.
+        """
+        wire = accepts_wire(self.headers.get('Accept'))
+        self.send_response(200)
+        self.send_header('Content-type', WIRE_CONTENT_TYPE if wire else 'text/event-stream')
+        self.send_header('Cache-Control', 'no-cache')
+        self.send_header('Access-Control-Allow-Origin', '*')
+        self.send_header('Connection', 'close')  # No length; the body ends when the connection does
+        self.end_headers()
+        self.close_connection = True
+        
+        encoder = WireEncoder()
+        if wire:
+            self.wfile.write(WIRE_MAGIC)
+        
+        last_sent = {}
+        last_write = time.time()
+        try:
+            while True:
+                started = time.time()
+                for quote in get_cached_quotes(symbols, max_age=STREAM_REFRESH):
+                    key = (quote['bid_price'], quote['ask_price'], quote['bid_size'],
+                           quote['ask_size'], quote['last_price'])
+                    if last_sent.get(quote['symbol']) != key:
+                        last_sent[quote['symbol']] = key
+                        if wire:
+                            self.wfile.write(encoder.quote(quote))
+                        else:
+                            self.wfile.write(b'data: ' + json.dumps(quote).encode() + b'\n\n')
+                        last_write = time.time()
+                if time.time() - last_write >= HEARTBEAT_INTERVAL:
+                    self.wfile.write(encoder.heartbeat() if wire else b': keepalive\n\n')
+                    last_write = time.time()
+                self.wfile.flush()
+                time.sleep(max(0.0, STREAM_REFRESH - (time.time() - started)))
+        except (BrokenPipeError, ConnectionResetError):
+            pass  # Client went away
 
 def run_server(port=8080):
     """Start the HTTP server."""
     server_address = ('', port)
-    httpd = HTTPServer(server_address, QuoteHandler)
+    # One thread per connection so open streams don't block other requests
+    httpd = ThreadingHTTPServer(server_address, QuoteHandler)
+    httpd.daemon_threads = True
     print(f"YFinance Quote Server starting on port {port}...")
     print(f"Test with: curl http://localhost:{port}/quote?symbol=AAPL")
+    print(f"      or:  curl 'http://localhost:{port}/quotes?symbols=AAPL,MSFT,GOOGL'")
+    print(f"  stream:  curl -N 'http://localhost:{port}/stream?symbols=AAPL,MSFT'")
     print("Press Ctrl+C to stop")
     
     try: